@@ -195,10 +195,24 @@ protected:
                                         const int aEndYear,
                                         objects::YearVector<double>& aEmissVector);
 private:
+    void calcAboveGroundCarbonChange( const double aPrevCarbonStock,
+                                      const double aPrevLandArea,
+                                      const double aCurrLandArea,
+                                      const double aPrevCarbonDensity,
+                                      double& aPulseEmiss,
+                                      double& aSigmoidCarbon ) const;
+
     void calcSigmoidCurve( const double aCarbonDiff,
                            const int aYear,
                            const int aEndYear,
                            objects::YearVector<double>& aEmissVector);
+
+    double calcSigmoidEmission( const double* aSigmoidCarbon,
+                                const int aFirstYear,
+                                const int aLastYear,
+                                const int aYear ) const;
+
+    double getSoilDecayFactor() const;
 };
 
 #endif // _ASIMPLE_CARBON_CALC_H_
@@ -49,10 +49,34 @@
 #include "land_allocator/include/land_leaf.h"
 #include "util/logger/include/ilogger.h"
 
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/enumerable_thread_specific.h>
+#endif
+
 using namespace std;
 using namespace xercesc;
 using namespace objects;
 
+namespace {
+    /*!
+     * \brief Get a scratch buffer of at least the given size zeroed out.
+     * \details The same carbon calc may be calculated concurrently so the buffer
+     *          is kept per thread when running in parallel.
+     * \param aSize The number of values required.
+     * \return A reference to the scratch buffer for the current thread.
+     */
+    vector<double>& getScratchBuffer( const size_t aSize ) {
+#if GCAM_PARALLEL_ENABLED
+        static tbb::enumerable_thread_specific<vector<double> > sScratch;
+        vector<double>& scratch = sScratch.local();
+#else
+        static vector<double> scratch;
+#endif
+        scratch.assign( aSize, 0.0 );
+        return scratch;
+    }
+}
+
 extern Scenario* scenario;
 
 ASimpleCarbonCalc::ASimpleCarbonCalc():
@@ -104,16 +128,28 @@ double ASimpleCarbonCalc::calc( const int aPeriod, const int aEndYear, const Car
             
             double currCarbonStock = aboveGroundCarbonDensity * mLandUseHistory->getAllocation( CarbonModelUtils::getStartYear() );
             
+            // Soil carbon changes from every year decay at the same rate so rather
+            // than spreading each one out to aEndYear we carry the total which has
+            // not yet been emitted forward one year at a time.
+            const double soilDecay = getSoilDecayFactor();
+            double pendingSoilCarbon = 0.0;
             double prevLand = mLandUseHistory->getAllocation( CarbonModelUtils::getStartYear() - 1 );
-            for( int year = CarbonModelUtils::getStartYear(); year <= mLandUseHistory->getMaxYear(); ++year ) {
+            int year;
+            for( year = CarbonModelUtils::getStartYear(); year <= mLandUseHistory->getMaxYear(); ++year ) {
                 double currLand = mLandUseHistory->getAllocation( year );
                 double landDifference = prevLand - currLand;
                 calcAboveGroundCarbonEmission( currCarbonStock, prevLand, currLand, aboveGroundCarbonDensity, year, aEndYear, mTotalEmissionsAbove );
-                calcBelowGroundCarbonEmission( landDifference * belowGroundCarbonDensity, year, aEndYear, mTotalEmissionsBelow );
+                pendingSoilCarbon += landDifference * belowGroundCarbonDensity;
+                mTotalEmissionsBelow[ year ] += pendingSoilCarbon * ( 1.0 - soilDecay );
+                pendingSoilCarbon *= soilDecay;
                 prevLand = currLand;
                 currCarbonStock -= mTotalEmissionsAbove[ year ];
                 mTotalEmissions[year] = mTotalEmissionsAbove[year] + mTotalEmissionsBelow[year];
             }
+            for( ; year <= aEndYear; ++year ) {
+                mTotalEmissionsBelow[ year ] += pendingSoilCarbon * ( 1.0 - soilDecay );
+                pendingSoilCarbon *= soilDecay;
+            }
             mHasCalculatedHistoricEmiss = true;
             mCarbonStock[ modeltime->getStartYear() ] = currCarbonStock;
         }
@@ -122,11 +158,25 @@ double ASimpleCarbonCalc::calc( const int aPeriod, const int aEndYear, const Car
         // using model calculated allocations
         const int modelYear = modeltime->getper_to_yr(aPeriod);
         const int prevModelYear = modeltime->getper_to_yr(aPeriod-1);
-        int year = prevModelYear + 1;
-        YearVector<double> currEmissionsAbove( year, aEndYear, 0.0 );
-        YearVector<double> currEmissionsBelow( year, aEndYear, 0.0 );
+        const int timestep = modelYear - prevModelYear;
         
-        year = prevModelYear;
+        /*!
+         * \pre Emissions must be calculated at least to the end of the current
+         *      timestep as the carbon stock depends on them.
+         */
+        assert( aEndYear >= modelYear );
+        
+        // Rather than spreading the emissions from each year of this timestep out to
+        // aEndYear we only record the pulse of above ground emissions, the amount of
+        // above ground carbon to be sequestered along the sigmoid curve, and the
+        // change in soil carbon for each year.  The emissions in any later year can
+        // then be computed from these as they are needed.
+        vector<double>& scratch = getScratchBuffer( 3 * timestep );
+        double* abovePulse = &scratch[ 0 ];
+        double* aboveSigmoid = &scratch[ timestep ];
+        double* belowDiff = &scratch[ 2 * timestep ];
+        
+        int year = prevModelYear;
         double currLand = aPeriod == 1 ? mLandUseHistory->getAllocation( prevModelYear ) :
             // we need to be careful about accessing the land allocation from a previous timestep
             // when we are intending to calculate in eReverseCalc as the previous timestep may have
@@ -137,45 +187,62 @@ double ASimpleCarbonCalc::calc( const int aPeriod, const int aEndYear, const Car
         double prevCarbonBelow = currLand * getActualBelowGroundCarbonDensity( year );
 
         for( ++year; year <= modelYear; ++year ) {
+            const int offset = year - prevModelYear - 1;
             double prevLand = currLand;
             currLand += avgAnnualChangeInLand;
             double currCarbonBelow = currLand * getActualBelowGroundCarbonDensity( year);
             // we need to be careful about accessing the carbon stock from a previous timestep
             // when we are intending to calculate in eReverseCalc as the previous timestep may have
             // already calculated in eStoreResults
-            calcAboveGroundCarbonEmission( aCalcMode == eReverseCalc && (year - 1) == prevModelYear ?
-                                          mSavedCarbonStock[ aPeriod - 1 ] :
-                                          mCarbonStock[ year - 1 ], prevLand, currLand, getActualAboveGroundCarbonDensity( year ), year, aEndYear, currEmissionsAbove );
-            calcBelowGroundCarbonEmission( prevCarbonBelow - currCarbonBelow, year, aEndYear, currEmissionsBelow );
+            calcAboveGroundCarbonChange( aCalcMode == eReverseCalc && (year - 1) == prevModelYear ?
+                                         mSavedCarbonStock[ aPeriod - 1 ] :
+                                         mCarbonStock[ year - 1 ], prevLand, currLand, getActualAboveGroundCarbonDensity( year ),
+                                         abovePulse[ offset ], aboveSigmoid[ offset ] );
+            belowDiff[ offset ] = prevCarbonBelow - currCarbonBelow;
 
             if( aCalcMode != eReverseCalc ) {
-                mCarbonStock[ year ] = mCarbonStock[ year - 1 ] - ( mTotalEmissionsAbove[ year ] + currEmissionsAbove[ year ] );
+                mCarbonStock[ year ] = mCarbonStock[ year - 1 ] - ( mTotalEmissionsAbove[ year ] +
+                    abovePulse[ offset ] + calcSigmoidEmission( aboveSigmoid, prevModelYear + 1, year, year ) );
             }
             prevCarbonBelow = currCarbonBelow;
         }
         
-        if( aCalcMode == eStoreResults ) {
-            // add current emissions to the total
-            for( year = prevModelYear + 1; year <= aEndYear; ++year ) {
-                mTotalEmissionsAbove[ year ] += currEmissionsAbove[ year ];
-                mTotalEmissionsBelow[ year ] += currEmissionsBelow[ year ];
-                mTotalEmissions[ year ] = mTotalEmissionsAbove[ year ] + mTotalEmissionsBelow[ year ];
+        const double soilDecay = getSoilDecayFactor();
+        if( aCalcMode == eReturnTotal ) {
+            // Since the flag to avoid storing the full emissions is set we will just calculate
+            // and return the appropriate total emissions.
+            double currEmissionsAbove = calcSigmoidEmission( aboveSigmoid, prevModelYear + 1, modelYear, aEndYear );
+            if( aEndYear == modelYear ) {
+                currEmissionsAbove += abovePulse[ timestep - 1 ];
             }
-            mSavedCarbonStock[ aPeriod - 1 ] = mCarbonStock[ prevModelYear ];
-            mSavedLandAllocation[ aPeriod - 1 ] = mLandLeaf->getLandAllocation( mLandLeaf->getName(), aPeriod - 1 );
+            double pendingSoilCarbon = 0.0;
+            for( int offset = 0; offset < timestep; ++offset ) {
+                pendingSoilCarbon = pendingSoilCarbon * soilDecay + belowDiff[ offset ];
+            }
+            if( aEndYear > modelYear ) {
+                pendingSoilCarbon *= pow( soilDecay, aEndYear - modelYear );
+            }
+            return mTotalEmissions[ aEndYear ] + currEmissionsAbove + pendingSoilCarbon * ( 1.0 - soilDecay );
         }
-        else if( aCalcMode == eReverseCalc ) {
-            // back out the current emissions from the total
-            for( year = prevModelYear + 1; year <= aEndYear; ++year ) {
-                mTotalEmissionsAbove[ year ] -= currEmissionsAbove[ year ];
-                mTotalEmissionsBelow[ year ] -= currEmissionsBelow[ year ];
-                mTotalEmissions[ year ] = mTotalEmissionsAbove[ year ] + mTotalEmissionsBelow[ year ];
+        
+        // add current emissions to the total or back them out when reversing
+        const double sign = aCalcMode == eStoreResults ? 1.0 : -1.0;
+        double pendingSoilCarbon = 0.0;
+        for( year = prevModelYear + 1; year <= aEndYear; ++year ) {
+            double currEmissionsAbove = calcSigmoidEmission( aboveSigmoid, prevModelYear + 1, min( year, modelYear ), year );
+            if( year <= modelYear ) {
+                currEmissionsAbove += abovePulse[ year - prevModelYear - 1 ];
+                pendingSoilCarbon += belowDiff[ year - prevModelYear - 1 ];
             }
+            mTotalEmissionsAbove[ year ] += sign * currEmissionsAbove;
+            mTotalEmissionsBelow[ year ] += sign * pendingSoilCarbon * ( 1.0 - soilDecay );
+            mTotalEmissions[ year ] = mTotalEmissionsAbove[ year ] + mTotalEmissionsBelow[ year ];
+            pendingSoilCarbon *= soilDecay;
         }
-        else if( aCalcMode == eReturnTotal ) {
-            // Since the flag to avoid storing the full emissions is set we will just calculate
-            // and return the appropriate total emissions.
-            return mTotalEmissions[ aEndYear ] + currEmissionsAbove[ aEndYear ] + currEmissionsBelow[ aEndYear ];
+        
+        if( aCalcMode == eStoreResults ) {
+            mSavedCarbonStock[ aPeriod - 1 ] = mCarbonStock[ prevModelYear ];
+            mSavedLandAllocation[ aPeriod - 1 ] = mLandLeaf->getLandAllocation( mLandLeaf->getName(), aPeriod - 1 );
         }
     }
     
@@ -202,6 +269,40 @@ void ASimpleCarbonCalc::calcAboveGroundCarbonEmission( const double aPrevCarbonS
                                                        const int aEndYear,
                                                        YearVector<double>& aEmissVector)
 {
+    double pulseEmiss;
+    double sigmoidCarbon;
+    calcAboveGroundCarbonChange( aPrevCarbonStock, aPrevLandArea, aCurrLandArea, aPrevCarbonDensity,
+                                 pulseEmiss, sigmoidCarbon );
+    aEmissVector[ aYear ] += pulseEmiss;
+    if( sigmoidCarbon != 0.0 ) {
+        calcSigmoidCurve( sigmoidCarbon, aYear, aEndYear, aEmissVector );
+    }
+}
+
+/*!
+ * \brief Calculate the change in above ground carbon for a single year of land
+ *        use change.
+ * \details The change is split into the amount which is emitted as a pulse in
+ *          the year it occurs and the amount which is sequestered (or no longer
+ *          sequestered) along the sigmoid curve starting in that year.  Keeping
+ *          the two separate allows callers to defer spreading the sigmoid part
+ *          out over future years until those years are actually needed.
+ * \param aPrevCarbonStock The carbon stock from the previous year.
+ * \param aPrevLandArea The land area during the previous year.
+ * \param aCurrLandArea The land area which will expand/contract to.
+ * \param aPrevCarbonDensity The potential carbon density for the previous year.
+ * \param aPulseEmiss The emissions which occur in the current year.
+ * \param aSigmoidCarbon The carbon to distribute along the sigmoid curve.
+ */
+void ASimpleCarbonCalc::calcAboveGroundCarbonChange( const double aPrevCarbonStock,
+                                                     const double aPrevLandArea,
+                                                     const double aCurrLandArea,
+                                                     const double aPrevCarbonDensity,
+                                                     double& aPulseEmiss,
+                                                     double& aSigmoidCarbon ) const
+{
+    aPulseEmiss = 0.0;
+    aSigmoidCarbon = 0.0;
     double carbonDiff = aPrevCarbonDensity * ( aPrevLandArea  - aCurrLandArea );
     // If no emissions or sequestration occurred, then exit.
     if( util::isEqual( carbonDiff, 0.0 ) ) {
@@ -214,13 +315,13 @@ void ASimpleCarbonCalc::calcAboveGroundCarbonEmission( const double aPrevCarbonS
         // If carbon content increases, then carbon was sequestered.
         // Carbon sequestration is stretched out in time, based on mMatureAge, because some
         // land cover types (notably forests) don't mature instantly.
-        calcSigmoidCurve( carbonDiff, aYear, aEndYear, aEmissVector );
+        aSigmoidCarbon = carbonDiff;
     }
     else if( util::isEqual( aPrevLandArea, 0.0 ) ) {
         // If this land category didn't exist before, and now it does,
         // then the calculation below will generate a NaN.  Avoid that
         // by taking the appropriate limit here.
-        aEmissVector[ aYear ] -= aCurrLandArea * aPrevCarbonDensity;
+        aPulseEmiss = -aCurrLandArea * aPrevCarbonDensity;
     }
     else {
         // If carbon content decreases, then emissions have occurred.
@@ -232,7 +333,7 @@ void ASimpleCarbonCalc::calcAboveGroundCarbonEmission( const double aPrevCarbonS
         // don't have a separate branch for it).  (It's not obvious,
         // but you can show that the formula below just reduces to the
         // expression for carbonDiff at the top of the function.)
-        aEmissVector[ aYear ] += ( aPrevCarbonStock / aPrevLandArea ) * ( aPrevLandArea - aCurrLandArea );
+        aPulseEmiss = ( aPrevCarbonStock / aPrevLandArea ) * ( aPrevLandArea - aCurrLandArea );
         if( getMatureAge() > 1 ) {
             // Back out the pending future sequestration for the land
             // that has been converted (i.e., that sequestration will
@@ -243,10 +344,9 @@ void ASimpleCarbonCalc::calcAboveGroundCarbonEmission( const double aPrevCarbonS
             // carbonStock/LandArea == carbonDensity, so the
             // difference between those two quantities tells us how
             // much pending sequestration we have.  Distribute the
-            // correction as a sigmoid between aYear and aEndYear.
-            double carbonFutureAdjust = ( aPrevLandArea - aCurrLandArea ) * ( aPrevCarbonDensity -
-                                                                             ( aPrevCarbonStock / aPrevLandArea ) );
-            calcSigmoidCurve( carbonFutureAdjust, aYear, aEndYear, aEmissVector );
+            // correction as a sigmoid starting from the current year.
+            aSigmoidCarbon = ( aPrevLandArea - aCurrLandArea ) * ( aPrevCarbonDensity -
+                                                                  ( aPrevCarbonStock / aPrevLandArea ) );
         }
     }
 }
@@ -275,19 +375,28 @@ void ASimpleCarbonCalc::calcBelowGroundCarbonEmission( const double aCarbonDiff,
     // have occured, at twice the half-life 75% would have occurred, etc.
     // Note also that the aCarbonDiff is passed here as previous carbon minus current carbon
     // so a positive difference means that emissions will occur and a negative means uptake.
-    
+    // Each year a constant fraction of the change which has not yet occurred takes place
+    // so we can just carry the remainder forward rather than re-evaluate the exponential.
+    const double decay = getSoilDecayFactor();
+    double remainingDiff = aCarbonDiff;
+    for( int currYear = aYear; currYear <= aEndYear; ++currYear ) {
+        aEmissVector[ currYear ] += remainingDiff * ( 1.0 - decay );
+        remainingDiff *= decay;
+    }
+}
+
+/*!
+ * \brief Get the fraction of a soil carbon change which has yet to occur that
+ *        will still be outstanding after one more year.
+ * \details The soil carbon kernel is exponential with a half-life of the soil
+ *          time scale divided by ten so this is simply exp( -lambda ).
+ * \return The annual soil carbon decay factor.
+ */
+double ASimpleCarbonCalc::getSoilDecayFactor() const {
     const double halfLife = mSoilTimeScale / 10.0;
     const double log2 = log( 2.0 );
     const double lambda = log2 / halfLife;
-    int yearCounter = 0;
-    double cumStockDiff_t1, cumStockDiff_t2;
-    cumStockDiff_t1 = 0.0;
-    for( int currYear = aYear; currYear <= aEndYear; ++currYear ) {
-        yearCounter += 1;
-        cumStockDiff_t2 = aCarbonDiff * ( 1.0 - exp( -1.0 * lambda * yearCounter ) );
-        aEmissVector[ currYear ] += cumStockDiff_t2 - cumStockDiff_t1;
-        cumStockDiff_t1 = cumStockDiff_t2;
-    }
+    return exp( -1.0 * lambda );
 }
 
 /*!
@@ -317,6 +426,36 @@ void ASimpleCarbonCalc::calcSigmoidCurve( const double aCarbonDiff,
     }
 }
 
+/*!
+ * \brief    Calculate the above ground emissions in a single year from sigmoid
+ *           curves started in a range of years.
+ * \details  This is the convolution of the precomputed sigmoid curve with the
+ *           carbon to sequester started in each year which allows us to only
+ *           compute the years we actually need.
+ * \param    aSigmoidCarbon The carbon to distribute along the sigmoid curve
+ *           by start year offset from aFirstYear.
+ * \param    aFirstYear The year which corresponds to aSigmoidCarbon[ 0 ].
+ * \param    aLastYear The last start year to include.
+ * \param    aYear The year to calculate emissions for.
+ * \return   The emissions in aYear.
+ */
+double ASimpleCarbonCalc::calcSigmoidEmission( const double* aSigmoidCarbon,
+                                               const int aFirstYear,
+                                               const int aLastYear,
+                                               const int aYear ) const
+{
+    double emiss = 0.0;
+    for( int startYear = aFirstYear; startYear <= aLastYear; ++startYear ) {
+        const double carbonDiff = aSigmoidCarbon[ startYear - aFirstYear ];
+        // The sigmoid curve is only precomputed when the mature age is greater
+        // than one, otherwise no carbon will have been set to distribute along it.
+        if( carbonDiff != 0.0 ) {
+            emiss += precalc_sigmoid_diff.get()[ aYear - startYear ] * carbonDiff;
+        }
+    }
+    return emiss;
+}
+
 double ASimpleCarbonCalc::getNetLandUseChangeEmission( const int aYear ) const {
     return mTotalEmissions[ aYear ];
 }
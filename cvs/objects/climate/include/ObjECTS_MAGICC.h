@@ -44,6 +44,11 @@
 // iTp is used extensively in array declarations, so it's special
 #define iTp 740
 
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
 #include "climate/include/MAGICC_array.h"
 
 //#define DEBUG_MAGICC++
@@ -329,22 +334,100 @@ typedef struct {
     int KEYDW;
 } VARW_block;
 
+struct SAVED_block {
+    SAVED_block (): TCUM(0), TBASE(0), XX(0), GS1990(0), B19901(0), B19902(0), B19903(0), B19904(0),
+                    BZERO1(0), BZERO2(0), BZERO3(0), BZERO4(0), GSPREV1(0), GSPREV2(0), GSPREV3(0), GSPREV4(0),
+                    VZ1(0), VZ2(0), VZ3(0), VZ4(0), T00LO(0), T00MID(0), T00HI(0), T00USER(0),
+                    DQOZ(0), QOZ1(0), TX(0), DELT90(0), DELT00(0), DELC(0) {}
+    // Local variables which the Fortran SAVEd between calls.  These used to be
+    // function statics which every MAGICC instance in the process shared.
+    // From tslcalc:
+    float TCUM, TBASE, XX, GS1990, B19901, B19902, B19903, B19904;
+    float BZERO1, BZERO2, BZERO3, BZERO4, GSPREV1, GSPREV2, GSPREV3, GSPREV4;
+    float VZ1, VZ2, VZ3, VZ4;
+    // From deltaq:
+    float T00LO, T00MID, T00HI, T00USER, DQOZ, QOZ1, TX, DELT90, DELT00;
+    // From carbon:
+    float DELC;
+};
+
+struct GASEMK_block {
+    // The emissions to run with, the in memory equivalent of a gas.emk file.
+    // Each row is a year followed by the emissions of each gas in gas.emk
+    // column order: FOS, DEF, DCH4, DN2O, DSO21, DSO22, DSO23, DCF4, DC2F6,
+    // D125, D134A, D143A, D227, D245, DSF6, DNOX, DVOC, DCO, DBC, DOC.
+    std::string MNEM;   // Emissions profile name for the output headers
+    std::vector<std::vector<float> > ROWS;
+};
+
+/*!
+ * \brief All of the data belonging to a single instance of MAGICC.
+ * \details The configuration and historical input files are read from disk
+ *          the first time CLIMAT needs them and served from memory after that.
+ *          Emissions are handed over in GASEMK rather than through a gas.emk
+ *          file.  Parameter overrides, the results of the last run, and the
+ *          locals the Fortran SAVEd between calls all live here rather than in
+ *          globals so that several instances may run concurrently provided each
+ *          has its own context.
+ */
+class MagiccContext {
+public:
+    MagiccContext();
+
+    const std::string& getInputFile( const std::string& aFileName );
+
+    std::string getOutputFileName( const std::string& aFileName ) const;
+
+    //! The emissions to run with which must be set before calling CLIMAT.
+    GASEMK_block GASEMK;
+
+    //! Parameter overrides set through SETPARAMETERVALUES.
+    NEWPARAMS_block NEWPARAMS;
+    BCOC_block BCOC;
+
+    //! Results of the last call to CLIMAT.
+    CARB_block CARB;
+    TANDSL_block TANDSL;
+    CONCS_block CONCS;
+    NEWCONCS_block NEWCONCS;
+    STOREDVALS_block STOREDVALS;
+    METH1_block METH1;
+    CAR_block CAR;
+    FORCE_block FORCE;
+    JSTART_block JSTART;
+    QADD_block QADD;
+    HALOF_block HALOF;
+
+    //! Locals SAVEd between calls.
+    SAVED_block SAVED;
+
+private:
+    //! The contents of each input file read so far by full path.
+    std::map<std::string, std::string> mInputFiles;
+
+    //! Tag added to the output file names of all but the first context so that
+    //! concurrently running instances do not write to the same files.
+    std::string mOutputTag;
+};
+
 // Function prototypes
-void CLIMAT();
+void CLIMAT( MagiccContext* aContext );
 void tslcalc( int N, Limits_block* Limits, CLIM_block* CLIM, CONCS_block* CONCS, CARB_block* CARB,
              TANDSL_block* TANDSL, VARW_block* VARW, QSPLIT_block* QSPLIT, ICE_block* ICE, 
-             NSIM_block* NSIM, std::ofstream* outfile8 );
+             NSIM_block* NSIM, SAVED_block* SAVED, std::ofstream* outfile8 );
 void init( Limits_block* Limits, CLIM_block* CLIM, CONCS_block* CONCS, TANDSL_block* TANDSL, FORCE_block* FORCE, 
           Sulph_block* Sulph, VARW_block* VARW, ICE_block* ICE, AREAS_block* AREAS, NSIM_block* NSIM,
           OZ_block* OZ, NEWCONCS_block* NEWCONCS, CARB_block* CARB, CAR_block* CAR, METH1_block* METH1,
           METH2_block* METH2, METH3_block* METH3, METH4_block* METH4, CO2READ_block* CO2READ, JSTART_block* JSTART,
-          CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS, TauNitr_block* TauNitr, QADD_block* QADD );
+          CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS, TauNitr_block* TauNitr, QADD_block* QADD,
+          SAVED_block* SAVED );
 void interp( int NVAL, int ISTART, int IY[], float X[], magicc_array* Y, int KEND );
 void deltaq( Limits_block* Limits, OZ_block* OZ, CLIM_block* CLIM, CONCS_block* CONCS,
             NEWCONCS_block* NEWCONCS, CARB_block* CARB, TANDSL_block* TANDSL, CAR_block* CAR,
             METH1_block* METH1, FORCE_block* FORCE, METH2_block* METH2, METH3_block* METH3,
             METH4_block* METH4, TauNitr_block* TauNitr, Sulph_block* Sulph, NSIM_block* NSIM, 
-            CO2READ_block* CO2READ, JSTART_block* JSTART, CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS );
+            CO2READ_block* CO2READ, JSTART_block* JSTART, CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS,
+            SAVED_block* SAVED );
 void initcar( const int NN, const float D80, const float F80, COBS_block* COBS, 
              CARB_block* CARB, CAR_block* CAR );
 void halocarb( const int N, float C0, float E, float* C1, float* Q, float TAU00, float TAUCH4 );
@@ -359,7 +442,7 @@ void carbon( const int MM, float TEM, float EFOSS, float ENETDEF, float CPP, flo
             float PL, float HU, float SO, float REGRO, float ETOT,
             float* PL1, float* HU1, float* SO1, float* REGRO1, float* ETOT1,
             float* SUMEM, float* FLUX, float* DELM, float* EGROSSD, float* C1,
-            CAR_block* CAR ); 
+            CAR_block* CAR, SAVED_block* SAVED ); 
 void sulphate( const int JY, float ESO2, float ESO21, float ECO, float* QSO2, 
               float* QDIR, float* QFOC, float* QMN, Sulph_block* Sulph );
 void lamcalc( float Q, float FNHL, float FSHL, float XK, float XKH, float DT2X, 
@@ -369,33 +452,34 @@ void runmod( Limits_block* Limits, CLIM_block* CLIM, CONCS_block* CONCS, CARB_bl
             AREAS_block* AREAS, QADD_block* QADD, BCOC_block* BCOC, FORCE_block* FORCE, NSIM_block* NSIM,
             OZ_block* OZ, NEWCONCS_block* NEWCONCS, CAR_block* CAR, METH1_block* METH1, METH2_block* METH2, 
             METH3_block* METH3, METH4_block* METH4, TauNitr_block* TauNitr,
-            JSTART_block* JSTART, CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS, ICE_block* ICE, std::ofstream* outfile8 );
+            JSTART_block* JSTART, CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS, ICE_block* ICE,
+            SAVED_block* SAVED, std::ofstream* outfile8 );
 void split( const float QGLOBE, const float A, const float BN, const float BS, float* QNO, float* QNL, 
            float* QSO, float* QSL, AREAS_block* AREAS );
 
-void setGlobals( CARB_block* CARB, TANDSL_block* TANDSL, CONCS_block* CONCS, NEWCONCS_block* NEWCONCS, 
+void setGlobals( MagiccContext* aContext, CARB_block* CARB, TANDSL_block* TANDSL, CONCS_block* CONCS, NEWCONCS_block* NEWCONCS, 
                 STOREDVALS_block* STOREDVALS, NEWPARAMS_block* NEWPARAMS, BCOC_block* BCOC, 
                 METH1_block* METH1, CAR_block* CAR, FORCE_block* FORCE, JSTART_block* JSTART,
-                QADD_block* QADD, HALOF_block* HALOF, std::string& GAS_EMK_DATA );
-void setLocals( CARB_block* CARB, TANDSL_block* TANDSL, CONCS_block* CONCS, NEWCONCS_block* NEWCONCS, 
+                QADD_block* QADD, HALOF_block* HALOF );
+void setLocals( MagiccContext* aContext, CARB_block* CARB, TANDSL_block* TANDSL, CONCS_block* CONCS, NEWCONCS_block* NEWCONCS, 
                 STOREDVALS_block* STOREDVALS, NEWPARAMS_block* NEWPARAMS, BCOC_block* BCOC, 
                 METH1_block* METH1, CAR_block* CAR, FORCE_block* FORCE, JSTART_block* JSTART,
-                QADD_block* QADD, HALOF_block* HALOF, std::string& GAS_EMK_DATA );
+                QADD_block* QADD, HALOF_block* HALOF );
 
 // Externally called methods
 
-float getSLR( const int inYear );
-float GETFORCING( const int iGasNumber, const int inYear );
-float GETGHGCONC(int, int);
-float GETGMTEMP(int);
-float GETCARBONRESULTS(int, int);
-void SETPARAMETERVALUES(int, float);
+float getSLR( const MagiccContext* aContext, const int inYear );
+float GETFORCING( const MagiccContext* aContext, const int iGasNumber, const int inYear );
+float GETGHGCONC( const MagiccContext* aContext, int, int );
+float GETGMTEMP( const MagiccContext* aContext, int );
+float GETCARBONRESULTS( const MagiccContext* aContext, int, int );
+void SETPARAMETERVALUES( MagiccContext* aContext, int, float );
 void overrideParameters( NEWPARAMS_block* NEWPARAMS, CAR_block* CAR, METH1_block* METH1, BCOC_block* BCOC );
-void SET_GAS_EMK( const std::string& GAS_EMK_DATA );
 
 // Internal helper methods
 
 void openfile_read( std::ifstream* infile, const std::string& f, bool echo );
+void openfile_read( std::istringstream* infile, const std::string& f, MagiccContext* aContext, bool echo );
 void skipline( std::istream* infile, bool echo );
 float read_csv_value( std::istream* infile, bool echo );
 float read_and_discard( std::istream* infile, bool echo );
@@ -79,6 +79,13 @@ class IVisitor;
  *          the beginning of each new scenario) or in a stabilization
  *          run (where we might have to run each stabilization period
  *          many times to find the right GHG tax).
+ *
+ * \todo Rerunning a period rebuilds the core from the INI file and
+ *       replays every stored emission from period 1.  Rolling the
+ *       existing core back to the end of the previous period instead
+ *       needs a Hector version whose core can restore its component
+ *       state to a given date, which the hector submodule used here
+ *       does not provide.
  */
 class HectorModel: public IClimateModel {
 public:
@@ -48,9 +48,11 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <memory>
 #include "climate/include/iclimate_model.h"
 
 class IVisitor;
+class MagiccContext;
 
 /*! 
 * \ingroup Objects
@@ -61,9 +63,10 @@ class IVisitor;
 *          contained in the C++ MagiccModel code. This wrapper is responsible
 *          for reading in a set of default gas emissions for each gas by period,
 *          overriding those with values from the model where calculated, and
-*          interpolating them into a set of inputs for MAGICC. It then writes
-*          those values to a file and calls MAGICC to calculate climate
-*          parameters. A subset of those output can then be written by this
+*          interpolating them into a set of inputs for MAGICC. It then passes
+*          those values to MAGICC in memory and calls MAGICC to calculate climate
+*          parameters. Each instance owns its own MagiccContext so that several
+*          may run at once. A subset of those output can then be written by this
 *          wrapper to the database and a CSV file.
 * \note It is possible to run MAGICC using the Objects framework without running
 *       the economic model. This is done by reading in a scenario container with
@@ -75,6 +78,7 @@ class IVisitor;
 class MagiccModel: public IClimateModel {
 public:
     MagiccModel();
+    virtual ~MagiccModel();
 
     virtual void completeInit( const std::string& aScenarioName );
     
@@ -183,6 +187,9 @@ protected:
     //! Number of historical data points read in.
     //CREATE_SIMPLE_VARIABLE( mNumberHistoricalDataPoints, int, "num-historical-data-points" ),
     int mNumberHistoricalDataPoints;
+    
+    //! The inputs, results, and working state of this instance of MAGICC.
+    std::auto_ptr<MagiccContext> mContext;
 
 private:
 
@@ -192,8 +199,9 @@ private:
     static unsigned int getNumInputGases();
     void readFile();
     void overwriteMAGICCParameters( );
-    void writeMAGICCEmissionsFile( );
-    void writeComma( int gasNumber, int& numberOfDataPoints, std::ostringstream& gasFile );
+    void setMAGICCEmissions( );
+    static float roundEmissions( const double aEmissions );
+    void writeMAGICCEmissionsFile( ) const;
         
     static int getNumAdditionalGasPoints();
 
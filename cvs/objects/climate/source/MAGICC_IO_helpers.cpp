@@ -42,6 +42,9 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <sstream>
+
+#include "climate/include/ObjECTS_MAGICC.h"
 
 using namespace std;
 
@@ -57,6 +60,13 @@ void openfile_read( ifstream* infile, const string& f, bool echo )
     if ( echo ) cout << "Opened file " << f << " for read OK\n";
 }
 
+void openfile_read( istringstream* infile, const string& f, MagiccContext* aContext, bool echo )
+{
+    infile->clear();
+    infile->str( aContext->getInputFile( f ) );
+    if ( echo ) cout << "Opened file " << f << " for read OK\n";
+}
+
 void skipline( istream* infile, bool echo )
 {
     string line;
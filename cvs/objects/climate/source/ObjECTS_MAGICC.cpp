@@ -37,6 +37,7 @@
 #include <math.h>
 #include <time.h>
 #include <stdlib.h>
+#include <cassert>
 
 
 #include "climate/include/ObjECTS_MAGICC.h"
@@ -49,8 +50,9 @@ using namespace std;
 
 
 // The climat() function is up here so as to encapsulate all these stinking variables;
-// we're not going to allow any globals in the C++ code
-void CLIMAT()
+// we're not going to allow any globals in the C++ code.  Anything which must
+// outlive a single call is kept in aContext.
+void CLIMAT( MagiccContext* aContext )
 {
     // Get input and output file directories from the configuration.  Opening files
     // will be done relative to these paths.
@@ -58,7 +60,7 @@ void CLIMAT()
     const string BASE_OUTPUT_DIR = conf->getString( "MAGICC-output-dir", "../output" );
     const string BASE_INPUT_DIR = conf->getString( "MAGICC-input-dir", "../input/magicc/inputs" );
     ofstream outfile8; // need to do this here; see line F395 and F658
-    openfile_write( &outfile8, BASE_OUTPUT_DIR + "/mag_c.csv", DEBUG_IO );
+    openfile_write( &outfile8, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "mag_c.csv" ), DEBUG_IO );
     
     //F   1 ! MAGTAR.FOR
     //F   2 !
@@ -385,14 +387,11 @@ void CLIMAT()
     int NCOLS=0, IQFIRST=0, IQLAST=0;
     float EQUIVCO2=0.0f, TORREF=0.0f;
 
-    // Input gas data will be read out of this string rather than through an actual file.
-    string GAS_EMK_DATA;
-
-    // The MAGICC routines need access to these data structures, so set some global references
-    setLocals( &CARB, &TANDSL, &CONCS, &NEWCONCS, 
+    // Pick up any parameter overrides set in the context.
+    setLocals( aContext, &CARB, &TANDSL, &CONCS, &NEWCONCS, 
                 &STOREDVALS, &NEWPARAMS, &BCOC, 
                 &METH1, &CAR, &FORCE, &JSTART,
-                &QADD, &HALOF, GAS_EMK_DATA );
+                &QADD, &HALOF );
     
     // Code to mimic the climat() data statements (lines F3038-F3055)
     //F3038       DATA FL(1)/0.420/,FL(2)/0.210
@@ -477,8 +476,9 @@ void CLIMAT()
     //F 254 !
     //F 255       lun = 42   ! spare logical unit no.
     //F 256       open(unit=lun,file='./magicc_files/CO2HIST.IN',status='OLD')
-    ifstream infile;
-    openfile_read( &infile, BASE_INPUT_DIR + "/co2hist_c.in", DEBUG_IO );
+    // Input files are parsed from the copies cached in the context.
+    istringstream infile;
+    openfile_read( &infile, BASE_INPUT_DIR + "/co2hist_c.in", aContext, DEBUG_IO );
     //F 257       DO ICO2=0,JSTART
     for( int ICO2=0; ICO2<=JSTART.JSTART; ICO2++ ) {
         //F 258       READ(LUN,4445)IIII,COBS(ICO2),FOSSHIST(ICO2)
@@ -486,13 +486,12 @@ void CLIMAT()
         //F 259       END DO
     }
     //F 260       CLOSE(lun)
-    infile.close();
     //F 261 !
     //F 262 !  READ PARAMETERS FROM MAGUSER.CFG.
     //F 263 !
     //F 264       lun = 42   ! spare logical unit no.
     //F 265       open(unit=lun,file='./magicc_files/MAGUSER.CFG',status='OLD')
-    openfile_read( &infile, BASE_INPUT_DIR + "/maguser_c.cfg", DEBUG_IO );
+    openfile_read( &infile, BASE_INPUT_DIR + "/maguser_c.cfg", aContext, DEBUG_IO );
     //F 266 !
     //F 267         READ(LUN,4240) LEVCO2
     CO2READ.LEVCO2 = read_and_discard( &infile, false );
@@ -522,7 +521,6 @@ void CLIMAT()
     const int NONOFF = 0;
     //F 280 !
     //F 281       close(lun)
-    infile.close();
     //F 282 !
     //F 283       LASTMAX=1764+iTp
     const int LASTMAX = 1764 + iTp;
@@ -535,7 +533,7 @@ void CLIMAT()
     //F 289 !
     //F 290       lun = 42   ! spare logical unit no.
     //F 291       open(unit=lun,file='./magicc_files/MAGICE.CFG',status='OLD')
-    openfile_read( &infile, BASE_INPUT_DIR + "/magice_c.cfg", DEBUG_IO );
+    openfile_read( &infile, BASE_INPUT_DIR + "/magice_c.cfg", aContext, DEBUG_IO );
     //F 292 !
     //F 293         READ(LUN,4240) NEWGSIC  ! SET = 1 TO USE NEW ALGORITHM
     ICE.NEWGSIC = read_and_discard( &infile, false );
@@ -549,7 +547,6 @@ void CLIMAT()
     const float ASEN = read_and_discard( &infile, false );
     //F 298 !
     //F 299       CLOSE(lun)
-    infile.close();
     //F 300 !
     //F 301 !  ********************************************************************
     //F 302 !
@@ -558,7 +555,7 @@ void CLIMAT()
     //F 305 !
     //F 306       lun = 42   ! spare logical unit no.
     //F 307       open(unit=lun,file='./magicc_files/MAGGAS.CFG',status='OLD')
-    openfile_read( &infile, BASE_INPUT_DIR + "/maggas_c.cfg", DEBUG_IO );
+    openfile_read( &infile, BASE_INPUT_DIR + "/maggas_c.cfg", aContext, DEBUG_IO );
     //F 308 !
     //F 309         READ(LUN,4240) OVRWRITE
     OVRWRITE = read_and_discard( &infile, false );
@@ -635,7 +632,6 @@ void CLIMAT()
     METH3.ICH4FEED = read_and_discard( &infile, false );
     //F 344 !
     //F 345       close(lun)
-    infile.close();
     //F 346 
     //! Initiailize internal BC-OC vars
     //aBCUnitForcing = 0
@@ -731,7 +727,7 @@ void CLIMAT()
     //F 403 !
     //F 404       lun = 42   ! spare logical unit no.
     //F 405       open(unit=lun,file='./magicc_files/MAGMOD.CFG',status='OLD')
-    openfile_read( &infile, BASE_INPUT_DIR + "/magmod_c.cfg", DEBUG_IO );
+    openfile_read( &infile, BASE_INPUT_DIR + "/magmod_c.cfg", aContext, DEBUG_IO );
     //F 406 !
     //F 407         READ(LUN,4241) ADJUST
     DSENS.ADJUST = read_and_discard( &infile, false );
@@ -774,7 +770,6 @@ void CLIMAT()
     }
     //F 427 !
     //F 428       close(lun)
-    infile.close();
     //F 429 !
     //F 430 !   Call overrite subroutine after each file that may have parameters to overwrite
     //F 431       call overrideParameters( )	! sjs
@@ -1068,7 +1063,7 @@ void CLIMAT()
     //F 589 !
     //F 590       lun = 42   ! spare logical unit no.
     //F 591       open(unit=lun,file='./magicc_files/MAGRUN.CFG',status='OLD')
-    openfile_read( &infile, BASE_INPUT_DIR + "/magrun_c.cfg", DEBUG_IO );
+    openfile_read( &infile, BASE_INPUT_DIR + "/magrun_c.cfg", aContext, DEBUG_IO );
     //F 592 !
     //F 593         READ(LUN,4240) ISCENGEN
     NSIM.ISCENGEN = read_and_discard( &infile, false );
@@ -1091,7 +1086,6 @@ void CLIMAT()
     /* //UNUSED const float D2400 = */ read_and_discard( &infile, false );
     //F 603 !
     //F 604       close(lun)
-    infile.close();
     //F 605 !
     //F 606 !  ********************************************************************
     //F 607 !
@@ -1099,7 +1093,7 @@ void CLIMAT()
     //F 609 !
     //F 610       lun = 42   ! spare logical unit no.
     //F 611       open(unit=lun,file='./magicc_files/MAGXTRA.CFG',status='OLD')
-    openfile_read( &infile, BASE_INPUT_DIR + "/magxtra_c.cfg", DEBUG_IO );
+    openfile_read( &infile, BASE_INPUT_DIR + "/magxtra_c.cfg", aContext, DEBUG_IO );
     //F 612 !
     //F 613         READ(LUN,4240) IOLDTZ
     QADD.IOLDTZ = read_and_discard( &infile, false );
@@ -1161,7 +1155,6 @@ void CLIMAT()
     const int IYRQALL = 1990;
     //F 642 !
     //F 643       close(lun)
-    infile.close();
     //F 644 !
     //F 645 !   Call overrite subroutine after each file that may have parameters to overwrite
     //F 646       call overrideParameters( ) !sjs
@@ -1183,7 +1176,7 @@ void CLIMAT()
     // Handled at beginning of climat()
     //F 660       OPEN(UNIT=88,file='./outputs/CCSM.TXT', STATUS='UNKNOWN')
     ofstream outfile88;
-    openfile_write( &outfile88, BASE_OUTPUT_DIR + "/ccsm_c.txt", DEBUG_IO );
+    openfile_write( &outfile88, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "ccsm_c.txt" ), DEBUG_IO );
     //F 661 !
     //F 662 !  INTERIM CORRECTION TO AVOID CRASH IF S90IND SET TO ZERO IN
     //F 663 !   MAGUSER.CFG
@@ -1282,7 +1275,7 @@ void CLIMAT()
     //F 722 !
     //F 723       lun = 42   ! spare logical unit no.
     //F 724       open(unit=lun,file='./magicc_files/QHALOS.IN',status='OLD')
-    openfile_read( &infile, BASE_INPUT_DIR + "/qhalos_c.in", DEBUG_IO );
+    openfile_read( &infile, BASE_INPUT_DIR + "/qhalos_c.in", aContext, DEBUG_IO );
     //F 725 !
     //F 726       READ(LUN,4446)IHALO1
     int IHALO1 = read_and_discard( &infile, false );
@@ -1330,7 +1323,6 @@ void CLIMAT()
     }
     //F 747 !
     //F 748       CLOSE(lun)
-    infile.close();
     //F 749 !
     //F 750 !  TAU FOR CH4 SOIL SINK CHANGED TO ACCORD WITH IPCC94 (160 yr).
     //F 751 !  SPECIFICATION OF TauSoil MOVED TO MAGEXTRA.CFG ON 1/10/97.
@@ -1404,7 +1396,7 @@ void CLIMAT()
     if( CO2READ.ICO2READ >= 1 && CO2READ.ICO2READ <= 4 ) {
         //F 796         lun = 42   ! spare logical unit no.
         //F 797         open(unit=lun,file='./magicc_files/Co2input.dat',status='OLD')
-        openfile_read( &infile, BASE_INPUT_DIR + "/Co2input_c.dat", DEBUG_IO );
+        openfile_read( &infile, BASE_INPUT_DIR + "/Co2input_c.dat", aContext, DEBUG_IO );
         //F 798 !
         //F 799 !  CO2INPUT.DAT MUST HAVE FIRST YEAR = 1990 AND MUST HAVE ANNUAL END
         //F 800 !   OF YEAR VALUES. FIRST LINE OF FILE GIVES LAST YEAR OF ARRAY.
@@ -1433,7 +1425,6 @@ void CLIMAT()
             //F 815         ENDIF
         }
         //F 816         close(lun)
-        infile.close();
         //F 817       ENDIF
     }
     //F 818 !
@@ -1450,7 +1441,7 @@ void CLIMAT()
     if( QADD.IQREAD >= 1 ) {
         //F 829         lun = 42   ! spare logical unit no.
         //F 830         open(unit=lun,file='./magicc_files/qextra.in',status='OLD')
-        openfile_read( &infile, BASE_INPUT_DIR + "/qextra_c.in", DEBUG_IO );
+        openfile_read( &infile, BASE_INPUT_DIR + "/qextra_c.in", aContext, DEBUG_IO );
         //F 831 !
         //F 832         READ(LUN,900)NCOLS
         //F 833         READ(lun,901)IQFIRST,IQLAST
@@ -1551,7 +1542,6 @@ void CLIMAT()
             //F 882         ENDIF
         }
         //F 883         close(lun)
-        infile.close();
         //F 884       ELSE
     } else {
         //F 885         JQLAST=2100-1764
@@ -1590,7 +1580,7 @@ void CLIMAT()
         //F 911 
         //F 912         lun = 42   ! spare logical unit no.
         //F 913         open(unit=lun,file='../cvs/objects/magicc/inputs/BCOCHist.csv',status='OLD')
-        openfile_read( &infile, BASE_INPUT_DIR + "/BCOCHist_c.csv", DEBUG_IO );  //FIX location
+        openfile_read( &infile, BASE_INPUT_DIR + "/BCOCHist_c.csv", aContext, DEBUG_IO );  //FIX location
         //F 914 !
         //F 915         READ(LUN,*)QtempBCUnitForcing, aBCBaseEmissions
         float QtempBCUnitForcing=0.0f, QtempOCUnitForcing=0.0f;
@@ -1656,7 +1646,6 @@ void CLIMAT()
         }
         //F 950         
         //F 951         close(lun)
-        infile.close();
         //F 952         
         //F 953         ! Flag to use QExtra forcing
         //F 954         IQREAD = 1
@@ -1677,14 +1666,14 @@ void CLIMAT()
     //F 966       lun = 42   ! spare logical unit no.
     //F 967 !
     //F 968       open(unit=lun,file='GAS.EMK',status='OLD')
-    // Input gas data will be read out of a string rather than a gas.emk file to
-    // facilitate in memory transfer of data from GCAM.
-    istringstream gasfile( GAS_EMK_DATA );
+    // Input gas data is taken directly from the rows set in the context rather
+    // than parsed out of a gas.emk file.
+    const vector<vector<float> >& GASEMK_ROWS = aContext->GASEMK.ROWS;
     //F 969 !
     //F 970 !  READ HEADER AND NUMBER OR ROWS OF EMISIONS DATA FROM GAS.EMK
     //F 971 !
     //F 972       read(lun,4243)  NVAL
-    int NVAL = read_and_discard( &gasfile, DEBUG_IO );
+    int NVAL = GASEMK_ROWS.size();
     
     if ( NVAL > 400 ) {
         ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -1694,13 +1683,10 @@ void CLIMAT()
     }
     
     //F 973       read(lun,'(a)') mnem
-    getline( gasfile, mnem );
+    mnem = aContext->GASEMK.MNEM;
     //F 974       read(lun,*) !   skip description
-    skipline( &gasfile, DEBUG_IO );
     //F 975       read(lun,*) !   skip column headings
-    skipline( &gasfile, DEBUG_IO );
     //F 976       read(lun,*) !   skip units
-    skipline( &gasfile, DEBUG_IO );
     //F 977 !
     //F 978 !  READ INPUT EMISSIONS DATA FROM GAS.EMK
     //F 979 !  SO2 EMISSIONS (BY REGION) MUST BE INPUT AS CHANGES FROM 1990.
@@ -1713,31 +1699,34 @@ void CLIMAT()
     //F 984     do i=1,NVAL
     float DSO211990=0.0f, DSO221990=0.0f, DSO231990=0.0f; 
     for( int i=1; i<=NVAL; i++) {
+        const vector<float>& ROW = GASEMK_ROWS[ i-1 ];
+        assert( ROW.size() == 21 );
+        int COL = 0;
         //F 985 	  if ( iReadNative .EQ. 1 )THEN
         if( iReadNative == 1 ) {
             //F 986         read(lun,4242) IY1(I),FOS(I),DEF(I),DCH4(I),DN2O(I), &
-            IY1[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            FOS[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DEF[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DCH4[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DN2O[ i ] = read_csv_value( &gasfile, DEBUG_IO );
+            IY1[ i ] = ROW[ COL++ ];
+            FOS[ i ] = ROW[ COL++ ];
+            DEF[ i ] = ROW[ COL++ ];
+            DCH4[ i ] = ROW[ COL++ ];
+            DN2O[ i ] = ROW[ COL++ ];
             //F 987         DNOX(I),DVOC(I),DCO(I), &
-            DNOX[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DVOC[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DCO[ i ] = read_csv_value( &gasfile, DEBUG_IO );
+            DNOX[ i ] = ROW[ COL++ ];
+            DVOC[ i ] = ROW[ COL++ ];
+            DCO[ i ] = ROW[ COL++ ];
             //F 988         DSO21(I),DSO22(I),DSO23(I),DCF4(I),DC2F6(I),D125(I), &
-            DSO21[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DSO22[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DSO23[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DCF4[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DC2F6[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            D125[ i ] = read_csv_value( &gasfile, DEBUG_IO );
+            DSO21[ i ] = ROW[ COL++ ];
+            DSO22[ i ] = ROW[ COL++ ];
+            DSO23[ i ] = ROW[ COL++ ];
+            DCF4[ i ] = ROW[ COL++ ];
+            DC2F6[ i ] = ROW[ COL++ ];
+            D125[ i ] = ROW[ COL++ ];
             //F 989         D134A(I),D143A(I),D227(I),D245(I),DSF6(I)
-            D134A[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            D143A[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            D227[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            D245[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DSF6[ i ] = read_and_discard( &gasfile, DEBUG_IO );
+            D134A[ i ] = ROW[ COL++ ];
+            D143A[ i ] = ROW[ COL++ ];
+            D227[ i ] = ROW[ COL++ ];
+            D245[ i ] = ROW[ COL++ ];
+            DSF6[ i ] = ROW[ COL++ ];
             //F 990   	 END IF
         }
         //F 991 
@@ -1745,30 +1734,30 @@ void CLIMAT()
         //F 993 	 IF ( iReadNative .EQ. 0 )THEN
         if( iReadNative == 0 ) {
             //F 994         read(lun,*) IY1(I),FOS(I),DEF(I),DCH4(I),DN2O(I), &
-            IY1[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            FOS[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DEF[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DCH4[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DN2O[ i ] = read_csv_value( &gasfile, DEBUG_IO );
+            IY1[ i ] = ROW[ COL++ ];
+            FOS[ i ] = ROW[ COL++ ];
+            DEF[ i ] = ROW[ COL++ ];
+            DCH4[ i ] = ROW[ COL++ ];
+            DN2O[ i ] = ROW[ COL++ ];
             //F 995        DSO21(I),DSO22(I),DSO23(I),DCF4(I),DC2F6(I),D125(I), &
-            DSO21[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DSO22[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DSO23[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DCF4[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DC2F6[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            D125[ i ] = read_csv_value( &gasfile, DEBUG_IO );
+            DSO21[ i ] = ROW[ COL++ ];
+            DSO22[ i ] = ROW[ COL++ ];
+            DSO23[ i ] = ROW[ COL++ ];
+            DCF4[ i ] = ROW[ COL++ ];
+            DC2F6[ i ] = ROW[ COL++ ];
+            D125[ i ] = ROW[ COL++ ];
             //F 996        D134A(I),D143A(I),D227(I),D245(I),DSF6(I), &
-            D134A[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            D143A[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            D227[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            D245[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DSF6[ i ] = read_csv_value( &gasfile, DEBUG_IO );
+            D134A[ i ] = ROW[ COL++ ];
+            D143A[ i ] = ROW[ COL++ ];
+            D227[ i ] = ROW[ COL++ ];
+            D245[ i ] = ROW[ COL++ ];
+            DSF6[ i ] = ROW[ COL++ ];
             //F 997        DNOX(I),DVOC(I),DCO(I), DBC(I), DOC(I)  ! Change to match order of writeout -- this is different than magicc default - sjs
-            DNOX[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DVOC[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DCO[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DBC[ i ] = read_csv_value( &gasfile, DEBUG_IO );
-            DOC[ i ] = read_and_discard( &gasfile, DEBUG_IO );
+            DNOX[ i ] = ROW[ COL++ ];
+            DVOC[ i ] = ROW[ COL++ ];
+            DCO[ i ] = ROW[ COL++ ];
+            DBC[ i ] = ROW[ COL++ ];
+            DOC[ i ] = ROW[ COL++ ];
             //F 998   	 END IF
         }
         //F 999  
@@ -2101,7 +2090,7 @@ void CLIMAT()
     //F1202       CALL INIT
     init( &Limits, &CLIM, &CONCS, &TANDSL, &FORCE, &Sulph, &VARW, &ICE, &AREAS, &NSIM,
          &OZ, &NEWCONCS, &CARB, &CAR, &METH1, &METH2, &METH3, &METH4, &CO2READ, &JSTART,
-         &CORREN, &HALOF, &COBS, &TauNitr, &QADD );
+         &CORREN, &HALOF, &COBS, &TauNitr, &QADD, &aContext->SAVED );
     //F1203 !
     //F1204 !  LINEARLY EXTRAPOLATE LAST ESO2 VALUES FOR ONE YEAR
     //F1205 !
@@ -2357,7 +2346,7 @@ void CLIMAT()
              &Sulph, &VARW, &ICE, &AREAS, &NSIM,
              &OZ, &NEWCONCS, &CARB, &CAR, &METH1,
              &METH2, &METH3, &METH4, &CO2READ, &JSTART,
-             &CORREN, &HALOF, &COBS, &TauNitr, &QADD );     
+             &CORREN, &HALOF, &COBS, &TauNitr, &QADD, &aContext->SAVED );
          //F1372 !
         //F1373       IF(NESO2.EQ.1)THEN
         if( NESO2 == 1 ) {
@@ -2458,7 +2447,7 @@ void CLIMAT()
                &CO2READ, &Sulph, &DSENS, &VARW, &QSPLIT,
                &AREAS, &QADD, &BCOC, &FORCE, &NSIM,
                &OZ, &NEWCONCS, &CAR, &METH1, &METH2, &METH3, &METH4, &TauNitr,
-               &JSTART, &CORREN, &HALOF, &COBS, &ICE, &outfile8 );
+               &JSTART, &CORREN, &HALOF, &COBS, &ICE, &aContext->SAVED, &outfile8 );
         //F1423 !
         //F1424 !  EXTRA CALL TO RUNMOD TO GET FINAL FORCING VALUES FOR K=KEND
         //F1425 !   WHEN DT=1.0
@@ -3826,14 +3815,14 @@ void CLIMAT()
         //F2237 
         //F2238 	OPEN (UNIT=9, file='./outputs/MAGOUT.CSV')
 
-        // GetForcing now relies on globals, and these need to be set
-        setGlobals( &CARB, &TANDSL, &CONCS, &NEWCONCS, 
+        // GetForcing reads from the context, and these need to be set
+        setGlobals( aContext, &CARB, &TANDSL, &CONCS, &NEWCONCS, 
                    &STOREDVALS, &NEWPARAMS, &BCOC, 
                    &METH1, &CAR, &FORCE, &JSTART,
-                   &QADD, &HALOF, GAS_EMK_DATA );
+                   &QADD, &HALOF );
 
         ofstream outfile9;
-        openfile_write( &outfile9, BASE_OUTPUT_DIR + "/magout_c.csv", DEBUG_IO ); //FIX filename
+        openfile_write( &outfile9, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "magout_c.csv" ), DEBUG_IO ); //FIX filename
         //F2239 
         //F2240   100 FORMAT(I5,1H,,27(F15.5,1H,))
         //F2241 
@@ -3874,26 +3863,26 @@ void CLIMAT()
 
             // RADIATIVE FORCING
             //F2273 	 MAGICCCResults(13,(K-1990)/IIPRT+1) = GETFORCING( 0, K ) ! Total antro forcing
-            MAGICCCResults[ 4 ][ yrindex ] = GETFORCING( 0, K );
+            MAGICCCResults[ 4 ][ yrindex ] = GETFORCING( aContext, 0, K );
             //F2282 	 MAGICCCResults(22,(K-1990)/IIPRT+1) = & !Kyoto Forcing
             //F2283 	    GETFORCING( 1, K ) + GETFORCING( 2, K )  + GETFORCING( 3, K ) + & ! CO2, CH4, and N2O
             //F2284 	    GETFORCING( 4, K ) + GETFORCING( 9, K ) + GETFORCING( 10, K ) + &! Long-lived F-gases
             //F2285 	    GETFORCING( 5, K ) + GETFORCING( 6, K ) + GETFORCING( 7, K ) + &
             //F2286 	    GETFORCING( 8, K ) + GETFORCING( 11, K ) + GETFORCING( 12, K ) ! Shorter-lived F-gases
-            MAGICCCResults[ 5 ][ yrindex ] = GETFORCING( 1, K ) + GETFORCING( 2, K ) + GETFORCING( 3, K ) +
-                GETFORCING( 4, K ) + GETFORCING( 9, K ) + GETFORCING( 10, K ) +
-                GETFORCING( 5, K ) + GETFORCING( 6, K ) + GETFORCING( 7, K ) +
-                GETFORCING( 8, K ) + GETFORCING( 11, K ) + GETFORCING( 12, K );
+            MAGICCCResults[ 5 ][ yrindex ] = GETFORCING( aContext, 1, K ) + GETFORCING( aContext, 2, K ) + GETFORCING( aContext, 3, K ) +
+                GETFORCING( aContext, 4, K ) + GETFORCING( aContext, 9, K ) + GETFORCING( aContext, 10, K ) +
+                GETFORCING( aContext, 5, K ) + GETFORCING( aContext, 6, K ) + GETFORCING( aContext, 7, K ) +
+                GETFORCING( aContext, 8, K ) + GETFORCING( aContext, 11, K ) + GETFORCING( aContext, 12, K );
             //F2262 	 MAGICCCResults(5,(K-1990)/IIPRT+1) = GETFORCING( 1, K ) ! CO2
-            MAGICCCResults[ 6 ][ yrindex ] = GETFORCING( 1, K );
+            MAGICCCResults[ 6 ][ yrindex ] = GETFORCING( aContext, 1, K );
             //F2263 	 MAGICCCResults(6,(K-1990)/IIPRT+1) = GETFORCING( 2, K ) ! CH4 (no indirect components)
-            MAGICCCResults[ 7 ][ yrindex ] = GETFORCING( 2, K );
+            MAGICCCResults[ 7 ][ yrindex ] = GETFORCING( aContext, 2, K );
             //F2264 	 MAGICCCResults(7,(K-1990)/IIPRT+1) = GETFORCING( 3, K ) ! N2O
-            MAGICCCResults[ 8 ][ yrindex ] = GETFORCING( 3, K );
+            MAGICCCResults[ 8 ][ yrindex ] = GETFORCING( aContext, 3, K );
             //F2270 	 MAGICCCResults(10,(K-1990)/IIPRT+1) = GETFORCING( 14, K ) ! SO2 direct only
-            MAGICCCResults[ 9 ][ yrindex ] = GETFORCING( 14, K );
+            MAGICCCResults[ 9 ][ yrindex ] = GETFORCING( aContext, 14, K );
             //F2271 	 MAGICCCResults(11,(K-1990)/IIPRT+1) = GETFORCING( 13, K ) - GETFORCING( 14, K ) ! indirect only
-            MAGICCCResults[ 10 ][ yrindex ] = GETFORCING( 13, K ) - GETFORCING( 14, K );
+            MAGICCCResults[ 10 ][ yrindex ] = GETFORCING( aContext, 13, K ) - GETFORCING( aContext, 14, K );
 
             // EMISSIONS
             //F2274 	 MAGICCCResults(14,(K-1990)/IIPRT+1) = EF(IYR)
@@ -3915,7 +3904,7 @@ void CLIMAT()
             //F2258 	 MAGICCCResults(1,(K-1990)/IIPRT+1) = TEMUSER(IYR)+TGAV(226)
             MAGICCCResults[ 18 ][ yrindex ] = STOREDVALS.TEMUSER[ IYR ] + TANDSL.TGAV[ 226 ];
             //F2281 	 MAGICCCResults(21,(K-1990)/IIPRT+1) = getSLR( IYR ) ! getSLR is external fn with acutal year as argument
-            MAGICCCResults[ 19 ][ yrindex ] = getSLR( K );
+            MAGICCCResults[ 19 ][ yrindex ] = getSLR( aContext, K );
 
             // BC/OC FORCING
             //F2293 	 MAGICCCResults(26,(K-1990)/IIPRT+1) = GETFORCING( 24, K )	! BC forcing 
@@ -3923,9 +3912,9 @@ void CLIMAT()
             //F2294 	 MAGICCCResults(27,(K-1990)/IIPRT+1) = GETFORCING( 25, K )	! OC forcing 
          //   MAGICCCResults[ 21 ][ yrindex ] = GETFORCING( 25, K );
             // Fossil BC/OC Forcing
-            MAGICCCResults[ 20 ][ yrindex ] = GETFORCING( 28, K );
+            MAGICCCResults[ 20 ][ yrindex ] = GETFORCING( aContext, 28, K );
             // Biomass Burning Aerosol Forcing
-            MAGICCCResults[ 21 ][ yrindex ] = GETFORCING( 20, K );
+            MAGICCCResults[ 21 ][ yrindex ] = GETFORCING( aContext, 20, K );
             
             //F2295 
             //F2296 ! now we can write stuff out
@@ -3956,7 +3945,7 @@ void CLIMAT()
         if( NSIM.ISCENGEN == 9 || NSIM.NSIM == 4 ) {
             //F2314 !
             //F2315       open(unit=9,file='./outputs/concs.dis',status='UNKNOWN')
-            openfile_write( &outfile9, BASE_OUTPUT_DIR + "/concs_c.dis", DEBUG_IO );
+            openfile_write( &outfile9, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "concs_c.dis" ), DEBUG_IO );
             //F2316 !
             //F2317         WRITE (9,211)
             outfile9 << "YEAR CO2USER   CO2LO  CO2MID   CO2HI CH4USER   CH4LO  CH4MID   CH4HI     N2O MIDTAUCH4" << endl;
@@ -4082,7 +4071,7 @@ void CLIMAT()
             //F2394 !  WRITE FORCING CHANGES FROM MID-1990 TO MAG DISPLAY FILE
             //F2395 !
             //F2396       open(unit=9,file='./outputs/forcings.dis',status='UNKNOWN')
-            openfile_write( &outfile9, BASE_OUTPUT_DIR + "/forcings_c.dis", DEBUG_IO );
+            openfile_write( &outfile9, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "forcings_c.dis" ), DEBUG_IO );
             //F2397 !
             //F2398         WRITE (9,57)
             outfile9 << "YEAR,CO2,CH4tot,N2O, HALOtot,TROPOZ,SO4DIR,SO4IND,BIOAER,FOC+FBC,QAERMN,QLAND, TOTAL, YEAR,CH4-O3," << endl;
@@ -4291,22 +4280,22 @@ void CLIMAT()
         //F2524 !
         //F2525         OPEN(UNIT=10,file='./outputs/lodrive.raw' ,STATUS='UNKNOWN')
         ofstream outfile10, outfile11, outfile12, outfile13, outfile14, outfile15, outfile16, outfile17;
-        openfile_write( &outfile10, BASE_OUTPUT_DIR + "/lodrive.raw", DEBUG_IO );
+        openfile_write( &outfile10, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "lodrive.raw" ), DEBUG_IO );
         //F2526         OPEN(UNIT=11,file='./outputs/middrive.raw',STATUS='UNKNOWN')
-        openfile_write( &outfile11, BASE_OUTPUT_DIR + "/middrive.raw", DEBUG_IO );
+        openfile_write( &outfile11, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "middrive.raw" ), DEBUG_IO );
         //F2527         OPEN(UNIT=12,file='./outputs/hidrive.raw' ,STATUS='UNKNOWN')
-        openfile_write( &outfile12, BASE_OUTPUT_DIR + "/hidrive.raw", DEBUG_IO );
+        openfile_write( &outfile12, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "hidrive.raw" ), DEBUG_IO );
         //F2528         OPEN(UNIT=13,file='./outputs/usrdrive.raw',STATUS='UNKNOWN')
-        openfile_write( &outfile13, BASE_OUTPUT_DIR + "/usrdrive.raw", DEBUG_IO );
+        openfile_write( &outfile13, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "usrdrive.raw" ), DEBUG_IO );
         //F2529 !
         //F2530         OPEN(UNIT=14,file='./outputs/lodrive.out' ,STATUS='UNKNOWN')
-        openfile_write( &outfile14, BASE_OUTPUT_DIR + "/lodrive.out", DEBUG_IO );
+        openfile_write( &outfile14, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "lodrive.out" ), DEBUG_IO );
         //F2531         OPEN(UNIT=15,file='./outputs/middrive.out',STATUS='UNKNOWN')
-        openfile_write( &outfile15, BASE_OUTPUT_DIR + "/middrive.out", DEBUG_IO );
+        openfile_write( &outfile15, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "middrive.out" ), DEBUG_IO );
         //F2532         OPEN(UNIT=16,file='./outputs/hidrive.out' ,STATUS='UNKNOWN')
-        openfile_write( &outfile16, BASE_OUTPUT_DIR + "/hidrive.out", DEBUG_IO );
+        openfile_write( &outfile16, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "hidrive.out" ), DEBUG_IO );
         //F2533         OPEN(UNIT=17,file='./outputs/usrdrive.out',STATUS='UNKNOWN')
-        openfile_write( &outfile17, BASE_OUTPUT_DIR + "/usrdrive.out", DEBUG_IO );
+        openfile_write( &outfile17, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "usrdrive.out" ), DEBUG_IO );
         //F2534 !
         //F2535         DO NCLIM=1,4
         for( NSIM.NCLIM=1; NSIM.NCLIM<=4; NSIM.NCLIM++ ) {
@@ -4522,7 +4511,7 @@ void CLIMAT()
     //F2649 !
     //F2650       open(unit=9,file='./outputs/temps.dis',status='UNKNOWN')
     ofstream outfile9;
-    openfile_write( &outfile9, BASE_OUTPUT_DIR + "/temps_c.dis", DEBUG_IO );
+    openfile_write( &outfile9, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "temps_c.dis" ), DEBUG_IO );
     //F2651 !
     //F2652         WRITE (9,213)
     outfile9 << "YEAR  TEMUSER    TEMLO   TEMMID    TEMHI TEMNOSO2" << endl;
@@ -4550,7 +4539,7 @@ void CLIMAT()
     //F2668 !  WRITE SEALEVEL CHANGES TO MAG DISPLAY FILE
     //F2669 !
     //F2670       open(unit=9,file='./outputs/sealev.dis',status='UNKNOWN')
-    openfile_write( &outfile9, BASE_OUTPUT_DIR + "/sealev_c.dis", DEBUG_IO );
+    openfile_write( &outfile9, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "sealev_c.dis" ), DEBUG_IO );
     //F2671 !
     //F2672         WRITE (9,214)
     outfile9 << "YEAR  MSLUSER    MSLLO   MSLMID    MSLHI" << endl;
@@ -4578,7 +4567,7 @@ void CLIMAT()
     //F2688 !  WRITE EMISSIONS TO MAG DISPLAY FILE
     //F2689 !
     //F2690       open(unit=9,file='./outputs/emiss.dis',status='UNKNOWN')
-    openfile_write( &outfile9, BASE_OUTPUT_DIR + "/emiss_c.dis", DEBUG_IO );
+    openfile_write( &outfile9, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "emiss_c.dis" ), DEBUG_IO );
     //F2691 !
     //F2692         WRITE (9,212)
     outfile9 << "YEAR  FOSSCO2 NETDEFOR      CH4      N2O SO2-REG1 SO2-REG2 SO2-REG3   SO2-GL" << endl;
@@ -4632,7 +4621,7 @@ void CLIMAT()
     //F2725 !
     //F2726       OPEN(UNIT=888,file='./outputs/FRACLEFT.OUT',STATUS='UNKNOWN')
     ofstream outfile888;
-    openfile_write( &outfile888, BASE_OUTPUT_DIR + "/fracleft_c.out", DEBUG_IO );
+    openfile_write( &outfile888, BASE_OUTPUT_DIR + "/" + aContext->getOutputFileName( "fracleft_c.out" ), DEBUG_IO );
     //F2727 !
     //F2728 !  FRACTION OF CO2 REMAINING IN ATMOSPHERE
     //F2729 !
@@ -4998,8 +4987,8 @@ void CLIMAT()
     //F3057         end
     outfile8.close();
 
-    setGlobals( &CARB, &TANDSL, &CONCS, &NEWCONCS, 
+    setGlobals( aContext, &CARB, &TANDSL, &CONCS, &NEWCONCS, 
               &STOREDVALS, &NEWPARAMS, &BCOC, 
               &METH1, &CAR, &FORCE, &JSTART,
-              &QADD, &HALOF, GAS_EMK_DATA );
+              &QADD, &HALOF );
 }
@@ -53,6 +53,7 @@
 #include "util/base/include/configuration.h"
 #include "util/logger/include/ilogger.h"
 #include "util/base/include/xml_helper.h"
+#include "util/base/include/util.h"
 #include "util/base/include/ivisitor.h"
 
 #include "climate/source/hector/inst/include/component_data.hpp"
@@ -338,7 +339,7 @@ void HectorModel::reset( const int aPeriod ) {
         mHcore.release();
     }
     if( !mOfile.get() ) {
-        mOfile.reset( new ofstream( "logs/gcam-hector-outputstream.csv" ) );
+        mOfile.reset( new ofstream( util::tagOutputFileName( "logs/gcam-hector-outputstream.csv" ).c_str() ) );
         mHosv.reset( new Hector::CSVOutputStreamVisitor( *mOfile, true ) );
     }
     else {
@@ -40,6 +40,7 @@
 #include "util/base/include/definitions.h"
 #include <iomanip>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <cassert>
 #include <xercesc/dom/DOMNode.hpp>
@@ -112,7 +113,8 @@ const string MagiccModel::sInputGasUnits[] = { "(Pg C)",
 /*! \brief Constructor
 * \param aModeltime Pointer to the global modeltime object.
 */
-MagiccModel::MagiccModel()
+MagiccModel::MagiccModel():
+mContext( new MagiccContext() )
 {
     mGHGInputFileName = "";
     mIsValid = false;
@@ -130,6 +132,10 @@ MagiccModel::MagiccModel()
     mNumberHistoricalDataPoints = 0; // internal counter
 }
 
+//! Destructor
+MagiccModel::~MagiccModel() {
+}
+
 /*! \brief Complete the initialization of the MagiccModel.
 * \details This function first resizes the internal vectors which store
 *          emissions by gas and period. It then reads in the default set of data
@@ -200,25 +206,25 @@ void MagiccModel::completeInit( const string& aScenarioName ){
 void MagiccModel::overwriteMAGICCParameters( ){
     // Override parameters in MAGICC if necessary
     int varIndex = 1;
-    SETPARAMETERVALUES( varIndex, mClimateSensitivity );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mClimateSensitivity );
     varIndex = 2;
-    SETPARAMETERVALUES( varIndex, mSoilTempFeedback );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mSoilTempFeedback );
     varIndex = 3;
-    SETPARAMETERVALUES( varIndex, mHumusTempFeedback );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mHumusTempFeedback );
     varIndex = 4;
-    SETPARAMETERVALUES( varIndex, mGPPTempFeedback );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mGPPTempFeedback );
     varIndex = 5;
-    SETPARAMETERVALUES( varIndex, mNetDeforestCarbFlux80s );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mNetDeforestCarbFlux80s );
     varIndex = 6;
-    SETPARAMETERVALUES( varIndex, mOceanCarbFlux80s );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mOceanCarbFlux80s );
     varIndex = 7;
-    SETPARAMETERVALUES( varIndex, mSO2Dir1990 );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mSO2Dir1990 );
     varIndex = 8;
-    SETPARAMETERVALUES( varIndex, mSO2Ind1990 );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mSO2Ind1990 );
     varIndex = 9;
-    SETPARAMETERVALUES( varIndex, mBCUnitForcing );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mBCUnitForcing );
     varIndex = 10;
-    SETPARAMETERVALUES( varIndex, mOCUnitForcing );
+    SETPARAMETERVALUES( mContext.get(), varIndex, mOCUnitForcing );
 }
 
 //! parse MAGICC xml object
@@ -490,44 +496,36 @@ double MagiccModel::getEmissions( const string& aGasName,
     return static_cast<double>( ( aYear - x1 ) * ( y2 - y1 ) ) / static_cast<double>( ( x2 - x1 ) ) + y1;
 }
 
-/*! \brief Write out the MAGICC emissions file.
- * \details This function writes emissions to the MAGICC input file.
- *          The first part of this function writes out historical data from
+/*! \brief Set the emissions MAGICC will be run with.
+ * \details This function fills in the emissions table in the MAGICC context
+ *          which MAGICC reads directly rather than parsing a gas.emk file.
+ *          The first part of this function sets historical data from
  *          the default emissions file. This data can be for any years, but
  *          must include the model critical year (2000). 
  *          GCAM emissions are used for years past the last historical year
  *          as specified by the user. 
  *          Emissions are interpolated in-between years without data.
  */
-void MagiccModel::writeMAGICCEmissionsFile(){
-    const int OUT_PRECISION = 4; // Number of decimals
-    
-    // Open a stringstream until are ready to print to file
-    ostringstream gasFileData;
-    
-    // Setup the output format.
-    gasFileData.setf( ios::right, ios::adjustfield );
-    gasFileData.setf( ios::fixed, ios::floatfield );
-    gasFileData.setf( ios::showpoint );
+void MagiccModel::setMAGICCEmissions(){
+    vector<vector<float> >& emissionRows = mContext->GASEMK.ROWS;
+    emissionRows.clear();
+    mContext->GASEMK.MNEM = " Scenario " + mScenarioName;
 
-    int lastHistoricalData = 0; // Last historical data point written out
-    int numberOfDataPoints = 0; // Number of data points written to magicc input file
+    int lastHistoricalData = 0; // Last historical data point used
 
-    // First write out data for historical years
+    // First set data for historical years
     for( unsigned int index = 0; index < mNumberHistoricalDataPoints; ++index ){
         int year = static_cast<int>( floor( mDefaultEmissionsByGas[ 0 ][ index ] ) );
         if ( ( year <= mLastHistoricalYear ) ) {
-            gasFileData << setw( 4 ) <<  year << ",";
             lastHistoricalData = index;
+            vector<float> row( 1, year );
             for( unsigned int gasNumber = 0; gasNumber < getNumInputGases(); ++gasNumber ){
-                // Write out exogenous emissions for each gas.
-                gasFileData << setw( 6 + OUT_PRECISION ) << setprecision( OUT_PRECISION ) << mDefaultEmissionsByGas[ gasNumber +1 ][ index ];
-                
-                // Need to deal with 1) interpolation between history and model, 
-                writeComma( gasNumber, numberOfDataPoints, gasFileData );
+                // Set exogenous emissions for each gas.
+                row.push_back( roundEmissions( mDefaultEmissionsByGas[ gasNumber +1 ][ index ] ) );
             }
+            emissionRows.push_back( row );
         }
-        else { // If are past last historical year, exit loop, finished writting default emissions
+        else { // If are past last historical year, exit loop, finished with default emissions
             break;
         }
     }
@@ -540,29 +538,25 @@ void MagiccModel::writeMAGICCEmissionsFile(){
     // Keep track of the next model year to use for interpolating in-between historical and model data.
     int firstModelYear = startYear; 
 
-    // Now begin to write out model output emissions
-    // We want to write model emissions to MAGICC annually to eliminate errors
+    // Now begin to set model output emissions
+    // We want to pass model emissions to MAGICC annually to eliminate errors
     // with the LUC CO2 emissions
     for( unsigned int year = startYear; year <= endYear; year++ ) {
 		int period =  modeltime->getyr_to_per( year );
         
-        // If are past historical years, write out model emissions for every year past final cal year, a model year, and GAS_EMK_CRIT_YEAR 
+        // If are past historical years, set model emissions for every year past final cal year, a model year, and GAS_EMK_CRIT_YEAR 
         if ( year > mLastHistoricalYear ) { 
             if ( modeltime->isModelYear( year ) || year == GAS_EMK_CRIT_YEAR || year > finalCalYear ) {
-                std::vector<int>::iterator yearIterator; // Need this several times
+                vector<float> row( 1, year );
                
-                // Write out model emissions for all the gases if past historical emissions year.
+                // Set model emissions for all the gases if past historical emissions year.
                 for( unsigned int gasNumber = 0; gasNumber < getNumInputGases(); ++gasNumber ){
-                     if ( gasNumber == 0 ) {
-                        gasFileData << setw( 4 ) << year << ",";
-                    }
                     // We are always passing GCAM LUC carbon emissions to MAGICC annually.
                     // Therefore, LUC Emissions are not interpolated between historical and GCAM values.
                     // Historical LUC emissions vary from year-to year in any event, so some jumps between historical
                     // and model data are acceptable
                     if ( sInputGasNames[ gasNumber ] == "CO2NetLandUse" ) { 
-                        gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION )
-                                    << mLUCEmissionsByYear[ year - modeltime->getStartYear() - 1 ];
+                        row.push_back( roundEmissions( mLUCEmissionsByYear[ year - modeltime->getStartYear() - 1 ] ) );
                     }
                     // For all emissions other than LUC carbon
                     else {
@@ -580,18 +574,16 @@ void MagiccModel::writeMAGICCEmissionsFile(){
                                 previousValue = mDefaultEmissionsByGas[ gasNumber + 1 ] [ lastHistoricalData ];
                             }
                             
-                            gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION )
-                             << util::linearInterpolateY( year, prevYear, nextYear, previousValue, nextValue );
+                            row.push_back( roundEmissions( util::linearInterpolateY( year, prevYear, nextYear, previousValue, nextValue ) ) );
                         }
                         else {
-                            // Write out model emission for this gas.
-                            gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION )
-                                        << mModelEmissionsByGas[ gasNumber ][ period ];
+                            // Set model emission for this gas.
+                            row.push_back( roundEmissions( mModelEmissionsByGas[ gasNumber ][ period ] ) );
                         }
                     }
-                    writeComma( gasNumber, numberOfDataPoints, gasFileData );
                 } // end gasnumber loop 
-            } // end loop - write-out model emissions.
+                emissionRows.push_back( row );
+            } // end loop - set model emissions.
         } 
         else {
             // If this was a historical year, then keep track of next model period.
@@ -605,71 +597,93 @@ void MagiccModel::writeMAGICCEmissionsFile(){
         int period = modeltime->getmaxper();
         for ( unsigned int extra = 0; extra < getNumAdditionalGasPoints(); extra++ ) {
             year = year + 10;
-            gasFileData << setw( 4 ) << year << ",";
-            // Write out all the gases.
+            vector<float> row( 1, year );
+            // Set all the gases.
             for( unsigned int gasNumber = 0; gasNumber < getNumInputGases(); ++gasNumber ){
                 if ( sInputGasNames[ gasNumber ] == "CO2NetLandUse" ) {
                     int index = modeltime->getEndYear() - modeltime->getStartYear() + extra - 1;
-                    gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION )
-                    << mLUCEmissionsByYear[ index ];
+                    row.push_back( roundEmissions( mLUCEmissionsByYear[ index ] ) );
                 }
                 else {
-                    gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION ) 
-                                << mModelEmissionsByGas[ gasNumber ][ period ]; //sjsTEMP - this should be +1, but that's strange.
+                    row.push_back( roundEmissions( mModelEmissionsByGas[ gasNumber ][ period ] ) ); //sjsTEMP - this should be +1, but that's strange.
                 }
-                writeComma( gasNumber, numberOfDataPoints, gasFileData );
             }
+            emissionRows.push_back( row );
         }
     }
+}
+
+/*! \brief Round emissions to the precision MAGICC has always been given.
+ * \details Emissions used to be passed to MAGICC as text with four decimals
+ *          and read back as floats.  The same rounding is kept so that the
+ *          climate results do not change.
+ * \param aEmissions The emissions to round.
+ * \return The emissions as MAGICC would have read them from gas.emk.
+ */
+float MagiccModel::roundEmissions( const double aEmissions ) {
+    const int OUT_PRECISION = 4; // Number of decimals
+    ostringstream formatted;
+    formatted.setf( ios::fixed, ios::floatfield );
+    formatted << setprecision( OUT_PRECISION ) << aEmissions;
+    istringstream parsed( formatted.str() );
+    float roundedEmissions;
+    parsed >> roundedEmissions;
+    return roundedEmissions;
+}
+
+/*! \brief Write out the MAGICC emissions file.
+ * \details MAGICC no longer reads this file however users may still want the
+ *          gas data saved as a file which may be useful for debugging or to use
+ *          as input for a stand alone MAGICC run.  The file is only written if
+ *          requested by the configuration.
+ */
+void MagiccModel::writeMAGICCEmissionsFile() const {
+    AutoOutputFile gasFileWrapper( "climatFileName", "gas.emk" );
+    if( !gasFileWrapper.shouldWrite() ) {
+        return;
+    }
+
+    const int OUT_PRECISION = 4; // Number of decimals
+    const vector<vector<float> >& emissionRows = mContext->GASEMK.ROWS;
+    ostream& gasFile = *gasFileWrapper;
     
-    // Open the gas stream to write emissions into so that MAGICC can get them by
-    // reading this stream.
-    ostringstream gasStream;
-    
+    // Setup the output format.
+    gasFile.setf( ios::right, ios::adjustfield );
+    gasFile.setf( ios::fixed, ios::floatfield );
+    gasFile.setf( ios::showpoint );
+
     // Write out header information
-    gasStream << numberOfDataPoints << endl;
+    gasFile << emissionRows.size() << endl;
 	
     // line 2: Name of the scenario
-    gasStream << " Scenario " << mScenarioName << endl;
+    gasFile << mContext->GASEMK.MNEM << endl;
     // line 3: Blank line
-    gasStream << endl;
+    gasFile << endl;
     // line 4: Gas names includes one extra space for commas
-    gasStream << setw(5) << " ,"; // Year
+    gasFile << setw(5) << " ,"; // Year
     for( unsigned int gasNumber = 0; gasNumber < getNumInputGases(); ++gasNumber ) {
-        gasStream << setw(9) << sInputGasNames[ gasNumber ] << ',';
+        gasFile << setw(9) << sInputGasNames[ gasNumber ] << ',';
     }
-    gasStream << endl;
+    gasFile << endl;
     // line 5: Gas units
-    gasStream << setw(5) << "Year,";
+    gasFile << setw(5) << "Year,";
     for( unsigned int gasNumber = 0; gasNumber < getNumInputGases(); ++gasNumber ) {
-        gasStream << setw(9) << sInputGasUnits[ gasNumber ] << ',';
+        gasFile << setw(9) << sInputGasUnits[ gasNumber ] << ',';
     }
-    gasStream << endl;
-    
-    // Transfer bulk of data to output stream.
-    gasStream << gasFileData.str(); 
-    
-    // Set the gas data into MAGICC.
-    SET_GAS_EMK( gasStream.str() );
+    gasFile << endl;
     
-    // Check if the users still wants the gas data saved as a file which may be
-    // useful for debugging or to use as input for a stand alone MAGICC run.
-    AutoOutputFile gasFile( "climatFileName", "gas.emk" );
-    string gasEMKData = gasStream.str();
-    gasFile << gasEMKData;
-}
-
-/*! \brief Write comma.
- * \details Helper function that writes comma separator for emissions and adds one to line counter.
- */
-void MagiccModel::writeComma( int gasNumber, int& numberOfDataPoints, ostringstream& gasFile ){
-    // Write a comma as long as this is not the last gas.
-    if( gasNumber != getNumInputGases() - 1 ){
-        gasFile << ",";
-    }
-    else {
+    // Write the emissions, one row per year.
+    for( unsigned int rowIndex = 0; rowIndex < emissionRows.size(); ++rowIndex ) {
+        const vector<float>& row = emissionRows[ rowIndex ];
+        gasFile << setw( 4 ) << static_cast<int>( row[ 0 ] ) << ",";
+        for( unsigned int gasNumber = 0; gasNumber < getNumInputGases(); ++gasNumber ){
+            gasFile << setw( 6 + OUT_PRECISION ) << setprecision( OUT_PRECISION ) << row[ gasNumber + 1 ];
+            // Write a comma as long as this is not the last gas.
+            if( gasNumber != getNumInputGases() - 1 ){
+                gasFile << ",";
+            }
+        }
         gasFile << endl;
-        numberOfDataPoints++;
     }
 }
     
@@ -691,6 +705,7 @@ enum MagiccModel::runModelStatus MagiccModel::runModel(){
               mModelEmissionsByGas[ gasNumber ][ finalPeriod ] );
     }
     
+    setMAGICCEmissions( );
     writeMAGICCEmissionsFile( );
     
     // First overwrite parameters
@@ -700,7 +715,7 @@ enum MagiccModel::runModelStatus MagiccModel::runModel(){
     ILogger& mainLog = ILogger::getLogger( "main_log" );
     mainLog.setLevel( ILogger::NOTICE );
     mainLog << "Calling the climate model..."<< endl;
-    CLIMAT();
+    CLIMAT( mContext.get() );
     mainLog.setLevel( ILogger::DEBUG );
     mainLog << "Finished with CLIMAT()" << endl;
     mIsValid = true;
@@ -730,7 +745,7 @@ double MagiccModel::getConcentration( const string& aGasName,
     int year = aYear;
     int gasNumber = util::searchForValue( mOutputGasNameMap, aGasName );
     if ( gasNumber != 0 ) {
-        return GETGHGCONC( gasNumber, year );
+        return GETGHGCONC( mContext.get(), gasNumber, year );
     }
     return -1;
 }
@@ -743,7 +758,7 @@ double MagiccModel::getTemperature( const int aYear ) const {
 
     // Need to store the year locally so it can be passed by reference.
     int year = aYear;
-    return GETGMTEMP( year );
+    return GETGMTEMP( mContext.get(), year );
 }
 
 double MagiccModel::getForcing( const string& aGasName, const int aYear ) const {
@@ -755,7 +770,7 @@ double MagiccModel::getForcing( const string& aGasName, const int aYear ) const
     int year = aYear;
     int gasNumber = util::searchForValue( mOutputGasNameMap, aGasName );
     if ( gasNumber != 0 ) {
-        return GETFORCING( gasNumber, year );
+        return GETFORCING( mContext.get(), gasNumber, year );
     }
     return -1;
 }
@@ -774,7 +789,7 @@ double MagiccModel::getNetTerrestrialUptake( const int aYear ) const {
 
     int year = aYear;
     int itemNumber = 10;
-    return GETCARBONRESULTS( itemNumber, year );
+    return GETCARBONRESULTS( mContext.get(), itemNumber, year );
 }
 
 double MagiccModel::getNetOceanUptake( const int aYear ) const {
@@ -791,7 +806,7 @@ double MagiccModel::getNetOceanUptake( const int aYear ) const {
 
     int year = aYear;
     int itemNumber = 4;
-    return GETCARBONRESULTS( itemNumber, year );
+    return GETCARBONRESULTS( mContext.get(), itemNumber, year );
 }
 
 double MagiccModel::getNetLandUseChangeEmission( const int aYear ) const {
@@ -808,7 +823,7 @@ double MagiccModel::getNetLandUseChangeEmission( const int aYear ) const {
 
     int itemNumber = 2;
     int year = aYear;
-    return GETCARBONRESULTS( itemNumber, year );
+    return GETCARBONRESULTS( mContext.get(), itemNumber, year );
 }
 
 double MagiccModel::getTotalForcing( const int aYear ) const {
@@ -820,7 +835,7 @@ double MagiccModel::getTotalForcing( const int aYear ) const {
     // Need to store the year and gas number locally so it can be passed by reference.
     int year = aYear;
     int gasNumber = 0; // global forcing
-    return GETFORCING( gasNumber, year );
+    return GETFORCING( mContext.get(), gasNumber, year );
 }
 
 /*! \brief Updates a visitor with information from the the climate model.
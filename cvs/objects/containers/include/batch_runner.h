@@ -46,6 +46,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include <memory>
 #include <xercesc/dom/DOMNode.hpp>
 #include "containers/include/iscenario_runner.h"
@@ -76,6 +77,19 @@ class Timer;
  *          "BatchMode". The name of the configuration file is determined by the
  *          file configuration value "BatchFileName".
  *
+ *          Scenarios are run one after another by default.  Setting the integer
+ *          configuration value "concurrent-batch-scenarios" to a value greater
+ *          than one will instead run that many scenarios at the same time, each
+ *          in a forked child process so that it gets its own Scenario as well as
+ *          its own copy of singletons such as the Configuration and Modeltime.
+ *          The batch CSV output is merged in scenario order once all runs are
+ *          done and writing to the XML database is serialized between
+ *          processes.  Logs and other output files, including those of the
+ *          climate model, are written by each child to names which include
+ *          "_<scenario index>" so that concurrent scenarios do not write to the
+ *          same files.  This mode is not available on Windows or in parallel
+ *          builds since TBB worker threads do not survive a fork.
+ *
  *          <b>XML specification for BatchRunner</b>
  *          - XML name: \c BatchRunner
  *          - Contained by: None.
@@ -178,12 +192,35 @@ protected:
     //! The current scenario runner.
     IScenarioRunner* mInternalRunner;
 
+    //! The name of the file used to serialize writing output between concurrently
+    //! running scenarios, empty when scenarios are run serially.
+    std::string mOutputLockFileName;
+
+    //! The file descriptor of the output lock while it is held, otherwise -1.
+    int mOutputLock;
+
 	BatchRunner();
 	bool runSingleScenario( IScenarioRunner* aScenarioRunner,
                             const Component& aCurrComponent,
                             const int aSinglePeriod,
                             Timer& aTimer );
 
+#if !defined(_WIN32) && !GCAM_PARALLEL_ENABLED
+    bool runScenariosConcurrently( const std::vector<Component>& aScenarios,
+                                   const int aNumConcurrent,
+                                   const int aSinglePeriod,
+                                   Timer& aTimer );
+
+    bool runChildScenario( const Component& aComponent,
+                           const std::string& aCSVFileName,
+                           const int aSinglePeriod,
+                           Timer& aTimer );
+#endif
+
+    void lockOutput();
+
+    void unlockOutput();
+
     bool XMLParseComponentSet( const xercesc::DOMNode* aNode );
 
     bool XMLParseRunnerSet( const xercesc::DOMNode* aNode );
@@ -0,0 +1,159 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+#ifndef _COMPILED_SCENARIO_H_
+#define _COMPILED_SCENARIO_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*! 
+ * \file compiled_scenario.h
+ * \ingroup Objects
+ * \brief The CompiledScenario class header file.
+ * \author Pralit Patel
+ */
+
+#include <list>
+#include <string>
+#include <vector>
+#include <memory>
+#include <xercesc/dom/DOMNode.hpp>
+#include <xercesc/dom/DOMDocument.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "util/base/include/iparsable.h"
+
+/*! 
+ * \ingroup Objects
+ * \brief A binary snapshot of the validated XML input files of a scenario.
+ * \details Parsing the reference scenario components with Xerces, including
+ *          schema validation, can take longer than actually running a short
+ *          scenario.  A CompiledScenario records the DOM tree of each input
+ *          file as it is parsed and writes them all to a single versioned
+ *          binary file.  Later runs with the same input files memory map that
+ *          file and rebuild each DOM tree directly from it, skipping the
+ *          scanning, transcoding, and validation of the XML entirely, before
+ *          calling XMLParse just as XMLHelper::parseXML would.  Since the model
+ *          objects are only ever created through XMLParse this ensures the
+ *          scenario is identical to the one parsed from XML, and any add-on
+ *          files can still be parsed on top of it as usual.
+ *
+ *          The compiled file is only used if it was written by the same version
+ *          of GCAM, on a platform with the same byte order, and for the same
+ *          list of input files each of which is unchanged in size and
+ *          modification time.  Otherwise the input files are parsed from XML
+ *          and the compiled file is written again.
+ * \author Pralit Patel
+ */
+class CompiledScenario {
+public:
+    CompiledScenario( const std::string& aFileName,
+                      const std::list<std::string>& aInputFiles );
+    ~CompiledScenario();
+
+    bool isUpToDate();
+
+    bool load( IParsable* aModelElement );
+
+    bool compile( IParsable* aModelElement );
+
+private:
+    //! The name of the compiled scenario file.
+    const std::string mFileName;
+
+    //! The XML input files, in the order they must be parsed.
+    const std::list<std::string> mInputFiles;
+
+    //! The compiled scenario file when it has been mapped into memory.
+    std::auto_ptr<boost::interprocess::file_mapping> mFileMapping;
+
+    //! The memory mapped region of the compiled scenario file.
+    std::auto_ptr<boost::interprocess::mapped_region> mMappedRegion;
+
+    //! The offset in the mapped region at which the first document begins
+    //! which is only set once isUpToDate has checked the header.
+    size_t mDocumentsOffset;
+
+    //! The serialized DOM trees built up while compiling.
+    std::vector<char> mBuffer;
+
+    /*!
+     * \brief An IParsable which records the DOM tree before passing it along
+     *        to the model element which should actually parse it.
+     */
+    class Recorder : public IParsable {
+    public:
+        Recorder( CompiledScenario* aParent, IParsable* aModelElement );
+        virtual bool XMLParse( const xercesc::DOMNode* aNode );
+    private:
+        //! The compiled scenario to record the DOM tree into.
+        CompiledScenario* mParent;
+
+        //! The model element which will parse the DOM tree.
+        IParsable* mModelElement;
+    };
+
+    /*!
+     * \brief A bounds checked position in the mapped compiled scenario file.
+     */
+    struct Cursor {
+        //! The start of the mapped file.
+        const char* mBegin;
+
+        //! The current position which is always a multiple of four from mBegin.
+        size_t mPos;
+
+        //! The size of the mapped file.
+        size_t mSize;
+
+        bool readUInt32( unsigned int& aValue );
+        bool readXMLString( const XMLCh*& aValue );
+    };
+
+    bool createHeader( std::vector<char>& aHeader ) const;
+
+    static void writeUInt32( std::vector<char>& aBuffer, const unsigned int aValue );
+    static void writeUInt64( std::vector<char>& aBuffer, const unsigned long long aValue );
+    static void writeString( std::vector<char>& aBuffer, const std::string& aValue );
+    static void writeXMLString( std::vector<char>& aBuffer, const XMLCh* aValue );
+    static void writeNode( std::vector<char>& aBuffer, const xercesc::DOMNode* aNode );
+    static void writePadding( std::vector<char>& aBuffer );
+
+    static xercesc::DOMNode* readNode( Cursor& aCursor, xercesc::DOMDocument* aDocument );
+
+    static bool getFileStatus( const std::string& aFileName,
+                               unsigned long long& aSize,
+                               unsigned long long& aModifiedTime );
+};
+
+#endif // _COMPILED_SCENARIO_H_
@@ -0,0 +1,116 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+#ifndef _DEPENDENCY_CACHE_H_
+#define _DEPENDENCY_CACHE_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*! 
+ * \file dependency_cache.h
+ * \ingroup Objects
+ * \brief The DependencyCache class header file.
+ * \author Pralit Patel
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+/*! 
+ * \ingroup Objects
+ * \brief An on disk cache of the results of analyzing the model dependencies
+ *        which only depend on the structure of the model.
+ * \details The MarketDependencyFinder computes an ordered list of activities to
+ *          calculate for each solved market and, in parallel builds, analyzes the
+ *          global and per market flow graphs into grains of activities.  None of
+ *          this depends on data values so it can be shared by every scenario
+ *          with the same model structure.  Activities are identified by the
+ *          unique id of their calc vertex.
+ *
+ *          The cache is keyed by a digest which the MarketDependencyFinder
+ *          builds up from the dependency edges, activity names, and any
+ *          parameters which affect the analysis.  If the digest in the file
+ *          does not match the contents are discarded and everything will be
+ *          recomputed, and saved again, as needed.
+ * \author Pralit Patel
+ */
+class DependencyCache {
+public:
+    //! The calc vertex ids in each grain in the order they are calculated.
+    typedef std::vector<std::vector<int> > GrainList;
+
+    //! The indices of the grains which depend on each grain.
+    typedef std::vector<std::vector<size_t> > GrainSuccessorList;
+
+    explicit DependencyCache( const std::string& aFileName );
+
+    void addToDigest( const std::string& aValue );
+
+    void addToDigest( const int aValue );
+
+    bool load();
+
+    void save();
+
+    bool getOrdering( const int aMarketNumber, std::vector<int>& aOrdering ) const;
+
+    void setOrdering( const int aMarketNumber, const std::vector<int>& aOrdering );
+
+    bool getGrains( const int aMarketNumber, GrainList& aGrains, GrainSuccessorList& aGrainSuccessors ) const;
+
+    void setGrains( const int aMarketNumber, const GrainList& aGrains,
+                    const GrainSuccessorList& aGrainSuccessors );
+
+private:
+    //! The name of the cache file.
+    const std::string mFileName;
+
+    //! A 64 bit FNV-1a hash of everything the cached results depend on.
+    unsigned long long mDigest;
+
+    //! Whether results have been added since the cache was loaded.
+    bool mIsModified;
+
+    //! The cached orderings by market number.
+    std::map<int, std::vector<int> > mOrderings;
+
+    //! The cached grains, and their successors, by market number or -1 for the
+    //! global flow graph.
+    std::map<int, std::pair<GrainList, GrainSuccessorList> > mGrains;
+
+    void addBytesToDigest( const char* aBytes, const size_t aSize );
+};
+
+#endif // _DEPENDENCY_CACHE_H_
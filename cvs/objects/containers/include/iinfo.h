@@ -201,6 +201,24 @@ public:
     */
     virtual bool hasValue( const std::string& aStringKey ) const = 0;
 
+    /*! \brief Resolve a key to the location of its double value.
+    * \details Searches for the key once, in the same manner as getDouble, and
+    *          returns the location at which the value is stored. Callers which
+    *          read the same value repeatedly during model calculations should
+    *          resolve the key during initialization and then read through the
+    *          returned pointer, which avoids building the key, hashing it and
+    *          converting the stored value on every read. The location remains
+    *          valid for the lifetime of the IInfo which contains the value and
+    *          reflects later updates made through setDouble.
+    * \param aStringKey The key for which to search the IInfo object.
+    * \param aMustExist Whether the value should exist in the IInfo.
+    * \return A pointer to the stored double, or null if it does not exist.
+    * \warning The value must not be changed to a different type once it has
+    *          been resolved.
+    */
+    virtual const double* resolveDouble( const std::string& aStringKey,
+                                         const bool aMustExist ) const = 0;
+
     /*! \brief Write the IInfo object to an output stream as XML.
     * \details Writes the set of keys and values to an output stream as XML.
     * \param aPeriod Model period for which to write debugging information.
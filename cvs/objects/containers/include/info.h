@@ -102,6 +102,8 @@ public:
 
     bool hasValue( const std::string& aStringKey ) const;
 
+    const double* resolveDouble( const std::string& aStringKey, const bool aMustExist ) const;
+
     void toDebugXML( const int aPeriod, Tabs* aTabs, std::ostream& aOut ) const;
 protected:
     Info( const IInfo* aParentInfo, const std::string& aOwnerName );
@@ -133,6 +135,8 @@ private:
 
     template<class T> const T& getItemValueLocal( const std::string& aStringKey, bool& aExists ) const;
 
+    template<class T> const T* getItemLocationLocal( const std::string& aStringKey ) const;
+
     size_t getInitialSize() const;
 
     void printItemNotFoundWarning( const std::string& aStringKey ) const;
@@ -209,6 +213,15 @@ template<class T> bool Info::setItemValueLocal( const std::string& aStringKey,
     // acquire a write lock for updating the infomap
     tbb::queuing_rw_mutex::scoped_lock writelock(mInfoMapMutex, true);
 #endif
+    // Update an existing value of the same type in place so that locations
+    // returned by resolveDouble remain valid.
+    InfoMap::iterator curr = mInfoMap->find( aStringKey );
+    T* currValue = curr != mInfoMap->end() ? boost::any_cast<T>( &curr->second.second ) : 0;
+    if( currValue ){
+        *currValue = aValue;
+        return true;
+    }
+
     // Add the value regardless of whether a warning was printed.
     mInfoMap->insert( std::make_pair( aStringKey, std::make_pair( aType, boost::any( aValue ) ) ) );
     return true;
@@ -218,7 +231,6 @@ template<class T> bool Info::setItemValueLocal( const std::string& aStringKey,
 *          location.
 * \author Josh Lurz
 * \param aStringKey The string key for which to find the value.
-* \param aMustExist Whether it is an error for the item to be missing.
 * \param aExists Return parameter to update with whether the item existed.
 * \return The value associated with the key if it exists, the default value
 *         otherwise. 
@@ -234,6 +246,26 @@ template<class T>
 const T& Info::getItemValueLocal( const std::string& aStringKey,
                                  bool& aExists ) const
 {
+    const T* valp = getItemLocationLocal<T>( aStringKey );
+    if( valp ){
+        aExists = true;
+        return *valp;
+    }
+
+    // Return the default value if a successful return has not already occurred.
+    aExists = false;
+    static const T defaultValue = T();
+    return defaultValue;
+}
+
+/*! \brief Get the location at which the value of an item is stored in the
+*          local map.
+* \param aStringKey The string key for which to find the value.
+* \return A pointer to the stored value, or null if the item does not exist
+*         locally or is stored with a different type.
+*/
+template<class T>
+const T* Info::getItemLocationLocal( const std::string& aStringKey ) const {
     /*! \pre A valid key was passed. */
     assert( !aStringKey.empty() );
 
@@ -244,9 +276,8 @@ const T& Info::getItemValueLocal( const std::string& aStringKey,
     // Check for the value.
     InfoMap::const_iterator curr = mInfoMap->find( aStringKey );
     if( curr != mInfoMap->end() ){
-        aExists = true;
-        // Attempt to set the return value to the found value. This requires
-        // converting the data from the actual type to the requested type.
+        // Attempt to convert the data from the actual type to the requested
+        // type.
         try {
             // NB: By my reading of the boost docs, the pointer version of
             // any_cast() used below will never throw an exception, so this
@@ -259,7 +290,7 @@ const T& Info::getItemValueLocal( const std::string& aStringKey,
             // for the pointer version of the cast.
             const T *valp = boost::any_cast<T>( &curr->second.second );
             if(valp)
-                return *valp;
+                return valp;
             else
                 printBadCastWarning(aStringKey, false);
         }
@@ -269,11 +300,7 @@ const T& Info::getItemValueLocal( const std::string& aStringKey,
             printBadCastWarning( aStringKey, false );
         }
     }
-
-    // Return the default value if a successful return has not already occurred.
-    aExists = false;
-    static const T defaultValue = T();
-    return defaultValue;
+    return 0;
 }
 
 /*!
@@ -48,11 +48,15 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
+#include <memory>
 
 class Marketplace;
 class IActivity;
+class DependencyCache;
 #if GCAM_PARALLEL_ENABLED
 class GcamFlowGraph;
+class GcamParallel;
 #endif
 
 /*! 
@@ -80,6 +84,12 @@ class GcamFlowGraph;
  *                specific ordering a search will be performed to get a complete
  *                list of items to calculate.
  *
+ *          Market specific orderings and the flow graphs used to calculate in
+ *          parallel only depend on the structure of the model.  When a
+ *          dependencyCacheFileName is configured they are kept in a
+ *          DependencyCache which is loaded after createOrdering so that later
+ *          runs of the same model can skip recomputing them.
+ *
  * \author Pralit Patel
  */
 class MarketDependencyFinder
@@ -98,6 +108,8 @@ public:
 
 #if GCAM_PARALLEL_ENABLED
     GcamFlowGraph* getFlowGraph( const int aMarketNumber = -1 );
+    
+    GcamFlowGraph* regrainFlowGraph();
 #endif
 
     void resolveActivityToDependency( const std::string& aRegionName, 
@@ -331,6 +343,15 @@ public:
 
     //! A UID counter to able to compare CalcVertex uniquely between runs
     int mCalcVertexUIDCount;
+    
+    //! The cache of analysis results from previous runs or null if not in use.
+    std::auto_ptr<DependencyCache> mCache;
+    
+    //! The activity of each CalcVertex indexed by UID to translate cached results.
+    std::vector<IActivity*> mActivityByUID;
+    
+    //! The UID of the CalcVertex of each activity to translate results to cache.
+    std::map<IActivity*, int> mUIDByActivity;
 
 #if GCAM_PARALLEL_ENABLED
     //! The global flow graph to calculate the full model in parallel
@@ -342,6 +363,13 @@ public:
                                 CalcVertexCountMap& aTotalVisits ) const;
     int markCycles( CalcVertex* aCurrVertex, std::list<CalcVertex*>& aHasVisited, CalcVertexCountMap& aTotalVisits ) const;
     void createTrialsForItem( CItemIterator aItemToReset, CalcVertexCountMap& aNumDependencies );
+    void loadCache();
+    bool convertFromUIDs( const std::vector<int>& aUIDs, std::vector<IActivity*>& aActivities ) const;
+    std::vector<int> convertToUIDs( const std::vector<IActivity*>& aActivities ) const;
+#if GCAM_PARALLEL_ENABLED
+    bool loadCachedFlowGraph( const int aMarketNumber, GcamParallel& aParallel, GcamFlowGraph& aTBBGraph ) const;
+    void saveCachedFlowGraph( const int aMarketNumber, const GcamFlowGraph& aTBBGraph );
+#endif
 };
 
 #endif // _MARKET_DEPENDENCY_FINDER_H_
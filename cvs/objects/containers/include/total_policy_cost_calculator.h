@@ -112,6 +112,13 @@ private:
     RegionCurves mRegionalCostCurves;
 
     bool runTrials();
+    bool runTrial( const int aPoint, const bool aPrintDebugging );
+    void setTrialTaxes( const int aPoint );
+#if !defined(_WIN32) && !GCAM_PARALLEL_ENABLED
+    bool runTrialsConcurrently( const int aNumConcurrent );
+    bool writeTrialCurves( const int aPoint, const std::string& aFileName ) const;
+    bool readTrialCurves( const int aPoint, const std::string& aFileName );
+#endif
     void createCostCurvesByPeriod();
     void createRegionalCostCurves();
     const std::string createXMLOutputString() const;
@@ -110,6 +110,7 @@ public:
     std::map<std::string, const Curve*> getEmissionsPriceCurves( const std::string& ghgName ) const;
     CalcCounter* getCalcCounter() const;
     int getGlobalOrderingSize() const {return mGlobalOrdering.size();}
+    const std::vector<IActivity*>& getGlobalOrdering() const {return mGlobalOrdering;}
     
     const GlobalTechnologyDatabase* getGlobalTechnologyDatabase() const;
 
@@ -53,6 +53,19 @@
 #include "util/logger/include/ilogger.h"
 #include "containers/include/scenario.h"
 #include "reporting/include/batch_csv_outputter.h"
+#include "util/base/include/auto_file.h"
+#include "util/base/include/util.h"
+
+#include <fstream>
+#include <cstdio>
+#include <map>
+#include <algorithm>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#endif
 
 using namespace std;
 using namespace xercesc;
@@ -65,7 +78,8 @@ typedef list<IScenarioRunner*>::iterator RunnerIterator;
  * \brief Constructor
  */
 BatchRunner::BatchRunner() :
-mInternalRunner( 0 ){ 
+mInternalRunner( 0 ),
+mOutputLock( -1 ){ 
 }
 
 //! Destructor
@@ -119,7 +133,7 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
     // The scenarios are created by determining all possible combinations of
     // file sets. The algorithm operates as follows:
     // 1) Set the current file set in each component to the initial position.
-    // 2) Run the scenario.
+    // 2) Add the scenario to the list of scenarios to run.
     // 3) Set the current component to the first.
     // 4) Increment the current file set in the current component.
     // 5a) If this is a valid position in the current component and go to 2.
@@ -134,9 +148,8 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
     //
     // All generated scenarios are run with each scenario runner in the order in
     // which the scenario runners were read.
+    vector<Component> scenariosToRun;
     bool shouldExit = false;
-    bool success = true;
-    BatchCSVOutputter csvOutputter;
     while( !shouldExit ){
         // The data structure containing the current run.
         Component fileSetsToRun;
@@ -146,17 +159,7 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
             fileSetsToRun.mFileSets.push_back( *( currSet->mFileSetIterator ) );
             fileSetsToRun.mName += currSet->mFileSetIterator->mName;
         }
-
-        // Run it using each possible type of IScenarioRunner.
-        for( RunnerIterator runner = mScenarioRunners.begin(); runner != mScenarioRunners.end(); ++runner ){
-            bool scenarioSuccess = runSingleScenario( *runner, fileSetsToRun, aSinglePeriod, aTimer );
-            success &= scenarioSuccess;
-            (*runner)->getInternalScenario()->accept( &csvOutputter, -1 );
-            csvOutputter.writeDidScenarioSolve( scenarioSuccess );
-            // Clean up the current scenario runner before we move on to the next
-            // so that we do not accumulate a large amount of idle memory.
-            (*runner)->cleanup();
-        }
+        scenariosToRun.push_back( fileSetsToRun );
 
         // Loop forward to find a position to increment.
         for( ComponentSet::iterator outPos = mComponentSet.begin(); outPos != mComponentSet.end(); ++outPos ){
@@ -175,9 +178,191 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
             }
         }
     }
+
+    const int numConcurrent = Configuration::getInstance()->getInt( "concurrent-batch-scenarios", 1, false );
+    if( numConcurrent > 1 && scenariosToRun.size() > 1 ){
+#if !defined(_WIN32) && !GCAM_PARALLEL_ENABLED
+        return runScenariosConcurrently( scenariosToRun, numConcurrent, aSinglePeriod, aTimer );
+#else
+        // TBB worker threads started by this process do not survive a fork so
+        // the children could not safely calculate in parallel.
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Running batch scenarios concurrently is not supported on this platform or build, running them serially." << endl;
+#endif
+    }
+
+    bool success = true;
+    BatchCSVOutputter csvOutputter;
+    for( vector<Component>::const_iterator currScenario = scenariosToRun.begin(); currScenario != scenariosToRun.end(); ++currScenario ){
+        // Run it using each possible type of IScenarioRunner.
+        for( RunnerIterator runner = mScenarioRunners.begin(); runner != mScenarioRunners.end(); ++runner ){
+            bool scenarioSuccess = runSingleScenario( *runner, *currScenario, aSinglePeriod, aTimer );
+            success &= scenarioSuccess;
+            (*runner)->getInternalScenario()->accept( &csvOutputter, -1 );
+            csvOutputter.writeDidScenarioSolve( scenarioSuccess );
+            // Clean up the current scenario runner before we move on to the next
+            // so that we do not accumulate a large amount of idle memory.
+            (*runner)->cleanup();
+        }
+    }
     return success;
 }
 
+#if !defined(_WIN32) && !GCAM_PARALLEL_ENABLED
+/*!
+ * \brief Run the generated scenarios several at a time.
+ * \details Each scenario is run in a child process forked from this one.  Since
+ *          the parent process has only parsed the batch file at this point each
+ *          child starts from a clean model state and its own copy of the global
+ *          scenario and singletons.  At most aNumConcurrent children are running
+ *          at any time.  When a child finishes it reports through its exit code
+ *          whether all of its runs solved.  The batch CSV output of each child is
+ *          written to a separate file and these are combined in scenario order
+ *          once all children are done so that the results do not depend on the
+ *          order in which the scenarios happen to finish.  All other output and
+ *          log files of a child include "_<scenario index>" in their names.
+ * \param aScenarios The scenarios to run in order.
+ * \param aNumConcurrent The maximum number of scenarios to run at once.
+ * \param aSinglePeriod The model period to run.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \return Whether all model runs solved successfully.
+ */
+bool BatchRunner::runScenariosConcurrently( const vector<Component>& aScenarios,
+                                            const int aNumConcurrent,
+                                            const int aSinglePeriod,
+                                            Timer& aTimer )
+{
+    const Configuration* conf = Configuration::getInstance();
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Running " << aScenarios.size() << " scenarios with up to "
+            << aNumConcurrent << " at a time." << endl;
+
+    // The restart files are written to the same names by each scenario unless
+    // the scenario name is appended.  Concurrent scenarios would then be writing
+    // to the same file at once.
+    if( conf->shouldWriteFile( "restart", false, false ) && !conf->shouldAppendScnToFile( "restart" ) ){
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Restart files are written without the scenario name and may be garbled by concurrent scenarios." << endl;
+    }
+
+    // Writing to the XML database from several processes at once is not safe so
+    // each child will hold an exclusive lock on this file while writing output.
+    if( conf->shouldWriteFile( "xmldb-location" ) ){
+        mOutputLockFileName = conf->getFile( "xmldb-location", "database_basexdb" ) + ".batch-lock";
+    }
+
+    const bool writeCSV = conf->shouldWriteFile( "batchCSVOutputFile" );
+    const string csvFileName = conf->getFile( "batchCSVOutputFile", "batch-csv-out.csv" );
+
+    const vector<bool> didSolve = util::runInChildProcesses( aScenarios.size(), aNumConcurrent,
+        [&] ( const size_t aScnIndex ) {
+            const string childCSVFileName = writeCSV ? csvFileName + "." + util::toString( aScnIndex ) : "";
+            return runChildScenario( aScenarios[ aScnIndex ], childCSVFileName, aSinglePeriod, aTimer );
+        },
+        [&aScenarios] ( const size_t aScnIndex ) {
+            return "scenario " + aScenarios[ aScnIndex ].mName;
+        } );
+
+    // Combine the CSV results from each scenario in order.  Each child wrote a
+    // header line and only the first one is kept.
+    if( writeCSV ){
+        AutoOutputFile csvFile( "batchCSVOutputFile", "batch-csv-out.csv" );
+        bool wroteHeader = false;
+        for( size_t scnIndex = 0; scnIndex < aScenarios.size(); ++scnIndex ){
+            const string childCSVFileName = csvFileName + "." + util::toString( scnIndex );
+            ifstream childCSV( childCSVFileName.c_str() );
+            string line;
+            for( bool isHeader = true; getline( childCSV, line ); isHeader = false ){
+                if( !isHeader || !wroteHeader ){
+                    *csvFile << line << endl;
+                }
+                wroteHeader |= isHeader;
+            }
+            childCSV.close();
+            remove( childCSVFileName.c_str() );
+        }
+    }
+    if( !mOutputLockFileName.empty() ){
+        remove( mOutputLockFileName.c_str() );
+    }
+
+    bool success = true;
+    for( size_t scnIndex = 0; scnIndex < aScenarios.size(); ++scnIndex ){
+        if( !didSolve[ scnIndex ] ){
+            mUnsolvedNames.push_back( aScenarios[ scnIndex ].mName );
+            success = false;
+        }
+    }
+    return success;
+}
+
+/*!
+ * \brief Run a single scenario with each scenario runner from within a child
+ *        process started by runScenariosConcurrently.
+ * \param aComponent The scenario to run.
+ * \param aCSVFileName The file to write batch CSV results to, or empty if they
+ *                     should not be written.
+ * \param aSinglePeriod The model period to run.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \return Whether all model runs solved successfully.
+ */
+bool BatchRunner::runChildScenario( const Component& aComponent,
+                                    const string& aCSVFileName,
+                                    const int aSinglePeriod,
+                                    Timer& aTimer )
+{
+    // Unsolved names are only tracked by the parent.
+    mUnsolvedNames.clear();
+    auto_ptr<BatchCSVOutputter> csvOutputter( aCSVFileName.empty() ?
+        new BatchCSVOutputter() : new BatchCSVOutputter( aCSVFileName ) );
+    bool success = true;
+    for( RunnerIterator runner = mScenarioRunners.begin(); runner != mScenarioRunners.end(); ++runner ){
+        bool scenarioSuccess = runSingleScenario( *runner, aComponent, aSinglePeriod, aTimer );
+        success &= scenarioSuccess;
+        (*runner)->getInternalScenario()->accept( csvOutputter.get(), -1 );
+        csvOutputter->writeDidScenarioSolve( scenarioSuccess );
+        // Cleaning up finalizes the XML database so the output lock taken when
+        // printing output is held until it is done.
+        (*runner)->cleanup();
+        unlockOutput();
+    }
+    return success;
+}
+#endif
+
+/*!
+ * \brief Take the lock which serializes writing output between concurrently
+ *        running scenarios.
+ * \details Does nothing when scenarios are run serially.  The lock is held until
+ *          unlockOutput is called.
+ */
+void BatchRunner::lockOutput() {
+#if !defined(_WIN32)
+    if( !mOutputLockFileName.empty() && mOutputLock < 0 ){
+        mOutputLock = ::open( mOutputLockFileName.c_str(), O_RDWR | O_CREAT, 0644 );
+        if( mOutputLock >= 0 ){
+            flock( mOutputLock, LOCK_EX );
+        }
+    }
+#endif
+}
+
+/*!
+ * \brief Release the lock taken by lockOutput if it is held.
+ */
+void BatchRunner::unlockOutput() {
+#if !defined(_WIN32)
+    if( mOutputLock >= 0 ){
+        flock( mOutputLock, LOCK_UN );
+        ::close( mOutputLock );
+        mOutputLock = -1;
+    }
+#endif
+}
+
 void BatchRunner::printOutput( Timer& aTimer ) const {
     // Print out any scenarios that did not solve.
     ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -264,7 +449,10 @@ bool BatchRunner::runSingleScenario( IScenarioRunner* aScenarioRunner,
     // Run the scenario.
     success = mInternalRunner->runScenarios( runPeriod, false, aTimer );
     
-    // Print the output.
+    // Print the output.  When scenarios are running concurrently only one may
+    // write at a time and the lock is held until the scenario runner has been
+    // cleaned up.
+    lockOutput();
     mInternalRunner->printOutput( aTimer );
     
     // If the run failed, add to the list of failed runs. CHECK ME!
@@ -0,0 +1,468 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*! 
+ * \file compiled_scenario.cpp
+ * \ingroup Objects
+ * \brief CompiledScenario class source file.
+ * \author Pralit Patel
+ */
+
+#include "util/base/include/definitions.h"
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <xercesc/dom/DOMImplementation.hpp>
+#include <xercesc/dom/DOMElement.hpp>
+#include <xercesc/dom/DOMNamedNodeMap.hpp>
+#include <xercesc/dom/DOMNodeList.hpp>
+#include <xercesc/dom/DOMText.hpp>
+#include <xercesc/util/XMLString.hpp>
+#include "containers/include/compiled_scenario.h"
+#include "util/base/include/xml_helper.h"
+#include "util/base/include/util.h"
+#include "util/base/include/version.h"
+#include "util/logger/include/ilogger.h"
+
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace xercesc;
+
+namespace {
+    //! Identifies the file as a compiled scenario.
+    const char COMPILED_SCENARIO_MAGIC[ 8 ] = { 'G', 'C', 'A', 'M', 'C', 'S', 'N', '\0' };
+
+    //! The version of the compiled scenario format which must be incremented
+    //! whenever the layout of the file changes.
+    const unsigned int COMPILED_SCENARIO_FORMAT_VERSION = 1;
+
+    //! A value written in native byte order to detect files written on a
+    //! platform with a different byte order.
+    const unsigned int BYTE_ORDER_MARK = 0x01020304;
+}
+
+/*!
+ * \brief Constructor.
+ * \param aFileName The name of the compiled scenario file.
+ * \param aInputFiles The XML input files, in the order they must be parsed,
+ *        which are contained in the compiled scenario.
+ */
+CompiledScenario::CompiledScenario( const string& aFileName,
+                                    const list<string>& aInputFiles ):
+mFileName( aFileName ),
+mInputFiles( aInputFiles ),
+mDocumentsOffset( 0 )
+{
+}
+
+//! Destructor.
+CompiledScenario::~CompiledScenario() {
+}
+
+/*!
+ * \brief Check if the compiled scenario file exists and was compiled from the
+ *        current input files by this version of GCAM.
+ * \details The file is memory mapped so that it may be loaded if it is up to
+ *          date.
+ * \return Whether the compiled scenario may be loaded.
+ */
+bool CompiledScenario::isUpToDate() {
+    vector<char> header;
+    if( !createHeader( header ) ) {
+        return false;
+    }
+
+    try {
+        mFileMapping.reset( new boost::interprocess::file_mapping( mFileName.c_str(), boost::interprocess::read_only ) );
+        mMappedRegion.reset( new boost::interprocess::mapped_region( *mFileMapping, boost::interprocess::read_only ) );
+    }
+    catch( const boost::interprocess::interprocess_exception& ) {
+        // The file does not exist or could not be mapped.
+        mMappedRegion.reset();
+        mFileMapping.reset();
+        return false;
+    }
+
+    if( mMappedRegion->get_size() < header.size() ||
+        memcmp( mMappedRegion->get_address(), &header[ 0 ], header.size() ) != 0 )
+    {
+        return false;
+    }
+    mDocumentsOffset = header.size();
+    return true;
+}
+
+/*!
+ * \brief Load the compiled scenario into the given model element.
+ * \details Each DOM tree is rebuilt from the mapped file in the order the input
+ *          files were originally parsed and passed to XMLParse.
+ * \pre isUpToDate has returned true.
+ * \param aModelElement Element to call XMLParse on.
+ * \return Whether loading and parsing was successful.
+ */
+bool CompiledScenario::load( IParsable* aModelElement ) {
+    /*! \pre The file has been checked and mapped. */
+    assert( mMappedRegion.get() && mDocumentsOffset > 0 );
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Loading compiled scenario " << mFileName << "." << endl;
+
+    Cursor cursor = { static_cast<const char*>( mMappedRegion->get_address() ),
+                      mDocumentsOffset, mMappedRegion->get_size() };
+    bool success = true;
+    for( size_t i = 0; i < mInputFiles.size() && success; ++i ) {
+        DOMDocument* doc = DOMImplementation::getImplementation()->createDocument();
+        const XMLCh* documentURI = 0;
+        DOMNode* root = cursor.readXMLString( documentURI ) ? readNode( cursor, doc ) : 0;
+        if( root ) {
+            // Keep the document URI so error messages still refer to the file.
+            doc->setDocumentURI( documentURI );
+            doc->appendChild( root );
+            success = aModelElement->XMLParse( root );
+        }
+        else {
+            mainLog.setLevel( ILogger::ERROR );
+            mainLog << "Compiled scenario " << mFileName << " is corrupt." << endl;
+            success = false;
+        }
+        doc->release();
+    }
+
+    mMappedRegion.reset();
+    mFileMapping.reset();
+    return success;
+}
+
+/*!
+ * \brief Parse the input files from XML into the given model element and write
+ *        the compiled scenario file.
+ * \details The file is first written under a temporary name and then renamed
+ *          so that concurrently running scenarios never see a partially written
+ *          file.  Failing to write the file is not an error since the scenario
+ *          was still parsed.
+ * \param aModelElement Element to call XMLParse on.
+ * \return Whether parsing was successful.
+ */
+bool CompiledScenario::compile( IParsable* aModelElement ) {
+    // Release any mapping of an out of date file so that it may be replaced.
+    mMappedRegion.reset();
+    mFileMapping.reset();
+    mBuffer.clear();
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    Recorder recorder( this, aModelElement );
+    for( list<string>::const_iterator currFile = mInputFiles.begin(); currFile != mInputFiles.end(); ++currFile ) {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Parsing " << *currFile << " scenario component." << endl;
+        if( !XMLHelper<void>::parseXML( *currFile, &recorder ) ) {
+            return false;
+        }
+    }
+
+    vector<char> header;
+    if( !createHeader( header ) ) {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Could not find the input files to write the compiled scenario " << mFileName << "." << endl;
+        return true;
+    }
+
+    const string tempFileName = mFileName + "." + util::toString( static_cast<int>( getpid() ) ) + ".tmp";
+    ofstream outFile( tempFileName.c_str(), ios::out | ios::binary );
+    outFile.write( &header[ 0 ], header.size() );
+    outFile.write( &mBuffer[ 0 ], mBuffer.size() );
+    outFile.close();
+    remove( mFileName.c_str() );
+    if( !outFile.good() || rename( tempFileName.c_str(), mFileName.c_str() ) != 0 ) {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Could not write the compiled scenario " << mFileName << "." << endl;
+        remove( tempFileName.c_str() );
+    }
+    else {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Wrote compiled scenario " << mFileName << "." << endl;
+    }
+    mBuffer.clear();
+    return true;
+}
+
+/*!
+ * \brief Create the header which identifies the version of GCAM and the input
+ *        files the compiled scenario was written for.
+ * \param aHeader The buffer to write the header into.
+ * \return Whether all input files could be found to create the header.
+ */
+bool CompiledScenario::createHeader( vector<char>& aHeader ) const {
+    aHeader.clear();
+    aHeader.insert( aHeader.end(), COMPILED_SCENARIO_MAGIC, COMPILED_SCENARIO_MAGIC + sizeof( COMPILED_SCENARIO_MAGIC ) );
+    writeUInt32( aHeader, COMPILED_SCENARIO_FORMAT_VERSION );
+    writeUInt32( aHeader, BYTE_ORDER_MARK );
+    writeUInt32( aHeader, sizeof( XMLCh ) );
+    writeString( aHeader, __ObjECTS_VER__ );
+    writeUInt32( aHeader, static_cast<unsigned int>( mInputFiles.size() ) );
+    for( list<string>::const_iterator currFile = mInputFiles.begin(); currFile != mInputFiles.end(); ++currFile ) {
+        unsigned long long size;
+        unsigned long long modifiedTime;
+        if( !getFileStatus( *currFile, size, modifiedTime ) ) {
+            return false;
+        }
+        writeString( aHeader, *currFile );
+        writeUInt64( aHeader, size );
+        writeUInt64( aHeader, modifiedTime );
+    }
+    return true;
+}
+
+/*!
+ * \brief Get the size and modification time of a file.
+ * \param aFileName The file name.
+ * \param aSize The size of the file in bytes.
+ * \param aModifiedTime The time the file was last modified.
+ * \return Whether the file exists.
+ */
+bool CompiledScenario::getFileStatus( const string& aFileName,
+                                      unsigned long long& aSize,
+                                      unsigned long long& aModifiedTime )
+{
+    struct stat fileStatus;
+    if( stat( aFileName.c_str(), &fileStatus ) != 0 ) {
+        return false;
+    }
+    aSize = static_cast<unsigned long long>( fileStatus.st_size );
+    aModifiedTime = static_cast<unsigned long long>( fileStatus.st_mtime );
+    return true;
+}
+
+/*!
+ * \brief Append an unsigned 32 bit integer in native byte order.
+ * \param aBuffer The buffer to append to.
+ * \param aValue The value to append.
+ */
+void CompiledScenario::writeUInt32( vector<char>& aBuffer, const unsigned int aValue ) {
+    const char* bytes = reinterpret_cast<const char*>( &aValue );
+    aBuffer.insert( aBuffer.end(), bytes, bytes + sizeof( aValue ) );
+}
+
+/*!
+ * \brief Append an unsigned 64 bit integer in native byte order.
+ * \param aBuffer The buffer to append to.
+ * \param aValue The value to append.
+ */
+void CompiledScenario::writeUInt64( vector<char>& aBuffer, const unsigned long long aValue ) {
+    const char* bytes = reinterpret_cast<const char*>( &aValue );
+    aBuffer.insert( aBuffer.end(), bytes, bytes + sizeof( aValue ) );
+}
+
+/*!
+ * \brief Pad the buffer with zeros so that its size is a multiple of four
+ *        which keeps all integers and XML strings aligned in the mapped file.
+ * \param aBuffer The buffer to pad.
+ */
+void CompiledScenario::writePadding( vector<char>& aBuffer ) {
+    aBuffer.resize( ( aBuffer.size() + 3 ) & ~static_cast<size_t>( 3 ), '\0' );
+}
+
+/*!
+ * \brief Append a string as its length followed by its characters.
+ * \param aBuffer The buffer to append to.
+ * \param aValue The string to append.
+ */
+void CompiledScenario::writeString( vector<char>& aBuffer, const string& aValue ) {
+    writeUInt32( aBuffer, static_cast<unsigned int>( aValue.size() ) );
+    aBuffer.insert( aBuffer.end(), aValue.begin(), aValue.end() );
+    writePadding( aBuffer );
+}
+
+/*!
+ * \brief Append an XML string as its length followed by its characters
+ *        including the null terminator so that it may be used directly from
+ *        the mapped file.
+ * \param aBuffer The buffer to append to.
+ * \param aValue The XML string to append which may be null.
+ */
+void CompiledScenario::writeXMLString( vector<char>& aBuffer, const XMLCh* aValue ) {
+    const XMLSize_t length = aValue ? XMLString::stringLen( aValue ) : 0;
+    writeUInt32( aBuffer, static_cast<unsigned int>( length ) );
+    const XMLCh terminator = 0;
+    const char* bytes = aValue ? reinterpret_cast<const char*>( aValue ) : reinterpret_cast<const char*>( &terminator );
+    aBuffer.insert( aBuffer.end(), bytes, bytes + ( length + 1 ) * sizeof( XMLCh ) );
+    writePadding( aBuffer );
+}
+
+/*!
+ * \brief Append a DOM node and all of its children.
+ * \details Elements are written as their name, attributes, and children.  Text
+ *          and CDATA are both written as text.  Any other nodes, such as
+ *          processing instructions, are skipped as they are ignored by XMLParse.
+ * \param aBuffer The buffer to append to.
+ * \param aNode The node to append.
+ */
+void CompiledScenario::writeNode( vector<char>& aBuffer, const DOMNode* aNode ) {
+    if( aNode->getNodeType() == DOMNode::ELEMENT_NODE ) {
+        writeUInt32( aBuffer, DOMNode::ELEMENT_NODE );
+        writeXMLString( aBuffer, aNode->getNodeName() );
+        const DOMNamedNodeMap* attrs = aNode->getAttributes();
+        writeUInt32( aBuffer, static_cast<unsigned int>( attrs->getLength() ) );
+        for( XMLSize_t i = 0; i < attrs->getLength(); ++i ) {
+            writeXMLString( aBuffer, attrs->item( i )->getNodeName() );
+            writeXMLString( aBuffer, attrs->item( i )->getNodeValue() );
+        }
+
+        // Count the children which will actually be written first.
+        const DOMNodeList* children = aNode->getChildNodes();
+        unsigned int numChildren = 0;
+        for( XMLSize_t i = 0; i < children->getLength(); ++i ) {
+            const short type = children->item( i )->getNodeType();
+            numChildren += type == DOMNode::ELEMENT_NODE || type == DOMNode::TEXT_NODE
+                || type == DOMNode::CDATA_SECTION_NODE ? 1 : 0;
+        }
+        writeUInt32( aBuffer, numChildren );
+        for( XMLSize_t i = 0; i < children->getLength(); ++i ) {
+            writeNode( aBuffer, children->item( i ) );
+        }
+    }
+    else if( aNode->getNodeType() == DOMNode::TEXT_NODE || aNode->getNodeType() == DOMNode::CDATA_SECTION_NODE ) {
+        writeUInt32( aBuffer, DOMNode::TEXT_NODE );
+        writeXMLString( aBuffer, aNode->getNodeValue() );
+    }
+}
+
+/*!
+ * \brief Rebuild a DOM node and all of its children from the mapped file.
+ * \param aCursor The current position in the mapped file.
+ * \param aDocument The document which will own the new nodes.
+ * \return The new node or null if the file is corrupt.
+ */
+DOMNode* CompiledScenario::readNode( Cursor& aCursor, DOMDocument* aDocument ) {
+    unsigned int type;
+    const XMLCh* value = 0;
+    if( !aCursor.readUInt32( type ) || !aCursor.readXMLString( value ) ) {
+        return 0;
+    }
+    if( type == DOMNode::TEXT_NODE ) {
+        return aDocument->createTextNode( value );
+    }
+    else if( type != DOMNode::ELEMENT_NODE ) {
+        return 0;
+    }
+
+    DOMElement* element = aDocument->createElement( value );
+    unsigned int numAttrs;
+    if( !aCursor.readUInt32( numAttrs ) ) {
+        return 0;
+    }
+    for( unsigned int i = 0; i < numAttrs; ++i ) {
+        const XMLCh* attrName = 0;
+        const XMLCh* attrValue = 0;
+        if( !aCursor.readXMLString( attrName ) || !aCursor.readXMLString( attrValue ) ) {
+            return 0;
+        }
+        element->setAttribute( attrName, attrValue );
+    }
+    unsigned int numChildren;
+    if( !aCursor.readUInt32( numChildren ) ) {
+        return 0;
+    }
+    for( unsigned int i = 0; i < numChildren; ++i ) {
+        DOMNode* child = readNode( aCursor, aDocument );
+        if( !child ) {
+            return 0;
+        }
+        element->appendChild( child );
+    }
+    return element;
+}
+
+/*!
+ * \brief Read an unsigned 32 bit integer.
+ * \param aValue The value read.
+ * \return Whether there was enough data left in the file.
+ */
+bool CompiledScenario::Cursor::readUInt32( unsigned int& aValue ) {
+    if( mPos + sizeof( aValue ) > mSize ) {
+        return false;
+    }
+    memcpy( &aValue, mBegin + mPos, sizeof( aValue ) );
+    mPos += sizeof( aValue );
+    return true;
+}
+
+/*!
+ * \brief Read an XML string written by writeXMLString.
+ * \details No copy is made, the string points directly into the mapped file.
+ * \param aValue The XML string read.
+ * \return Whether there was enough data left in the file.
+ */
+bool CompiledScenario::Cursor::readXMLString( const XMLCh*& aValue ) {
+    unsigned int length;
+    if( !readUInt32( length ) ) {
+        return false;
+    }
+    const size_t numBytes = ( static_cast<size_t>( length ) + 1 ) * sizeof( XMLCh );
+    if( mPos + numBytes > mSize ) {
+        return false;
+    }
+    aValue = reinterpret_cast<const XMLCh*>( mBegin + mPos );
+    mPos = ( mPos + numBytes + 3 ) & ~static_cast<size_t>( 3 );
+    return aValue[ length ] == 0;
+}
+
+/*!
+ * \brief Constructor.
+ * \param aParent The compiled scenario to record the DOM tree into.
+ * \param aModelElement The model element which will parse the DOM tree.
+ */
+CompiledScenario::Recorder::Recorder( CompiledScenario* aParent, IParsable* aModelElement ):
+mParent( aParent ),
+mModelElement( aModelElement )
+{
+}
+
+/*!
+ * \brief Record the DOM tree and then pass it to the model element to parse.
+ * \param aNode The root node of the document.
+ * \return Whether the parse completed successfully.
+ */
+bool CompiledScenario::Recorder::XMLParse( const DOMNode* aNode ) {
+    writeXMLString( mParent->mBuffer, aNode->getOwnerDocument()->getDocumentURI() );
+    writeNode( mParent->mBuffer, aNode );
+    return mModelElement->XMLParse( aNode );
+}
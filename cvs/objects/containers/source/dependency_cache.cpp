@@ -0,0 +1,318 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+ * \file dependency_cache.cpp
+ * \ingroup Objects
+ * \brief DependencyCache class source file.
+ * \author Pralit Patel
+ */
+
+#include "util/base/include/definitions.h"
+#include <cstdio>
+#include <fstream>
+#include "containers/include/dependency_cache.h"
+#include "util/base/include/util.h"
+#include "util/logger/include/ilogger.h"
+
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+    //! Identifies the file as a dependency cache.
+    const string DEPENDENCY_CACHE_MAGIC = "gcam-dependency-cache";
+
+    //! The version of the dependency cache format which must be incremented
+    //! whenever the layout of the file changes.
+    const int DEPENDENCY_CACHE_FORMAT_VERSION = 1;
+
+    //! The FNV-1a 64 bit offset basis.
+    const unsigned long long FNV_OFFSET_BASIS = 14695981039346656037ULL;
+
+    //! The FNV-1a 64 bit prime.
+    const unsigned long long FNV_PRIME = 1099511628211ULL;
+}
+
+/*!
+ * \brief Constructor.
+ * \param aFileName The name of the cache file.
+ */
+DependencyCache::DependencyCache( const string& aFileName ):
+mFileName( aFileName ),
+mDigest( FNV_OFFSET_BASIS ),
+mIsModified( false )
+{
+    addToDigest( DEPENDENCY_CACHE_FORMAT_VERSION );
+}
+
+/*!
+ * \brief Add a string which the cached results depend on to the digest.
+ * \details The length is included so that consecutive strings can not be
+ *          confused with one another.
+ * \param aValue The value to add.
+ */
+void DependencyCache::addToDigest( const string& aValue ) {
+    addToDigest( static_cast<int>( aValue.size() ) );
+    addBytesToDigest( aValue.data(), aValue.size() );
+}
+
+/*!
+ * \brief Add an integer which the cached results depend on to the digest.
+ * \param aValue The value to add.
+ */
+void DependencyCache::addToDigest( const int aValue ) {
+    // Always hash in the same byte order so the digest does not depend on the
+    // platform.
+    char bytes[ 4 ];
+    for( int i = 0; i < 4; ++i ) {
+        bytes[ i ] = static_cast<char>( ( static_cast<unsigned int>( aValue ) >> ( 8 * i ) ) & 0xFF );
+    }
+    addBytesToDigest( bytes, sizeof( bytes ) );
+}
+
+/*!
+ * \brief Update the FNV-1a hash with the given bytes.
+ * \param aBytes The bytes to add.
+ * \param aSize The number of bytes.
+ */
+void DependencyCache::addBytesToDigest( const char* aBytes, const size_t aSize ) {
+    for( size_t i = 0; i < aSize; ++i ) {
+        mDigest ^= static_cast<unsigned char>( aBytes[ i ] );
+        mDigest *= FNV_PRIME;
+    }
+}
+
+/*!
+ * \brief Read the cache file if it was written for the same digest.
+ * \details This must be called once the digest is complete.  A missing, out of
+ *          date, or malformed file is not an error; the cache will just start
+ *          out empty.
+ * \return Whether the cached results were loaded.
+ */
+bool DependencyCache::load() {
+    mOrderings.clear();
+    mGrains.clear();
+    mIsModified = false;
+
+    ifstream inFile( mFileName.c_str() );
+    if( !inFile.is_open() ) {
+        return false;
+    }
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    string magic;
+    int version = -1;
+    unsigned long long digest = 0;
+    inFile >> magic >> version >> hex >> digest >> dec;
+    if( !inFile || magic != DEPENDENCY_CACHE_MAGIC || version != DEPENDENCY_CACHE_FORMAT_VERSION
+        || digest != mDigest )
+    {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Dependency cache " << mFileName << " is out of date and will be recomputed." << endl;
+        return false;
+    }
+
+    string entryType;
+    bool success = true;
+    while( success && inFile >> entryType ) {
+        int marketNumber;
+        size_t size;
+        inFile >> marketNumber >> size;
+        if( entryType == "ordering" ) {
+            vector<int>& ordering = mOrderings[ marketNumber ];
+            ordering.resize( size );
+            for( size_t i = 0; i < size; ++i ) {
+                inFile >> ordering[ i ];
+            }
+        }
+        else if( entryType == "grains" ) {
+            pair<GrainList, GrainSuccessorList>& grains = mGrains[ marketNumber ];
+            grains.first.resize( size );
+            grains.second.resize( size );
+            for( size_t i = 0; i < size && inFile; ++i ) {
+                size_t numNodes;
+                inFile >> numNodes;
+                grains.first[ i ].resize( numNodes );
+                for( size_t j = 0; j < numNodes; ++j ) {
+                    inFile >> grains.first[ i ][ j ];
+                }
+                size_t numSuccessors;
+                inFile >> numSuccessors;
+                grains.second[ i ].resize( numSuccessors );
+                for( size_t j = 0; j < numSuccessors; ++j ) {
+                    inFile >> grains.second[ i ][ j ];
+                    // Successors must come later in topological order.
+                    success = success && grains.second[ i ][ j ] > i && grains.second[ i ][ j ] < size;
+                }
+            }
+        }
+        else {
+            success = false;
+        }
+        success = success && !inFile.fail();
+    }
+
+    if( !success ) {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Dependency cache " << mFileName << " is malformed and will be recomputed." << endl;
+        mOrderings.clear();
+        mGrains.clear();
+        return false;
+    }
+
+    mainLog.setLevel( ILogger::DEBUG );
+    mainLog << "Loaded dependency cache " << mFileName << " with " << mOrderings.size()
+            << " orderings and " << mGrains.size() << " flow graphs." << endl;
+    return true;
+}
+
+/*!
+ * \brief Write the cache file if any results were added since it was loaded.
+ * \details The file is first written under a temporary name and then renamed
+ *          so that concurrently running scenarios never see a partially written
+ *          file.  Failing to write the file is not an error since the results
+ *          can always be recomputed.
+ */
+void DependencyCache::save() {
+    if( !mIsModified ) {
+        return;
+    }
+
+    const string tempFileName = mFileName + "." + util::toString( static_cast<int>( getpid() ) ) + ".tmp";
+    ofstream outFile( tempFileName.c_str() );
+    outFile << DEPENDENCY_CACHE_MAGIC << ' ' << DEPENDENCY_CACHE_FORMAT_VERSION << ' '
+            << hex << mDigest << dec << '\n';
+    for( map<int, vector<int> >::const_iterator it = mOrderings.begin(); it != mOrderings.end(); ++it ) {
+        outFile << "ordering " << it->first << ' ' << it->second.size();
+        for( vector<int>::const_iterator uidIt = it->second.begin(); uidIt != it->second.end(); ++uidIt ) {
+            outFile << ' ' << *uidIt;
+        }
+        outFile << '\n';
+    }
+    for( map<int, pair<GrainList, GrainSuccessorList> >::const_iterator it = mGrains.begin();
+         it != mGrains.end(); ++it )
+    {
+        const GrainList& grains = it->second.first;
+        const GrainSuccessorList& successors = it->second.second;
+        outFile << "grains " << it->first << ' ' << grains.size() << '\n';
+        for( size_t i = 0; i < grains.size(); ++i ) {
+            outFile << grains[ i ].size();
+            for( vector<int>::const_iterator uidIt = grains[ i ].begin(); uidIt != grains[ i ].end(); ++uidIt ) {
+                outFile << ' ' << *uidIt;
+            }
+            outFile << ' ' << successors[ i ].size();
+            for( vector<size_t>::const_iterator succIt = successors[ i ].begin(); succIt != successors[ i ].end(); ++succIt ) {
+                outFile << ' ' << *succIt;
+            }
+            outFile << '\n';
+        }
+    }
+    outFile.close();
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    remove( mFileName.c_str() );
+    if( !outFile.good() || rename( tempFileName.c_str(), mFileName.c_str() ) != 0 ) {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Could not write the dependency cache " << mFileName << "." << endl;
+        remove( tempFileName.c_str() );
+    }
+    else {
+        mainLog.setLevel( ILogger::DEBUG );
+        mainLog << "Wrote dependency cache " << mFileName << "." << endl;
+        mIsModified = false;
+    }
+}
+
+/*!
+ * \brief Get the cached ordering of activities to calculate for a market.
+ * \param aMarketNumber The market number.
+ * \param aOrdering The calc vertex ids in the order they must be calculated
+ *                  which is only set if found.
+ * \return Whether the ordering was cached.
+ */
+bool DependencyCache::getOrdering( const int aMarketNumber, vector<int>& aOrdering ) const {
+    map<int, vector<int> >::const_iterator it = mOrderings.find( aMarketNumber );
+    if( it == mOrderings.end() ) {
+        return false;
+    }
+    aOrdering = it->second;
+    return true;
+}
+
+/*!
+ * \brief Add the ordering of activities to calculate for a market to the cache.
+ * \param aMarketNumber The market number.
+ * \param aOrdering The calc vertex ids in the order they must be calculated.
+ */
+void DependencyCache::setOrdering( const int aMarketNumber, const vector<int>& aOrdering ) {
+    mOrderings[ aMarketNumber ] = aOrdering;
+    mIsModified = true;
+}
+
+/*!
+ * \brief Get the cached grains of the flow graph for a market.
+ * \param aMarketNumber The market number or -1 for the global flow graph.
+ * \param aGrains The calc vertex ids of each grain which is only set if found.
+ * \param aGrainSuccessors The successors of each grain which is only set if found.
+ * \return Whether the grains were cached.
+ */
+bool DependencyCache::getGrains( const int aMarketNumber, GrainList& aGrains,
+                                 GrainSuccessorList& aGrainSuccessors ) const
+{
+    map<int, pair<GrainList, GrainSuccessorList> >::const_iterator it = mGrains.find( aMarketNumber );
+    if( it == mGrains.end() ) {
+        return false;
+    }
+    aGrains = it->second.first;
+    aGrainSuccessors = it->second.second;
+    return true;
+}
+
+/*!
+ * \brief Add the grains of the flow graph for a market to the cache.
+ * \param aMarketNumber The market number or -1 for the global flow graph.
+ * \param aGrains The calc vertex ids of each grain in topological order.
+ * \param aGrainSuccessors The successors of each grain.
+ */
+void DependencyCache::setGrains( const int aMarketNumber, const GrainList& aGrains,
+                                 const GrainSuccessorList& aGrainSuccessors )
+{
+    mGrains[ aMarketNumber ] = make_pair( aGrains, aGrainSuccessors );
+    mIsModified = true;
+}
@@ -232,6 +232,23 @@ bool Info::hasValue( const string& aStringKey ) const {
     return currHasValue;
 }
 
+const double* Info::resolveDouble( const string& aStringKey, const bool aMustExist ) const {
+    // Perform a local search.
+    const double* value = getItemLocationLocal<double>( aStringKey );
+
+    // If the item wasn't found search the parent info.
+    if( !value ){
+        if( mParentInfo ){
+            value = mParentInfo->resolveDouble( aStringKey, false );
+        }
+        // The item must exist and was not found or there was no parent to search.
+        if( aMustExist && !value ){
+            printItemNotFoundWarning( aStringKey );
+        }
+    }
+    return value;
+}
+
 void Info::toDebugXML( const int aperiod, Tabs* aTabs, ostream& aOut ) const {
 #if GCAM_PARALLEL_ENABLED
     // get read lock for the info map
@@ -42,6 +42,8 @@
 #include <cassert>
 #include <boost/algorithm/string/predicate.hpp>
 #include "containers/include/market_dependency_finder.h"
+#include "containers/include/dependency_cache.h"
+#include "util/base/include/configuration.h"
 #include "util/logger/include/ilogger.h"
 #include "marketplace/include/marketplace.h"
 #include "marketplace/include/market_container.h"
@@ -74,6 +76,10 @@ mMarketplace( aMarketplace ), mCalcVertexUIDCount( 0 )
  *          including the IActivity objects passed in.
  */
 MarketDependencyFinder::~MarketDependencyFinder() {
+    // Save any orderings or flow graphs which were computed during this run.
+    if( mCache.get() ) {
+        mCache->save();
+    }
     for( ItemIterator it = mDependencyItems.begin(); it != mDependencyItems.end(); ++it ) {
         delete *it;
     }
@@ -224,6 +230,14 @@ const vector<IActivity*> MarketDependencyFinder::getOrdering( const int aMarketN
         if( !(*mrktIter)->mCalcList.empty() ) {
             return (*mrktIter)->mCalcList;
         }
+        
+        // Next check if it was saved by a previous run.
+        vector<int> cachedOrdering;
+        if( mCache.get() && mCache->getOrdering( aMarketNumber, cachedOrdering ) &&
+            convertFromUIDs( cachedOrdering, (*mrktIter)->mCalcList ) )
+        {
+            return (*mrktIter)->mCalcList;
+        }
 
         // We must generate the full list of nodes to calculate.  The createOrdering
         // method has created a link from markets to "entry points" into the graph.
@@ -253,6 +267,9 @@ const vector<IActivity*> MarketDependencyFinder::getOrdering( const int aMarketN
         }
         // Go ahead and cache this list so we do not need to calculate it again.
         (*mrktIter)->mCalcList = orderedListForMarket;
+        if( mCache.get() ) {
+            mCache->setOrdering( aMarketNumber, convertToUIDs( orderedListForMarket ) );
+        }
         return orderedListForMarket;
     }
 }
@@ -276,22 +293,26 @@ GcamFlowGraph* MarketDependencyFinder::getFlowGraph( const int aMarketNumber ) {
         if( !mTBBGraphGlobal ) {
             // reads parameters from the global configuration
             GcamParallel config;
-            GcamParallel::FlowGraph gcamFlowGraph;
-            GcamParallel::FlowGraph grainGraph;
-
-            // convert dependency table to flow graph 
-            config.makeGCAMFlowGraph( *this, gcamFlowGraph );
-            // parse flow graph
-            config.graphParseGrainCollect( gcamFlowGraph, grainGraph ); 
-            if( !gcamFlowGraph.topology_valid() ) {
-                ILogger& mainLog = ILogger::getLogger( "main_log" );
-                mainLog.setLevel( ILogger::ERROR );
-                mainLog << "Topological indices not computed." << endl;
-                abort();
-            }
-            // build the tbb graph structure
             mTBBGraphGlobal = new GcamFlowGraph();
-            config.makeTBBFlowGraph( grainGraph, gcamFlowGraph, *mTBBGraphGlobal ); 
+            if( !loadCachedFlowGraph( -1, config, *mTBBGraphGlobal ) ) {
+                GcamParallel::FlowGraph gcamFlowGraph;
+                GcamParallel::FlowGraph grainGraph;
+
+                // convert dependency table to flow graph 
+                config.makeGCAMFlowGraph( *this, gcamFlowGraph );
+                // parse flow graph
+                config.graphParseGrainCollect( gcamFlowGraph, grainGraph ); 
+                if( !gcamFlowGraph.topology_valid() ) {
+                    ILogger& mainLog = ILogger::getLogger( "main_log" );
+                    mainLog.setLevel( ILogger::ERROR );
+                    mainLog << "Topological indices not computed." << endl;
+                    abort();
+                }
+                // build the tbb graph structure
+                config.makeTBBFlowGraph( grainGraph, gcamFlowGraph, *mTBBGraphGlobal ); 
+                saveCachedFlowGraph( -1, *mTBBGraphGlobal );
+            }
+            config.startProfiling( *mTBBGraphGlobal );
         }
         return mTBBGraphGlobal;
     }
@@ -313,10 +334,16 @@ GcamFlowGraph* MarketDependencyFinder::getFlowGraph( const int aMarketNumber ) {
             return (*mrktIter)->mFlowGraph;
         }
 
+        // Next check if it was saved by a previous run.
+        GcamParallel config;
+        (*mrktIter)->mFlowGraph = new GcamFlowGraph();
+        if( loadCachedFlowGraph( aMarketNumber, config, *(*mrktIter)->mFlowGraph ) ) {
+            return (*mrktIter)->mFlowGraph;
+        }
+
         // We must generate the flow graph following the same procedure as the global graph.
         // It may be a good idea to make some of these tempararies members to avoid recalculating
         // them over and over.
-        GcamParallel config;
         GcamParallel::FlowGraph gcamFlowGraph;
         GcamParallel::FlowGraph grainGraph;
         
@@ -332,11 +359,77 @@ GcamFlowGraph* MarketDependencyFinder::getFlowGraph( const int aMarketNumber ) {
             abort();
         }
         // build the tbb graph structure
-        (*mrktIter)->mFlowGraph = new GcamFlowGraph();
         config.makeTBBFlowGraph( grainGraph, gcamFlowGraph, *(*mrktIter)->mFlowGraph );
+        saveCachedFlowGraph( aMarketNumber, *(*mrktIter)->mFlowGraph );
         return (*mrktIter)->mFlowGraph;
     }
 }
+
+/*!
+ * \brief Build a flow graph from the grains saved in the dependency cache.
+ * \param aMarketNumber The market number of the flow graph or -1 for the global
+ *                      flow graph.
+ * \param aParallel The parallel analysis configuration.
+ * \param aTBBGraph The default constructed flow graph to build.
+ * \return Whether the grains were found in the cache and the graph was built.
+ */
+bool MarketDependencyFinder::loadCachedFlowGraph( const int aMarketNumber, GcamParallel& aParallel,
+                                                  GcamFlowGraph& aTBBGraph ) const
+{
+    DependencyCache::GrainList cachedGrains;
+    DependencyCache::GrainSuccessorList grainSuccessors;
+    if( !mCache.get() || !mCache->getGrains( aMarketNumber, cachedGrains, grainSuccessors ) ) {
+        return false;
+    }
+    
+    GcamParallel::GrainList grains( cachedGrains.size() );
+    for( size_t i = 0; i < cachedGrains.size(); ++i ) {
+        if( !convertFromUIDs( cachedGrains[ i ], grains[ i ] ) ) {
+            return false;
+        }
+    }
+    aParallel.makeTBBFlowGraph( grains, grainSuccessors, aTBBGraph );
+    return true;
+}
+
+/*!
+ * \brief Add the grains of a newly built flow graph to the dependency cache.
+ * \param aMarketNumber The market number of the flow graph or -1 for the global
+ *                      flow graph.
+ * \param aTBBGraph The flow graph.
+ */
+void MarketDependencyFinder::saveCachedFlowGraph( const int aMarketNumber, const GcamFlowGraph& aTBBGraph ) {
+    if( !mCache.get() ) {
+        return;
+    }
+    
+    DependencyCache::GrainList grains( aTBBGraph.mGrains.size() );
+    for( size_t i = 0; i < aTBBGraph.mGrains.size(); ++i ) {
+        grains[ i ] = convertToUIDs( aTBBGraph.mGrains[ i ] );
+    }
+    mCache->setGrains( aMarketNumber, grains, aTBBGraph.mGrainSuccessors );
+}
+
+/*!
+ * \brief Rebuild the global flow graph collecting grains by the activity costs
+ *        measured while profiling the current one.
+ * \details The current global flow graph is deleted so this must not be called
+ *          while it is being calculated.  Note the new grains are not saved in
+ *          the dependency cache since the costs are particular to this run.
+ * \return The new global flow graph.
+ * \pre The global flow graph has finished profiling.
+ */
+GcamFlowGraph* MarketDependencyFinder::regrainFlowGraph() {
+    GcamParallel config;
+    GcamParallel::FlowGraph gcamFlowGraph;
+    
+    config.makeGCAMFlowGraph( *this, gcamFlowGraph );
+    GcamFlowGraph* newGraph = new GcamFlowGraph();
+    config.regrainFromProfile( gcamFlowGraph, *mTBBGraphGlobal, *newGraph );
+    delete mTBBGraphGlobal;
+    mTBBGraphGlobal = newGraph;
+    return mTBBGraphGlobal;
+}
 #endif
 
 /*!
@@ -715,6 +808,113 @@ void MarketDependencyFinder::createOrdering() {
     for( vector<IActivity*>::iterator it = mGlobalOrdering.begin(); it != mGlobalOrdering.end(); ++it ) {
         depLog << "- " << (*it)->getDescription() << endl;
     }
+    
+    // Now that the structure is final we can check for results saved by a previous run.
+    loadCache();
+}
+
+/*!
+ * \brief Load the dependency cache if one is configured.
+ * \details The cache digest covers everything which the market orderings and flow
+ *          graphs are computed from: the activities and edges of the final graph,
+ *          including any changes made to break cycles, the entry points for each
+ *          market, the global ordering, and the parallel analysis parameters.
+ * \pre createOrdering has completed.
+ */
+void MarketDependencyFinder::loadCache() {
+    Configuration* conf = Configuration::getInstance();
+    if( !conf->shouldWriteFile( "dependencyCacheFileName", false, false ) ) {
+        return;
+    }
+    mCache.reset( new DependencyCache( conf->getFile( "dependencyCacheFileName", "", false ) ) );
+    
+    mActivityByUID.assign( mCalcVertexUIDCount, 0 );
+    mUIDByActivity.clear();
+    for( CItemIterator it = mDependencyItems.begin(); it != mDependencyItems.end(); ++it ) {
+        for( int priceOrDemand = 0; priceOrDemand <= 1; ++priceOrDemand ) {
+            const VertexList& vertices = priceOrDemand ? (*it)->mDemandVertices : (*it)->mPriceVertices;
+            for( CVertexIterator vertexIter = vertices.begin(); vertexIter != vertices.end(); ++vertexIter ) {
+                mActivityByUID[ (*vertexIter)->mUID ] = (*vertexIter)->mCalcItem;
+                mUIDByActivity[ (*vertexIter)->mCalcItem ] = (*vertexIter)->mUID;
+            }
+        }
+    }
+    
+#if GCAM_PARALLEL_ENABLED
+    mCache->addToDigest( GcamParallel().getGrainSizeTarget() );
+#endif
+    for( CItemIterator it = mDependencyItems.begin(); it != mDependencyItems.end(); ++it ) {
+        mCache->addToDigest( (*it)->mName );
+        mCache->addToDigest( (*it)->mLocatedInRegion );
+        for( int priceOrDemand = 0; priceOrDemand <= 1; ++priceOrDemand ) {
+            const VertexList& vertices = priceOrDemand ? (*it)->mDemandVertices : (*it)->mPriceVertices;
+            mCache->addToDigest( static_cast<int>( vertices.size() ) );
+            for( CVertexIterator vertexIter = vertices.begin(); vertexIter != vertices.end(); ++vertexIter ) {
+                mCache->addToDigest( (*vertexIter)->mUID );
+                mCache->addToDigest( (*vertexIter)->mCalcItem->getDescription() );
+                mCache->addToDigest( static_cast<int>( (*vertexIter)->mOutEdges.size() ) );
+                for( CVertexIterator edgeIter = (*vertexIter)->mOutEdges.begin();
+                     edgeIter != (*vertexIter)->mOutEdges.end(); ++edgeIter )
+                {
+                    mCache->addToDigest( (*edgeIter)->mUID );
+                }
+                mCache->addToDigest( static_cast<int>( (*vertexIter)->mImpliedInEdges.size() ) );
+                for( set<CalcVertex*>::const_iterator edgeIter = (*vertexIter)->mImpliedInEdges.begin();
+                     edgeIter != (*vertexIter)->mImpliedInEdges.end(); ++edgeIter )
+                {
+                    mCache->addToDigest( (*edgeIter)->mUID );
+                }
+            }
+        }
+    }
+    for( CMarketToDepIterator it = mMarketsToDep.begin(); it != mMarketsToDep.end(); ++it ) {
+        mCache->addToDigest( (*it)->mMarket );
+        mCache->addToDigest( static_cast<int>( (*it)->mImpliedVertices.size() ) );
+        for( set<CalcVertex*>::const_iterator vertexIter = (*it)->mImpliedVertices.begin();
+             vertexIter != (*it)->mImpliedVertices.end(); ++vertexIter )
+        {
+            mCache->addToDigest( (*vertexIter)->mUID );
+        }
+    }
+    vector<int> globalOrdering = convertToUIDs( mGlobalOrdering );
+    mCache->addToDigest( static_cast<int>( globalOrdering.size() ) );
+    for( vector<int>::const_iterator it = globalOrdering.begin(); it != globalOrdering.end(); ++it ) {
+        mCache->addToDigest( *it );
+    }
+    
+    mCache->load();
+}
+
+/*!
+ * \brief Convert a list of CalcVertex UIDs from the dependency cache to activities.
+ * \param aUIDs The UIDs to convert.
+ * \param aActivities The corresponding activities which is only set if all UIDs
+ *                    are valid.
+ * \return Whether all of the UIDs were valid.
+ */
+bool MarketDependencyFinder::convertFromUIDs( const vector<int>& aUIDs, vector<IActivity*>& aActivities ) const {
+    vector<IActivity*> activities( aUIDs.size() );
+    for( size_t i = 0; i < aUIDs.size(); ++i ) {
+        if( aUIDs[ i ] < 0 || aUIDs[ i ] >= static_cast<int>( mActivityByUID.size() ) || !mActivityByUID[ aUIDs[ i ] ] ) {
+            return false;
+        }
+        activities[ i ] = mActivityByUID[ aUIDs[ i ] ];
+    }
+    aActivities.swap( activities );
+    return true;
+}
+
+/*!
+ * \brief Convert a list of activities to CalcVertex UIDs to save in the dependency cache.
+ * \param aActivities The activities to convert.
+ * \return The corresponding UIDs.
+ */
+vector<int> MarketDependencyFinder::convertToUIDs( const vector<IActivity*>& aActivities ) const {
+    vector<int> uids( aActivities.size() );
+    for( size_t i = 0; i < aActivities.size(); ++i ) {
+        uids[ i ] = mUIDByActivity.find( aActivities[ i ] )->second;
+    }
+    return uids;
 }
 
 /*!
@@ -263,6 +263,11 @@ void Scenario::completeInit() {
     // Set the valid period vector to false.
     mIsValidPeriod.clear();
     mIsValidPeriod.resize( mModeltime->getmaxper(), false );
+    
+    // Create the state manager which will be reused for each period.  The search
+    // for state data is deferred until the first period is calculated.
+    delete mManageStateVars;
+    mManageStateVars = new ManageStateVariables();
 }
 
 //! Return scenario name.
@@ -404,8 +409,7 @@ bool Scenario::calculatePeriod( const int aPeriod,
     }
     
     // Set up the state data for the current period.
-    delete mManageStateVars;
-    mManageStateVars = new ManageStateVariables( aPeriod );
+    mManageStateVars->collectState( aPeriod );
     
     // Be sure to clear out any supplies and demands in the marketplace before making our
     // initial call to world.calc.  There may already be values in there if for instance
@@ -501,8 +505,8 @@ bool Scenario::calculatePeriod( const int aPeriod,
         writeDebuggingFiles( aXMLDebugFile, aTabs, aPeriod );
     }
 
-    delete mManageStateVars;
-    mManageStateVars = 0;
+    // Copy the final state back into the model and release it for the next period.
+    mManageStateVars->resetState();
     
     return success;
 }
@@ -634,6 +638,12 @@ void Scenario::printLandAllocatorGraph( const int aPeriod, const bool aPrintValu
 */
 void Scenario::setTax( const GHGPolicy* aTax ){
     mWorld->setTax( aTax );
+    
+    // Setting a tax may create or replace objects which contain state so it will
+    // need to be searched for again.
+    if( mManageStateVars ) {
+        mManageStateVars->invalidateRegistry();
+    }
 }
 
 /*! \brief Get the climate model.
@@ -43,6 +43,7 @@
 #include <xercesc/dom/DOMNode.hpp>
 #include "containers/include/single_scenario_runner.h"
 #include "containers/include/scenario.h"
+#include "containers/include/compiled_scenario.h"
 #include "util/base/include/xml_helper.h"
 #include "util/base/include/configuration.h"
 #include "util/base/include/timer.h"
@@ -107,19 +108,33 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
     // TODO: Remove global scenario pointer.
     scenario = mScenario.get();
 
-    // Parse the input file.
-    bool success =
-        XMLHelper<void>::parseXML( conf->getFile( "xmlInputFileName" ),
-                                   mScenario.get() );
+    // The base input file and the scenario components from the configuration
+    // file make up the reference inputs which may be compiled.
+    list<string> referenceFiles = conf->getScenarioComponents();
+    referenceFiles.push_front( conf->getFile( "xmlInputFileName" ) );
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    const string compiledScenarioFile = conf->shouldWriteFile( "compiledScenarioFileName", false, false ) ?
+        conf->getFile( "compiledScenarioFileName", "", false ) : "";
+    list<string> scenComponents;
+    bool success = true;
+    if( !compiledScenarioFile.empty() ) {
+        // Load the reference inputs from the compiled scenario if it is up to
+        // date, otherwise parse them and compile them for the next run.
+        CompiledScenario compiledScenario( compiledScenarioFile, referenceFiles );
+        success = compiledScenario.isUpToDate() ? compiledScenario.load( mScenario.get() )
+                                                : compiledScenario.compile( mScenario.get() );
+    }
+    else {
+        // Parse the input file along with the scenario components.
+        scenComponents = referenceFiles;
+    }
     
     // Check if parsing succeeded.
     if( !success ){
         return false;
     }
 
-    // Fetch the listing of Scenario Components.
-    list<string> scenComponents = conf->getScenarioComponents();
-
     // Add on any scenario components that were passed in.
     for( list<string>::const_iterator curr = aScenComponents.begin();
 		curr != aScenComponents.end(); ++curr )
@@ -127,20 +142,13 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
         scenComponents.push_back( *curr );
     }
     
-    // Iterate over the vector.
-    typedef list<string>::const_iterator ScenCompIter;
-    ILogger& mainLog = ILogger::getLogger( "main_log" );
-    for( ScenCompIter currComp = scenComponents.begin();
-		 currComp != scenComponents.end(); ++currComp )
-	{
-        mainLog.setLevel( ILogger::NOTICE );
-        mainLog << "Parsing " << *currComp << " scenario component." << endl;
-        success = XMLHelper<void>::parseXML( *currComp, mScenario.get() );
-        
-        // Check if parsing succeeded.
-        if( !success ){
-            return false;
-        }
+    // Parse the files in order. The files may be read concurrently but are
+    // applied to the scenario in the order given.
+    success = XMLHelper<void>::parseXMLFiles( scenComponents, mScenario.get() );
+    
+    // Check if parsing succeeded.
+    if( !success ){
+        return false;
     }
     
     // Override scenario name from data file with that from configuration file
@@ -64,6 +64,14 @@
 
 #include <boost/algorithm/string/split.hpp>
 
+#include <fstream>
+#include <cstdio>
+#include <limits>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
 using namespace std;
 using namespace xercesc;
 
@@ -168,58 +176,41 @@ bool TotalPolicyCostCalculator::calculateAbatementCostCurve() {
 * on the trial number and the total number of points, so that the data points are equally
 * distributed from 0 to the full carbon tax for each period. It then calculates and 
 * sets the fixed tax for each year. The scenario is then run, and the emissions and 
-* tax curves are stored for each region.
+* tax curves are stored for each region.  Since each trial starts from the same
+* stored prices the trials are independent and may be run several at a time
+* as set by the concurrent-cost-curve-points configuration value.
 * \return Whether all model runs completed successfully.
 * \author Josh Lurz
 */
 bool TotalPolicyCostCalculator::runTrials(){
-    // Get the number of max periods.
-    const Modeltime* modeltime = mSingleScenario->getInternalScenario()->getModeltime();
-    const int maxPeriod = modeltime->getmaxper();
-
     bool success = true;
     const static bool usingRestartPeriod = Configuration::getInstance()->getInt(
         "restart-period", -1 ) != -1;
+
+    const int numConcurrent = Configuration::getInstance()->getInt( "concurrent-cost-curve-points", 1, false );
+    if( numConcurrent > 1 && mNumPoints > 1 ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+#if !defined(_WIN32) && !GCAM_PARALLEL_ENABLED
+        if( !usingRestartPeriod ) {
+            return runTrialsConcurrently( numConcurrent );
+        }
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Running cost curve points concurrently is not supported with a restart-period, running them serially." << endl;
+#else
+        // TBB worker threads created by the policy run do not survive a fork so
+        // the children could not safely calculate in parallel.
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Running cost curve points concurrently is not supported on this platform or build, running them serially." << endl;
+#endif
+    }
+
     // Store original solved market prices before looping.
     if( !usingRestartPeriod ) {
         mSingleScenario->getInternalScenario()->getMarketplace()->store_prices_for_cost_calculation();
     }
     // Loop through for each point.
     for( int currPoint = mNumPoints - 1; currPoint >= 0; currPoint-- ){
-        // Determine the fraction of the full tax this tax will be.
-        const double fraction = static_cast<double>( currPoint ) / static_cast<double>( mNumPoints );
-        // Iterate through the regions to set different taxes for each if necessary.
-        // Currently this will set the same for all of them.
-        for( CRegionCurvesIterator rIter = mEmissionsTCurves[ mNumPoints ].begin(); rIter != mEmissionsTCurves[ mNumPoints ].end(); ++rIter ){
-            // Vector which will contain taxes for this trial.
-            vector<double> currTaxes( maxPeriod );
-
-            // Set the tax for each year. 
-            for( int per = 0; per < maxPeriod; per++ ){
-                const int year = modeltime->getper_to_yr( per );
-                double origTax = rIter->second->getY( year );
-                currTaxes[ per ] = origTax == Marketplace::NO_MARKET_PRICE ? Marketplace::NO_MARKET_PRICE :
-                    origTax * fraction;
-            }
-            // Set the fixed taxes into the world.
-            GHGPolicy tax( mGHGName, rIter->first, currTaxes );
-            mSingleScenario->getInternalScenario()->setTax( &tax );
-        }
-
-        // Create an ending for the output files using the run number.
-        ILogger& mainLog = ILogger::getLogger( "main_log" );
-        mainLog.setLevel( ILogger::NOTICE );
-        mainLog << "Starting cost curve point run number " << currPoint << "." << endl;
-
-        // Run the scenario with the add-on extension to the output file names
-        // as the point number. This allows the output file to be named debug +
-        // point number.
-        success &= mSingleScenario->getInternalScenario()->run( Scenario::RUN_ALL_PERIODS, true,
-                                                                util::toString( currPoint ) );
-
-        // Save information.
-        mEmissionsQCurves[ currPoint ] = getEmissionsQuantityCurve();
-        mEmissionsTCurves[ currPoint ] = mSingleScenario->getInternalScenario()->getEmissionsPriceCurves( mGHGName );
+        success &= runTrial( currPoint, true );
 
         // Restore original solved market prices after each cost iteration to ensure same
         // starting prices for each iteration.  This is necessary due to changing initial prices.
@@ -230,6 +221,217 @@ bool TotalPolicyCostCalculator::runTrials(){
     return success;
 }
 
+/*! \brief Run the scenario for a single point and store the abatement curves.
+* \details Sets the fixed taxes for the point, runs the scenario, and stores the
+*          emissions and tax curves for each region.  The caller is responsible
+*          for restoring the original solved prices afterwards.
+* \param aPoint The point to run.
+* \param aPrintDebugging Whether to print extra debugging files.
+* \return Whether the model run completed successfully.
+*/
+bool TotalPolicyCostCalculator::runTrial( const int aPoint, const bool aPrintDebugging ){
+    setTrialTaxes( aPoint );
+
+    // Create an ending for the output files using the run number.
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Starting cost curve point run number " << aPoint << "." << endl;
+
+    // Run the scenario with the add-on extension to the output file names
+    // as the point number. This allows the output file to be named debug +
+    // point number.
+    const bool success = mSingleScenario->getInternalScenario()->run( Scenario::RUN_ALL_PERIODS, aPrintDebugging,
+                                                                      util::toString( aPoint ) );
+
+    // Save information.
+    mEmissionsQCurves[ aPoint ] = getEmissionsQuantityCurve();
+    mEmissionsTCurves[ aPoint ] = mSingleScenario->getInternalScenario()->getEmissionsPriceCurves( mGHGName );
+    return success;
+}
+
+/*! \brief Set the fixed taxes for a single point into the world.
+* \details The tax for each region and period is the fraction aPoint / mNumPoints
+*          of the tax found in the original policy scenario.
+* \param aPoint The point for which to set taxes.
+*/
+void TotalPolicyCostCalculator::setTrialTaxes( const int aPoint ){
+    const Modeltime* modeltime = mSingleScenario->getInternalScenario()->getModeltime();
+    const int maxPeriod = modeltime->getmaxper();
+
+    // Determine the fraction of the full tax this tax will be.
+    const double fraction = static_cast<double>( aPoint ) / static_cast<double>( mNumPoints );
+    // Iterate through the regions to set different taxes for each if necessary.
+    // Currently this will set the same for all of them.
+    for( CRegionCurvesIterator rIter = mEmissionsTCurves[ mNumPoints ].begin(); rIter != mEmissionsTCurves[ mNumPoints ].end(); ++rIter ){
+        // Vector which will contain taxes for this trial.
+        vector<double> currTaxes( maxPeriod );
+
+        // Set the tax for each year. 
+        for( int per = 0; per < maxPeriod; per++ ){
+            const int year = modeltime->getper_to_yr( per );
+            double origTax = rIter->second->getY( year );
+            currTaxes[ per ] = origTax == Marketplace::NO_MARKET_PRICE ? Marketplace::NO_MARKET_PRICE :
+                origTax * fraction;
+        }
+        // Set the fixed taxes into the world.
+        GHGPolicy tax( mGHGName, rIter->first, currTaxes );
+        mSingleScenario->getInternalScenario()->setTax( &tax );
+    }
+}
+
+#if !defined(_WIN32) && !GCAM_PARALLEL_ENABLED
+/*! \brief Run the trials several at a time.
+* \details Each point is run in a child process forked from this one so that it
+*          starts from the solved policy scenario and the stored prices without
+*          having to restore them.  At most aNumConcurrent children are running
+*          at any time.  Each child writes the emissions and tax curves for its
+*          point to a separate file and reports through its exit code whether
+*          the run solved.  Once all children are done the curves are read back
+*          by point so that the results do not depend on the order in which the
+*          points happen to finish.  Any point whose results could not be read
+*          is run again serially in this process.
+* \note Unlike the serial trials this process is left in the state of the
+*       original policy scenario rather than that of the last trial.
+* \param aNumConcurrent The maximum number of points to run at once.
+* \return Whether all model runs completed successfully.
+*/
+bool TotalPolicyCostCalculator::runTrialsConcurrently( const int aNumConcurrent ){
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Running " << mNumPoints << " cost curve points with up to "
+            << aNumConcurrent << " at a time." << endl;
+
+    // Include the process id so that concurrent batch scenarios do not collide.
+    const string fileNameBase = mSingleScenario->getInternalScenario()->getName() + ".cost-point."
+        + util::toString( static_cast<int>( getpid() ) ) + ".";
+
+    // Start the points from the highest as the serial trials do.
+    const vector<bool> didSolveJob = util::runInChildProcesses( mNumPoints, aNumConcurrent,
+        [&] ( const size_t aJobIndex ) {
+            // Run the point, write the curves, and report the results through
+            // the exit code.  The debugging file does not include the point so
+            // only the last point run serially writes it.
+            const int currPoint = mNumPoints - 1 - static_cast<int>( aJobIndex );
+            bool success = runTrial( currPoint, currPoint == 0 );
+            success &= writeTrialCurves( currPoint, fileNameBase + util::toString( currPoint ) );
+            return success;
+        },
+        [this] ( const size_t aJobIndex ) {
+            return "cost curve point " + util::toString( mNumPoints - 1 - static_cast<int>( aJobIndex ) );
+        } );
+    vector<bool> didSolve( mNumPoints, false );
+    for( int currPoint = 0; currPoint < mNumPoints; ++currPoint ){
+        didSolve[ currPoint ] = didSolveJob[ mNumPoints - 1 - currPoint ];
+    }
+
+    // Collect the curves in point order.
+    bool success = true;
+    vector<int> failedPoints;
+    for( int currPoint = mNumPoints - 1; currPoint >= 0; currPoint-- ){
+        const string fileName = fileNameBase + util::toString( currPoint );
+        if( readTrialCurves( currPoint, fileName ) ){
+            success &= didSolve[ currPoint ];
+        }
+        else {
+            failedPoints.push_back( currPoint );
+        }
+        remove( fileName.c_str() );
+    }
+
+    // Run any points which did not produce results in this process.
+    if( !failedPoints.empty() ){
+        Marketplace* marketplace = mSingleScenario->getInternalScenario()->getMarketplace();
+        marketplace->store_prices_for_cost_calculation();
+        for( vector<int>::const_iterator currPoint = failedPoints.begin(); currPoint != failedPoints.end(); ++currPoint ){
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Could not read the results of cost curve point " << *currPoint << ", running it again." << endl;
+            success &= runTrial( *currPoint, true );
+            marketplace->restore_prices_for_cost_calculation();
+        }
+    }
+    return success;
+}
+
+/*! \brief Write the emissions and tax curves of a point to a file.
+* \details Only the value in each model period is written since those are the
+*          only values used from the curves.  Each set of curves is written as
+*          the number of regions followed by the region name and the values on
+*          separate lines.
+* \param aPoint The point which has been run.
+* \param aFileName The name of the file to write.
+* \return Whether the file was written successfully.
+*/
+bool TotalPolicyCostCalculator::writeTrialCurves( const int aPoint, const string& aFileName ) const {
+    const Modeltime* modeltime = mSingleScenario->getInternalScenario()->getModeltime();
+    ofstream outFile( aFileName.c_str() );
+    outFile.precision( numeric_limits<double>::max_digits10 );
+    const RegionCurves* trialCurves[] = { &mEmissionsQCurves[ aPoint ], &mEmissionsTCurves[ aPoint ] };
+    for( unsigned int i = 0; i < sizeof( trialCurves ) / sizeof( trialCurves[ 0 ] ); ++i ){
+        outFile << trialCurves[ i ]->size() << endl;
+        for( CRegionCurvesIterator rIter = trialCurves[ i ]->begin(); rIter != trialCurves[ i ]->end(); ++rIter ){
+            outFile << rIter->first << endl;
+            for( int per = 0; per < modeltime->getmaxper(); ++per ){
+                outFile << rIter->second->getY( modeltime->getper_to_yr( per ) ) << ' ';
+            }
+            outFile << endl;
+        }
+    }
+    outFile.close();
+    return outFile.good();
+}
+
+/*! \brief Read the emissions and tax curves of a point written by writeTrialCurves.
+* \details The curves are recreated with the same titles and labels as those
+*          generated by the regions.
+* \param aPoint The point to read.
+* \param aFileName The name of the file to read.
+* \return Whether the curves were read successfully.  The stored curves for the
+*         point are only set if all of them could be read.
+*/
+bool TotalPolicyCostCalculator::readTrialCurves( const int aPoint, const string& aFileName ){
+    const Modeltime* modeltime = mSingleScenario->getInternalScenario()->getModeltime();
+    ifstream inFile( aFileName.c_str() );
+    const string titles[] = { mGHGQuantityNames.front() + " emissions curve", mGHGName + " emissions tax curve" };
+    const string yLabels[] = { "emissions quantity", "emissions tax" };
+    RegionCurves trialCurves[ 2 ];
+    bool success = inFile.is_open();
+    for( unsigned int i = 0; i < 2 && success; ++i ){
+        size_t numRegions = 0;
+        inFile >> numRegions >> ws;
+        for( size_t region = 0; region < numRegions && inFile; ++region ){
+            string regionName;
+            getline( inFile, regionName );
+            ExplicitPointSet* points = new ExplicitPointSet();
+            for( int per = 0; per < modeltime->getmaxper(); ++per ){
+                double value = 0;
+                inFile >> value;
+                points->addPoint( new XYDataPoint( modeltime->getper_to_yr( per ), value ) );
+            }
+            inFile >> ws;
+            Curve* curve = new PointSetCurve( points );
+            curve->setTitle( titles[ i ] );
+            curve->setXAxisLabel( "year" );
+            curve->setYAxisLabel( yLabels[ i ] );
+            trialCurves[ i ][ regionName ] = curve;
+        }
+        success = !inFile.fail();
+    }
+
+    if( success ){
+        mEmissionsQCurves[ aPoint ] = trialCurves[ 0 ];
+        mEmissionsTCurves[ aPoint ] = trialCurves[ 1 ];
+    }
+    else {
+        for( unsigned int i = 0; i < 2; ++i ){
+            for( RegionCurvesIterator rIter = trialCurves[ i ].begin(); rIter != trialCurves[ i ].end(); ++rIter ){
+                delete rIter->second;
+            }
+        }
+    }
+    return success;
+}
+#endif
+
 /*! \brief Create a cost curve for each period and region.
 * \details Using the cost curves generated by the trials, generate and stored a set of cost
 * curves by period and region.
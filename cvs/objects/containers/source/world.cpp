@@ -81,6 +81,9 @@
 
 #if GCAM_PARALLEL_ENABLED
 #include "parallel/include/gcam_parallel.hpp"
+#include "util/base/include/manage_state_variables.hpp"
+#include <tbb/task_arena.h>
+#include <tbb/tick_count.h>
 #endif
 
 // Uncommenting the following two lines will turn on floating-point exceptions within World::calc(),
@@ -342,7 +345,13 @@ void World::calc( const int aPeriod, const std::vector<IActivity*>& aItemsToCalc
  * \param aCalcList This can be used when only a partial model calculation is needed
  *                  and a flow graph has not been created for it.  In that case the
  *                  full model flow graph will be used while skipping calculations
- *                  not contained in aCalcList.
+ *                  not contained in aCalcList.  When a flow graph is given this is
+ *                  only used to count the fraction of the model calculated.
+ * \note The graph is calculated in the state of the calling thread, which may
+ *       be a "scratch" state when calculating a partial derivative, regardless
+ *       of which threads end up doing the work.  The calling thread only works
+ *       on this graph while waiting for it so that it does not start some other
+ *       partial derivative in the middle of this one.
  */
 void World::calc( const int aPeriod, GcamFlowGraph *aWorkGraph, const vector<IActivity*>* aCalcList )
 {
@@ -366,9 +375,21 @@ void World::calc( const int aPeriod, GcamFlowGraph *aWorkGraph, const vector<IAc
         aWorkGraph->mCalcList = 0;
     }
     aWorkGraph->mPeriod = aPeriod;
+    aWorkGraph->mState = ManageStateVariables::getThreadState();
+    // Only full calculations are profiled.
+    const bool isProfiling = aWorkGraph->mNumProfileCalls > 0 && !aWorkGraph->mCalcList;
+    tbb::tick_count startTime = tbb::tick_count::now();
     // do the model calculation
-    aWorkGraph->mHead.try_put( tbb::flow::continue_msg() );
-    aWorkGraph->mTBBFlowGraph.wait_for_all();
+    tbb::this_task_arena::isolate( [aWorkGraph]() {
+        aWorkGraph->mHead.try_put( tbb::flow::continue_msg() );
+        aWorkGraph->mTBBFlowGraph.wait_for_all();
+    } );
+    if( isProfiling &&
+        GcamParallel::finishProfiledCalc( *aWorkGraph, ( tbb::tick_count::now() - startTime ).seconds() ) )
+    {
+        // Now that we know what each activity costs collect the grains again.
+        mTBBGraphGlobal = scenario->getMarketplace()->getDependencyFinder()->regrainFlowGraph();
+    }
 
 #ifdef GNU_SOURCE
     feenableexcept(except);
@@ -50,6 +50,7 @@
 #include "util/base/include/time_vector.h"
 
 class PointSetCurve;
+class CachedMarket;
 
 /*! 
  * \ingroup Objects
@@ -112,6 +113,10 @@ protected:
     // DEFINE_VARIABLE( ARRAY, "tech-change", mTechChange, std::shared_ptr<objects::PeriodVector<double> > ),
     std::shared_ptr<objects::PeriodVector<double> > mTechChange;
 
+    //! A pre-located market which has been cached from the marketplace to get
+    //! the emissions price from.
+    std::auto_ptr<CachedMarket> mCachedMarket;
+
 private:
     void copy( const MACControl& other );
     double getMACValue( const double aCarbonPrice ) const;
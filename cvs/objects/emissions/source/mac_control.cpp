@@ -50,6 +50,7 @@
 #include "util/logger/include/ilogger.h"
 #include "containers/include/scenario.h"
 #include "marketplace/include/marketplace.h"
+#include "marketplace/include/cached_market.h"
 #include "containers/include/iinfo.h"
 #include "containers/include/market_dependency_finder.h"
 #include "util/curves/include/point_set_curve.h"
@@ -199,6 +200,7 @@ void MACControl::initCalc( const string& aRegionName,
                            const NonCO2Emissions* aParentGHG,
                            const int aPeriod )
 {
+    mCachedMarket = scenario->getMarketplace()->locateMarket( mPriceMarketName, aRegionName, aPeriod );
 }
 
 void MACControl::calcEmissionsReduction( const std::string& aRegionName, const int aPeriod, const GDP* aGDP ) {
@@ -208,8 +210,7 @@ void MACControl::calcEmissionsReduction( const std::string& aRegionName, const i
         return;
     }
     
-    const Marketplace* marketplace = scenario->getMarketplace();
-    double emissionsPrice = marketplace->getPrice( mPriceMarketName, aRegionName, aPeriod, false );
+    double emissionsPrice = mCachedMarket->getPrice( mPriceMarketName, aRegionName, aPeriod, false );
     if( emissionsPrice == Marketplace::NO_MARKET_PRICE ) {
         emissionsPrice = 0;
     }
@@ -50,6 +50,7 @@
 #include <memory>
 
 class Tabs;
+class CachedMarket;
 
 /*! 
  * \ingroup Objects
@@ -160,6 +161,14 @@ protected:
         //! The C coef associated with mFuelName
         DEFINE_VARIABLE( SIMPLE, "fuel-C-coef", mCachedCCoef, double )
     )
+    
+    //! A pre-located market which has been cached from the marketplace to get
+    //! the tax fraction from.
+    std::auto_ptr<CachedMarket> mCachedMarket;
+    
+    //! A pre-located CO2 market which has been cached from the marketplace to
+    //! get the carbon tax from.
+    std::auto_ptr<CachedMarket> mCachedCO2Market;
 };
 
 #endif // _CTAX_INPUT_H_
@@ -53,6 +53,7 @@
 #include "util/base/include/time_vector.h"
 
 class Tabs;
+class CachedMarket;
 
 /*! 
  * \ingroup Objects
@@ -171,6 +172,10 @@ protected:
 
     //! Stash the current sector name for use in setPhysicalDemand
     std::string mSectorName;
+    
+    //! A pre-located market which has been cached from the marketplace to get
+    //! the price and add demands to.
+    std::auto_ptr<CachedMarket> mCachedMarket;
 private:
     const static std::string XML_REPORTING_NAME; //!< tag name for reporting xml db 
 };
@@ -84,6 +84,12 @@ protected:
         LandLeaf
     )
     
+    //! A pre-located CO2 market which has been cached from the marketplace to
+    //! get the carbon price from.
+    std::auto_ptr<CachedMarket> mCachedCO2Market;
+    
+    virtual void locateMarkets( const std::string& aRegionName, const int aPeriod );
+    
     virtual const std::string& getXMLName() const;
 
     virtual bool XMLDerivedClassParse( const std::string& nodeName, const xercesc::DOMNode* curr );
@@ -48,6 +48,12 @@
 #include "land_allocator/include/land_node.h"
 #include "util/base/include/ivisitable.h"
 
+#include <functional>
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/enumerable_thread_specific.h>
+#endif
+
 class IInfo;
 
 /*! 
@@ -116,6 +122,9 @@ public:
                                 const double aLandAllocationAbove,
                                 const int aPeriod );
 
+    virtual void calculateNodeProfitRates( const std::string& aRegionName,
+                                           const int aPeriod );
+
     virtual double calcLandShares( const std::string& aRegionName,
                                    IDiscreteChoice* aChoiceFnAbove,
                                    const int aPeriod );
@@ -162,6 +171,50 @@ private:
     void calibrateLandAllocator( const std::string& aRegionName, const int aPeriod );
 
     void checkLandArea( const std::string& aRegionName, const int aPeriod );
+
+    void flattenLandTree();
+
+    void appendFlatChildren( const size_t aIndex );
+
+    void forEachFlatSegment( const std::function<void( const size_t )>& aSegmentFn );
+
+    void calcFlatLandShares( const std::string& aRegionName, double* aLogShares,
+                             const size_t aIndex, const int aPeriod );
+
+    std::vector<double>& getFlatScratch();
+
+    /*!
+     * \brief The items of the land allocation tree starting with this root.
+     * \details The tree is flattened once during completeInit so that the
+     *          share and allocation calculations can be done in a single loop
+     *          over contiguous arrays rather than recursing through the tree.
+     *          The children of any node are always contiguous in this ordering
+     *          and come after their parent.  Note the items themselves still
+     *          hold all of the state such as shares and profit rates.
+     * \sa flattenLandTree
+     */
+    std::vector<ALandAllocatorItem*> mFlatItems;
+
+    //! The index into mFlatItems of the parent of each item.
+    std::vector<size_t> mFlatParent;
+
+    //! The index into mFlatItems of the first child of each item.
+    std::vector<size_t> mFlatFirstChild;
+
+    //! The discrete choice function of the parent of each item.
+    std::vector<IDiscreteChoice*> mFlatChoiceFnAbove;
+
+    //! The index into mFlatItems of the first descendant of each child of the
+    //! root with one extra entry to mark the end of the last segment.
+    std::vector<size_t> mFlatSegmentStart;
+
+    //! Scratch space used to hold a value for each item in mFlatItems
+    //! during calculations.
+#if GCAM_PARALLEL_ENABLED
+    tbb::enumerable_thread_specific<std::vector<double> > mFlatScratch;
+#else
+    std::vector<double> mFlatScratch;
+#endif
 };
 
 #endif // _LAND_ALLOCATOR_H_
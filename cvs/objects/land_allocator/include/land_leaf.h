@@ -45,12 +45,14 @@
  * \author James Blackwood
  */
 
+#include <memory>
 #include <xercesc/dom/DOMNode.hpp>
 #include "land_allocator/include/aland_allocator_item.h"
 #include "util/base/include/ivisitable.h"
 
 class Tabs;
 class ICarbonCalc;
+class CachedMarket;
 
 /*!
  * \brief A LandLeaf is the leaf of a land allocation tree.
@@ -191,6 +193,33 @@ protected:
         DEFINE_VARIABLE( SIMPLE, "negative-emiss-market", mNegEmissMarketName, std::string )
     )
 
+    //! A pre-located land-use change CO2 market which has been cached from the
+    //! marketplace to get the carbon price from and to add emissions to.
+    std::auto_ptr<CachedMarket> mCachedLUCMarket;
+
+    //! A pre-located negative emissions policy market which has been cached
+    //! from the marketplace to scale back the carbon subsidy.
+    std::auto_ptr<CachedMarket> mCachedNegEmissMarket;
+
+    //! A pre-located land expansion cost market which has been cached from the
+    //! marketplace to add land demands to.
+    std::auto_ptr<CachedMarket> mCachedExpansionCostMarket;
+
+    //! A pre-located land constraint policy market which has been cached from
+    //! the marketplace to add land demands or supplies to.
+    std::auto_ptr<CachedMarket> mCachedConstraintMarket;
+
+    //! The policy type, "tax" or "subsidy", of the land constraint policy
+    //! market which is resolved along with the cached markets.
+    std::string mLandConstraintPolicyType;
+
+    //! The period for which the cached markets were located.
+    int mCachedMarketPeriod;
+
+    void updateCachedMarkets( const std::string& aRegionName, const int aPeriod );
+
+    virtual void locateMarkets( const std::string& aRegionName, const int aPeriod );
+
     double getCarbonSubsidy( const std::string& aRegionName,
                            const int aPeriod ) const;
     
@@ -101,6 +101,10 @@ public:
     virtual void calculateNodeProfitRates( const std::string& aRegionName,
                                            const int aPeriod );
 
+    void calcNodeProfitRateFromChildren( const int aPeriod );
+
+    IDiscreteChoice* getChoiceFn() const;
+
     virtual void calculateShareWeights( const std::string& aRegionName, 
                                         IDiscreteChoice* aChoiceFnAbove,
                                         const int aPeriod,
@@ -127,6 +131,10 @@ public:
                                    IDiscreteChoice* aChoiceFnAbove,
                                    const int aPeriod );
 
+    double calcLandSharesFromChildren( double* aChildLogShares,
+                                       IDiscreteChoice* aChoiceFnAbove,
+                                       const int aPeriod );
+
     virtual void calcLandAllocation( const std::string& aRegionName,
                                      const double aLandAllocationAbove,
                                      const int aPeriod );
@@ -45,6 +45,7 @@
 #include "ccarbon_model/include/land_carbon_densities.h"
 #include "util/base/include/ivisitor.h"
 #include "marketplace/include/marketplace.h"
+#include "marketplace/include/cached_market.h"
 #include "containers/include/iinfo.h"
 #include "util/base/include/configuration.h"
 
@@ -89,6 +90,18 @@ const string& CarbonLandLeaf::getXMLNameStatic() {
     return XML_NAME;
 }
 
+/*!
+ * \brief Locate the markets used by this leaf for the given period.
+ * \details In addition to the markets used by all land leaves carbon land
+ *          leaves get their profit rate from the CO2 price.
+ * \param aRegionName Region name.
+ * \param aPeriod Model period.
+ */
+void CarbonLandLeaf::locateMarkets( const string& aRegionName, const int aPeriod ) {
+    LandLeaf::locateMarkets( aRegionName, aPeriod );
+    mCachedCO2Market = scenario->getMarketplace()->locateMarket( "CO2", aRegionName, aPeriod );
+}
+
 /*!
 * \brief Sets a the profit rate of a land leaf
 * \details This method adjusts the profit rate of an unmanaged land leaf
@@ -109,13 +122,14 @@ void CarbonLandLeaf::setUnmanagedLandProfitRate( const string& aRegionName,
         mainLog << "carbon plantations." << endl;
     }
 
+    updateCachedMarkets( aRegionName, aPeriod );
+
     double profitRate = 0.0;
 
     // The base profit rate is based on the carbon density and the carbon price
     
     // Check if a carbon market exists and has a non-zero price.
-    const Marketplace* marketplace = scenario->getMarketplace();
-    double carbonPrice = marketplace->getPrice( "CO2", aRegionName, aPeriod, false );
+    double carbonPrice = mCachedCO2Market->getPrice( "CO2", aRegionName, aPeriod, false );
 
     // If a carbon price exists, calculate the subsidy
     if( carbonPrice != Marketplace::NO_MARKET_PRICE && carbonPrice > 0.0 ){
@@ -50,6 +50,12 @@
 #include "util/base/include/configuration.h"
 #include "functions/include/idiscrete_choice.hpp"
 
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include "util/base/include/manage_state_variables.hpp"
+#endif
+
 using namespace std;
 using namespace xercesc;
 
@@ -165,6 +171,110 @@ void LandAllocator::completeInit( const string& aRegionName,
 
     // Set the soil time scale
     setSoilTimeScale( mSoilTimeScale );
+
+    // The structure of the tree is now fixed so flatten it for calculations.
+    flattenLandTree();
+}
+
+/*!
+ * \brief Flatten the land allocation tree into level ordered arrays.
+ * \details The root comes first followed by its children.  The descendants of
+ *          each child of the root then follow in a separate segment, walked
+ *          breadth first, so that the children of each node are contiguous and
+ *          always come after their parent.  The share calculation can then
+ *          visit items in reverse order to have all children complete before
+ *          their parent and the allocation calculation can visit them in
+ *          forward order to have all parents complete before their children.
+ *          Since the nests below each child of the root are independent until
+ *          the root normalizes their shares each segment may be calculated
+ *          concurrently.
+ */
+void LandAllocator::flattenLandTree() {
+    mFlatItems.clear();
+    mFlatParent.clear();
+    mFlatFirstChild.clear();
+    mFlatChoiceFnAbove.clear();
+    mFlatSegmentStart.clear();
+
+    mFlatItems.push_back( this );
+    mFlatParent.push_back( 0 );
+    mFlatChoiceFnAbove.push_back( mChoiceFn );
+    appendFlatChildren( 0 );
+    for( size_t segment = 1; segment <= mChildren.size(); ++segment ) {
+        mFlatSegmentStart.push_back( mFlatItems.size() );
+        appendFlatChildren( segment );
+        for( size_t i = mFlatSegmentStart.back(); i < mFlatItems.size(); ++i ) {
+            appendFlatChildren( i );
+        }
+    }
+    mFlatSegmentStart.push_back( mFlatItems.size() );
+    mFlatFirstChild.resize( mFlatItems.size(), mFlatItems.size() );
+}
+
+/*!
+ * \brief Append the children of an item in the flattened tree to the end of it.
+ * \param aIndex The index into mFlatItems of the item.
+ */
+void LandAllocator::appendFlatChildren( const size_t aIndex ) {
+    mFlatFirstChild.resize( mFlatItems.size() );
+    mFlatFirstChild[ aIndex ] = mFlatItems.size();
+    ALandAllocatorItem* curr = mFlatItems[ aIndex ];
+    if( curr->getType() == eNode ) {
+        IDiscreteChoice* choiceFn = static_cast<LandNode*>( curr )->getChoiceFn();
+        for( size_t child = 0; child < curr->getNumChildren(); ++child ) {
+            mFlatItems.push_back( curr->getChildAt( child ) );
+            mFlatParent.push_back( aIndex );
+            mFlatChoiceFnAbove.push_back( choiceFn );
+        }
+    }
+}
+
+/*!
+ * \brief Run a calculation for each segment of the flattened tree.
+ * \details When running in parallel and the tree is large enough the segments
+ *          will be calculated concurrently.  Every task is run in the state of
+ *          the calling thread since the worker threads may otherwise be using
+ *          different "scratch" states.
+ * \param aSegmentFn The calculation to run which takes the segment index.
+ */
+void LandAllocator::forEachFlatSegment( const function<void( const size_t )>& aSegmentFn ) {
+    const size_t numSegments = mFlatSegmentStart.size() - 1;
+#if GCAM_PARALLEL_ENABLED
+    // The minimum number of items in the tree before splitting the calculation
+    // between segments is worth the overhead of creating tasks.
+    const static size_t parallelThreshold = Configuration::getInstance()->getInt(
+        "land-allocator-parallel-threshold", 500, false );
+    if( numSegments > 1 && mFlatItems.size() >= parallelThreshold ) {
+        double* state = ManageStateVariables::getThreadState();
+        tbb::this_task_arena::isolate( [&]() {
+            tbb::parallel_for( size_t( 0 ), numSegments, [&]( const size_t aSegment ) {
+                double* prevState = ManageStateVariables::setThreadState( state );
+                aSegmentFn( aSegment );
+                ManageStateVariables::setThreadState( prevState );
+            } );
+        } );
+        return;
+    }
+#endif
+    for( size_t segment = 0; segment < numSegments; ++segment ) {
+        aSegmentFn( segment );
+    }
+}
+
+/*!
+ * \brief Get a scratch array with a value for each item in the flattened tree.
+ * \details Calculations for the same region may happen concurrently so the
+ *          scratch space is kept per thread when running in parallel.
+ * \return The scratch array for the current thread.
+ */
+vector<double>& LandAllocator::getFlatScratch() {
+#if GCAM_PARALLEL_ENABLED
+    vector<double>& scratch = mFlatScratch.local();
+#else
+    vector<double>& scratch = mFlatScratch;
+#endif
+    scratch.resize( mFlatItems.size() );
+    return scratch;
 }
 
 
@@ -321,21 +431,109 @@ double LandAllocator::calcLandShares( const string& aRegionName,
     // First set value of unmanaged land leaves
     setUnmanagedLandProfitRate( aRegionName, mUnManagedLandValue, aPeriod );
 
-    LandNode::calcLandShares( aRegionName, aChoiceFnAbove, aPeriod );
+    if( mFlatItems.empty() ) {
+        LandNode::calcLandShares( aRegionName, aChoiceFnAbove, aPeriod );
+    }
+    else {
+        // Visit the items in each segment in reverse order so that the
+        // log( unnormalized shares ) of all of the children of a node are
+        // complete before the node itself.  The child of the root at the head
+        // of the segment is done last.
+        double* logShares = &getFlatScratch()[ 0 ];
+        forEachFlatSegment( [&]( const size_t aSegment ) {
+            for( size_t i = mFlatSegmentStart[ aSegment + 1 ]; i > mFlatSegmentStart[ aSegment ]; --i ) {
+                calcFlatLandShares( aRegionName, logShares, i - 1, aPeriod );
+            }
+            calcFlatLandShares( aRegionName, logShares, aSegment + 1, aPeriod );
+        } );
+        calcLandSharesFromChildren( logShares + mFlatFirstChild[ 0 ], aChoiceFnAbove, aPeriod );
+    }
  
     // This is the root node so its share is 100%.
     mShare[ aPeriod ] = 1;
     return 1;
 }
 
+/*!
+ * \brief Calculate the log( unnormalized share ) of a single item in the
+ *        flattened tree.
+ * \details If the item is a node the log( unnormalized shares ) of its children
+ *          must already be set and will be normalized.
+ * \param aRegionName Region name.
+ * \param aLogShares The log( unnormalized shares ) for each item.
+ * \param aIndex The index into mFlatItems of the item to calculate.
+ * \param aPeriod Model period.
+ */
+void LandAllocator::calcFlatLandShares( const string& aRegionName, double* aLogShares,
+                                        const size_t aIndex, const int aPeriod )
+{
+    ALandAllocatorItem* curr = mFlatItems[ aIndex ];
+    if( curr->getType() == eNode ) {
+        aLogShares[ aIndex ] = static_cast<LandNode*>( curr )->calcLandSharesFromChildren(
+            aLogShares + mFlatFirstChild[ aIndex ], mFlatChoiceFnAbove[ aIndex ], aPeriod );
+    }
+    else {
+        aLogShares[ aIndex ] = curr->calcLandShares( aRegionName, mFlatChoiceFnAbove[ aIndex ], aPeriod );
+    }
+}
+
 void LandAllocator::calcLandAllocation( const string& aRegionName,
                                             const double aLandAllocationAbove,
                                             const int aPeriod ){
-    for ( unsigned int i = 0; i < mChildren.size(); ++i ){
-        mChildren[ i ]->calcLandAllocation( aRegionName, mLandAllocation[ aPeriod ], aPeriod );
+    if( mFlatItems.empty() ) {
+        for ( unsigned int i = 0; i < mChildren.size(); ++i ){
+            mChildren[ i ]->calcLandAllocation( aRegionName, mLandAllocation[ aPeriod ], aPeriod );
+        }
+        return;
+    }
+
+    // Visit the items in order so that the land allocation of each node is known
+    // before any of its children.  Only leaves need to store their land allocation,
+    // nodes just pass theirs down.  Note this is always done serially as leaves
+    // add their land to the land constraint markets.
+    vector<double>& landAllocation = getFlatScratch();
+    landAllocation[ 0 ] = mLandAllocation[ aPeriod ];
+    for( size_t i = 1; i < mFlatItems.size(); ++i ) {
+        ALandAllocatorItem* curr = mFlatItems[ i ];
+        const double landAllocationAbove = landAllocation[ mFlatParent[ i ] ];
+        if( curr->getType() == eNode ) {
+            const double share = curr->getShare( aPeriod );
+            assert( share >= 0.0 && share <= 1.0 );
+            landAllocation[ i ] = landAllocationAbove > 0.0 && share > 0.0 ?
+                landAllocationAbove * share : 0.0;
+        }
+        else {
+            curr->calcLandAllocation( aRegionName, landAllocationAbove, aPeriod );
+        }
     }
 }
 
+void LandAllocator::calculateNodeProfitRates( const string& aRegionName,
+                                              const int aPeriod )
+{
+    if( mFlatItems.empty() ) {
+        LandNode::calculateNodeProfitRates( aRegionName, aPeriod );
+        return;
+    }
+
+    // Visit the items in each segment in reverse order so that all child nodes
+    // have their profit rates set before their parent.  Leaves do not need to
+    // be visited.
+    forEachFlatSegment( [&]( const size_t aSegment ) {
+        for( size_t i = mFlatSegmentStart[ aSegment + 1 ]; i > mFlatSegmentStart[ aSegment ]; --i ) {
+            ALandAllocatorItem* curr = mFlatItems[ i - 1 ];
+            if( curr->getType() == eNode ) {
+                static_cast<LandNode*>( curr )->calcNodeProfitRateFromChildren( aPeriod );
+            }
+        }
+        ALandAllocatorItem* head = mFlatItems[ aSegment + 1 ];
+        if( head->getType() == eNode ) {
+            static_cast<LandNode*>( head )->calcNodeProfitRateFromChildren( aPeriod );
+        }
+    } );
+    calcNodeProfitRateFromChildren( aPeriod );
+}
+
 void LandAllocator::calcLUCEmissions( const string& aRegionName, const int aPeriod,
                                       const int aEndYear, const bool aStoreFullEmiss )
 {
@@ -47,6 +47,7 @@
 
 #include "util/base/include/xml_helper.h"
 #include "marketplace/include/marketplace.h"
+#include "marketplace/include/cached_market.h"
 #include "containers/include/scenario.h"
 #include "land_allocator/include/land_leaf.h"
 #include "util/base/include/ivisitor.h"
@@ -79,7 +80,8 @@ LandLeaf::LandLeaf( const ALandAllocatorItem* aParent, const std::string &aName
     mLandUseHistory( 0 ),
     mReadinLandAllocation( Value( 0.0 ) ),
     mLastCalcCO2Value( 0.0 ),
-    mLandConstraintPolicy( "" )
+    mLandConstraintPolicy( "" ),
+    mCachedMarketPeriod( -1 )
 {
 }
 
@@ -242,6 +244,20 @@ void LandLeaf::completeInit( const string& aRegionName,
     if( mNegEmissMarketName.empty() ) {
         mNegEmissMarketName = aRegionInfo->getString( "negative-emiss-market", true );
     }
+
+    // The land allocation depends on the land use change carbon price through
+    // the carbon subsidy and adds to that market's demand, so it must be
+    // recalculated when the price changes.
+    scenario->getMarketplace()->getDependencyFinder()->addDependency( "land-allocator",
+                                                                      aRegionName,
+                                                                      "CO2_LUC",
+                                                                      aRegionName );
+    if( !mNegEmissMarketName.empty() ) {
+        scenario->getMarketplace()->getDependencyFinder()->addDependency( "land-allocator",
+                                                                          aRegionName,
+                                                                          mNegEmissMarketName,
+                                                                          aRegionName );
+    }
     
     // Add dependency for to expansion constraint policy if it is being used.
     if( mLandConstraintPolicy != "" ) {
@@ -263,6 +279,49 @@ void LandLeaf::initCalc( const string& aRegionName, const int aPeriod )
     }
 
     mCarbonContentCalc->initCalc( aPeriod );
+
+    updateCachedMarkets( aRegionName, aPeriod );
+}
+
+/*!
+ * rief Locate the markets used by this leaf for the given period if they
+ *        have not been already.
+ * \details The ag technologies set profit rates during their own initCalc which
+ *          happens before the land allocator's so this is called when setting
+ *          profit rates as well as from initCalc.  Once located for the period
+ *          this only checks the period so that no markets are looked up by name
+ *          during World::calc.
+ * \param aRegionName Region name.
+ * \param aPeriod Model period.
+ */
+void LandLeaf::updateCachedMarkets( const string& aRegionName, const int aPeriod ) {
+    if( mCachedMarketPeriod != aPeriod ) {
+        locateMarkets( aRegionName, aPeriod );
+        mCachedMarketPeriod = aPeriod;
+    }
+}
+
+/*!
+ * rief Locate the markets used by this leaf for the given period.
+ * \details Derived classes which use other markets should override this method
+ *          and call the base class version.
+ * \param aRegionName Region name.
+ * \param aPeriod Model period.
+ */
+void LandLeaf::locateMarkets( const string& aRegionName, const int aPeriod ) {
+    Marketplace* marketplace = scenario->getMarketplace();
+    mCachedLUCMarket = marketplace->locateMarket( "CO2_LUC", aRegionName, aPeriod );
+    if( !mNegEmissMarketName.empty() ) {
+        mCachedNegEmissMarket = marketplace->locateMarket( mNegEmissMarketName, aRegionName, aPeriod );
+    }
+    if ( mIsLandExpansionCost ) {
+        mCachedExpansionCostMarket = marketplace->locateMarket( mLandExpansionCostName, aRegionName, aPeriod );
+    }
+    if ( mLandConstraintPolicy != "" ) {
+        mCachedConstraintMarket = marketplace->locateMarket( mLandConstraintPolicy, aRegionName, aPeriod );
+        mLandConstraintPolicyType = marketplace->getMarketInfo( mLandConstraintPolicy, aRegionName, 0, true )
+            ->getString( "policy-type", true );
+    }
 }
 
 /*!
@@ -334,13 +393,14 @@ void LandLeaf::setProfitRate( const string& aRegionName,
                                  const double aProfitRate,
                                  const int aPeriod )
 {
+    updateCachedMarkets( aRegionName, aPeriod );
+
     // adjust profit rate for land expnasion costs if applicable
     double adjustedProfitRate = aProfitRate;
-    const Marketplace* marketplace = scenario->getMarketplace();
 
     if ( mIsLandExpansionCost ) {
         //subtract off expansion cost from profit rate
-        double expansionCost = marketplace->getPrice( mLandExpansionCostName, aRegionName, aPeriod );
+        double expansionCost = mCachedExpansionCostMarket->getPrice( mLandExpansionCostName, aRegionName, aPeriod );
         adjustedProfitRate = aProfitRate - expansionCost;
     }
 
@@ -361,8 +421,7 @@ void LandLeaf::setProfitRate( const string& aRegionName,
 double LandLeaf::getCarbonSubsidy( const string& aRegionName, const int aPeriod ) const {
     const double dollar_conversion_75_90 = 2.212;
     // Check if a carbon market exists and has a non-zero price.
-    const Marketplace* marketplace = scenario->getMarketplace();
-    double carbonPrice = marketplace->getPrice( "CO2_LUC", aRegionName, aPeriod, false );
+    double carbonPrice = mCachedLUCMarket->getPrice( "CO2_LUC", aRegionName, aPeriod, false );
 
     // If a carbon price exists, calculate the subsidy
     if( carbonPrice != Marketplace::NO_MARKET_PRICE && carbonPrice > 0.0 ){
@@ -392,7 +451,7 @@ double LandLeaf::getCarbonSubsidy( const string& aRegionName, const int aPeriod
         // potentially scale back the carbon subsidy if we have a binding negative
         // emissions budget in place
         if( !mNegEmissMarketName.empty() ) {
-            double taxFraction = marketplace->getPrice( mNegEmissMarketName, aRegionName, aPeriod, false );
+            double taxFraction = mCachedNegEmissMarket->getPrice( mNegEmissMarketName, aRegionName, aPeriod, false );
             taxFraction = taxFraction == Marketplace::NO_MARKET_PRICE ?
                 1.0 : (1.0 - taxFraction);
             carbonSubsidy *= taxFraction;
@@ -420,17 +479,15 @@ double LandLeaf::getLandConstraintCost( const string& aRegionName, const int aPe
         return 0.0;
     } else {
         // Get the cost from the marketplace
-        const Marketplace* marketplace = scenario->getMarketplace();
-        double landPrice = marketplace->getPrice( mLandConstraintPolicy, aRegionName, aPeriod, false );
+        double landPrice = mCachedConstraintMarket->getPrice( mLandConstraintPolicy, aRegionName, aPeriod, false );
         
         // Only two policy types are permitted, "tax" and "subsidy".
         // Since this value is added to the profit rate of the LandLeaf later, we need to ensure it is the correct sign.
         // If the market is a tax, then we convert to a negative value so that it is effectively subtracted from the profit.
         // Otherwise, we keep it positive.
-        std::string type = marketplace->getMarketInfo( mLandConstraintPolicy, aRegionName, 0, true)->getString( "policy-type", true);
-        if ( type == "tax" ) {
+        if ( mLandConstraintPolicyType == "tax" ) {
             landPrice *= -1.0;
-        } else if ( type != "subsidy" ) {
+        } else if ( mLandConstraintPolicyType != "subsidy" ) {
             ILogger& mainLog = ILogger::getLogger( "main_log" );
             mainLog.setLevel( ILogger::ERROR );
             mainLog << "Invalid policy type for the LandConstraintCost. Defaulting to subsidy." << endl;
@@ -536,22 +593,19 @@ void LandLeaf::calcLandAllocation( const string& aRegionName,
 
     // compute any demands for land use constraint resources
     if ( mIsLandExpansionCost ) {
-        Marketplace* marketplace = scenario->getMarketplace();
-        marketplace->addToDemand( mLandExpansionCostName, aRegionName,
+        mCachedExpansionCostMarket->addToDemand( mLandExpansionCostName, aRegionName,
             mLandAllocation[ aPeriod ], aPeriod, true );
     }
     
     // compute any demands for land use constraint policies
     if ( mLandConstraintPolicy != "" ) {
-        Marketplace* marketplace = scenario->getMarketplace();
-        std::string type = marketplace->getMarketInfo( mLandConstraintPolicy, aRegionName, 0, true)->getString( "policy-type", true);
-        if ( type == "tax" ) {
-            marketplace->addToDemand( mLandConstraintPolicy, aRegionName,
-                                     mLandAllocation[ aPeriod ], aPeriod, true );
+        if ( mLandConstraintPolicyType == "tax" ) {
+            mCachedConstraintMarket->addToDemand( mLandConstraintPolicy, aRegionName,
+                                                  mLandAllocation[ aPeriod ], aPeriod, true );
 
-        } else if ( type == "subsidy" ) {
-            marketplace->addToSupply( mLandConstraintPolicy, aRegionName,
-                                     mLandAllocation[ aPeriod ], aPeriod, true );
+        } else if ( mLandConstraintPolicyType == "subsidy" ) {
+            mCachedConstraintMarket->addToSupply( mLandConstraintPolicy, aRegionName,
+                                                  mLandAllocation[ aPeriod ], aPeriod, true );
 
         }
     }
@@ -575,9 +629,8 @@ void LandLeaf::calcLUCEmissions( const string& aRegionName,
 
     // Add emissions to the carbon market.
     if ( !aStoreFullEmiss ) {
-        Marketplace* marketplace = scenario->getMarketplace();
-        marketplace->addToDemand( "CO2_LUC", aRegionName,
-                                  mLastCalcCO2Value, aPeriod, false );
+        mCachedLUCMarket->addToDemand( "CO2_LUC", aRegionName,
+                                       mLastCalcCO2Value, aPeriod, false );
     }  
 }
 
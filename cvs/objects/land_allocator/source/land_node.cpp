@@ -353,14 +353,35 @@ double LandNode::calcLandShares( const string& aRegionName,
                                                                   aPeriod );
     }
 
+    return calcLandSharesFromChildren( unnormalizedShares.empty() ? 0 : &unnormalizedShares[ 0 ],
+                                       aChoiceFnAbove, aPeriod );
+}
+
+/*!
+ * \brief Calculates the shares of the children of this node given their
+ *        unnormalized shares and the unnormalized share of this node.
+ * \details This performs the non-recursive part of calcLandShares so that
+ *          callers which have already computed the unnormalized shares of the
+ *          children, such as the flattened calculation in LandAllocator, can
+ *          complete the calculation for this node without walking the tree.
+ * \param aChildLogShares The log( unnormalized shares ) of each child in order.
+ *                        These will be replaced with the normalized shares.
+ * \param aChoiceFnAbove The discrete choice function from the level above.
+ * \param aPeriod Period.
+ * \return The unnormalized share of this node.
+ */
+double LandNode::calcLandSharesFromChildren( double* aChildLogShares,
+                                             IDiscreteChoice* aChoiceFnAbove,
+                                             const int aPeriod )
+{
     // Step 2 Normalize and set the share of each child
     // The log( unnormalized ) shares will be normalizd after this call and it will
     // do it making an attempt to avoid numerical instabilities given the profit rates
     // may be large values.  The value returned is a pair<unnormalizedSum, log(scale factor)>
     // again in order to try to make calculations in a numerically stable way.
-    pair<double, double> unnormalizedSum = SectorUtils::normalizeLogShares( unnormalizedShares );
+    pair<double, double> unnormalizedSum = SectorUtils::normalizeLogShares( aChildLogShares, mChildren.size() );
     for ( unsigned int i = 0; i < mChildren.size(); i++ ) {
-        mChildren[ i ]->setShare( unnormalizedShares[ i ], aPeriod );
+        mChildren[ i ]->setShare( aChildLogShares[ i ], aPeriod );
     }
 
     // Step 3 Option (a) . compute node profit based on share denominator
@@ -428,6 +449,18 @@ void LandNode::calculateNodeProfitRates( const string& aRegionName,
         mChildren[ i ]->calculateNodeProfitRates( aRegionName, aPeriod );
     }
 
+    calcNodeProfitRateFromChildren( aPeriod );
+}
+
+/*!
+ * \brief Sets the profit rate of this node from the profit rates of its
+ *        children.
+ * \details This performs the non-recursive part of calculateNodeProfitRates
+ *          and requires that the node profit rates of any child nodes have
+ *          already been calculated.
+ * \param aPeriod Model period.
+ */
+void LandNode::calcNodeProfitRateFromChildren( const int aPeriod ) {
     // Calculate a reasonable "base" profit rate to use to set the scale for when
     // changes in absolute profit rates would be made relative.  We do this by
     // taking the higest profit rate from any of the direct child items.
@@ -625,6 +658,15 @@ LandUseHistory* LandNode::getLandUseHistory(){
     return( this->mLandUseHistory );
 }
 
+/*!
+ * \brief Get the discrete choice function used to share between the children
+ *        of this node.
+ * \return The discrete choice function of this node.
+ */
+IDiscreteChoice* LandNode::getChoiceFn() const {
+    return mChoiceFn;
+}
+
 bool LandNode::isUnmanagedLandLeaf( )  const 
 {
     return false;
@@ -46,7 +46,7 @@
 #include "emissions/include/aghg.h"
 #include "util/base/include/ivisitor.h"
 #include "emissions/include/ghg_factory.h"
-#include "marketplace/include/marketplace.h"
+#include "marketplace/include/cached_market.h"
 
 using namespace std;
 using namespace xercesc;
@@ -104,13 +104,14 @@ void UnmanagedLandLeaf::setUnmanagedLandProfitRate( const string& aRegionName,
                                                     double aAverageProfitRate,
                                                     const int aPeriod )
 {
+    updateCachedMarkets( aRegionName, aPeriod );
+
     // Adjust profit rate for land expnasion costs if applicable
     double adjustedProfitRate = aAverageProfitRate;
-    const Marketplace* marketplace = scenario->getMarketplace();
 
     if ( mIsLandExpansionCost ) {
         //subtract off expansion cost from profit rate
-        double expansionCost = marketplace->getPrice( mLandExpansionCostName, aRegionName, aPeriod );
+        double expansionCost = mCachedExpansionCostMarket->getPrice( mLandExpansionCostName, aRegionName, aPeriod );
         adjustedProfitRate = adjustedProfitRate - expansionCost;
     }
 
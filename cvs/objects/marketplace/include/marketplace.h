@@ -45,6 +45,7 @@
 */
 
 #include <vector>
+#include <map>
 #include <iosfwd>
 #include <string>
 #include <memory>
@@ -225,6 +226,11 @@ protected:
     
     //! Flag indicating whether the next call to world->calc() will be part of a partial derivative calculation 
     static bool mIsDerivativeCalc;
+
+    //! The result of checking the Jacobian shortcuts, by period and names of the
+    //! solvable markets.  This is kept here for LogEDFun, which only lives
+    //! for a single call to a solver.
+    std::map<std::pair<int, std::string>, int> mJacobianCheckStatus;
 };
 
 #endif
@@ -327,13 +327,10 @@ void Market::nullDemand() {
 */
 void Market::addToDemand( const double demandIn ) {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock writeLock( mDemandMutex, true );
-        mDemand += demandIn;
-    }
-    else {
-        mDemand += demandIn;
-    }
+    // Many activities may be adding to this market at once during a
+    // parallel World.calc, including while calculating a partial derivative
+    // with its own flow graph, avoid serializing them on a lock.
+    mDemand.atomicAdd( demandIn );
 #else
     mDemand += demandIn;
 #endif
@@ -348,13 +345,7 @@ void Market::addToDemand( const double demandIn ) {
 */
 double Market::getRawDemand() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mDemandMutex, false );
-        return mDemand;
-    }
-    else {
-        return mDemand;
-    }
+    return mDemand.atomicGet();
 #else
     return mDemand;
 #endif
@@ -369,13 +360,7 @@ double Market::getRawDemand() const {
  */
 double Market::getSolverDemand() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mDemandMutex, false );
-        return mDemand;
-    }
-    else {
-        return mDemand;
-    }
+    return mDemand.atomicGet();
 #else
     return mDemand;
 #endif
@@ -387,13 +372,7 @@ double Market::getSolverDemand() const {
 */
 double Market::getDemand() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mDemandMutex, false );
-        return mDemand;
-    }
-    else {
-        return mDemand;
-    }
+    return mDemand.atomicGet();
 #else
     return mDemand;
 #endif
@@ -415,13 +394,7 @@ void Market::nullSupply() {
 */
 double Market::getRawSupply() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mSupplyMutex, false );
-        return mSupply;
-    }
-    else {
-        return mSupply;
-    }
+    return mSupply.atomicGet();
 #else
     return mSupply;
 #endif
@@ -437,13 +410,7 @@ double Market::getRawSupply() const {
 */
 double Market::getSolverSupply() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mSupplyMutex, false );
-        return mSupply;
-    }
-    else {
-        return mSupply;
-    }
+    return mSupply.atomicGet();
 #else
     return mSupply;
 #endif
@@ -455,13 +422,7 @@ double Market::getSolverSupply() const {
 */
 double Market::getSupply() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mSupplyMutex, false );
-        return mSupply;
-    }
-    else {
-        return mSupply;
-    }
+    return mSupply.atomicGet();
 #else
     return mSupply;
 #endif
@@ -475,13 +436,10 @@ double Market::getSupply() const {
 */
 void Market::addToSupply( const double supplyIn ) {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock writeLock( mSupplyMutex, true );
-        mSupply += supplyIn;
-    }
-    else {
-        mSupply += supplyIn;
-    }
+    // Many activities may be adding to this market at once during a
+    // parallel World.calc, including while calculating a partial derivative
+    // with its own flow graph, avoid serializing them on a lock.
+    mSupply.atomicAdd( supplyIn );
 #else
     mSupply += supplyIn;
 #endif
@@ -120,15 +120,20 @@ public:
 
     bmatrix C(cm,cn);
 
-    // naive matrix multiply -- terrible cache performance.  Fix if
-    // this subroutine ever an important contributor to run time
+    // Loop over k outside of j so that rows of B are read
+    // contiguously, and skip the rows of B that can't contribute.
+    // Adjacency matrices are sparse, so most of them are skipped.
     for(unsigned i=0; i<cm; ++i) {
       const unsigned *ai = this->operator[](i);
       unsigned *ci = C[i];
-      for(unsigned j=0; j<cn; ++j) {
+      for(unsigned j=0; j<cn; ++j)
         ci[j] = 0;
-        for(unsigned k=0; k<kmx; ++k)
-          ci[j] |= ai[k] & B[k][j];
+      for(unsigned k=0; k<kmx; ++k) {
+        if(!ai[k])
+          continue;
+        const unsigned *bk = B[k];
+        for(unsigned j=0; j<cn; ++j)
+          ci[j] |= bk[j];
       }
     }
     return C;
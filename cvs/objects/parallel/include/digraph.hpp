@@ -40,6 +40,7 @@
 #include <algorithm>
 #include <string>
 #include <assert.h>
+#include <stdint.h>
 #include "parallel/include/util.hpp"
 #include "parallel/include/bmatrix.hpp"
 #include "parallel/include/bitvector.hpp"
@@ -598,7 +599,12 @@ public:
   //! transitive reduction, given the matrix from the transitive completion
   digraph<nodeid_t> treduce(const bmatrix &GT, const std::vector<nodeid_t> &nodes) const;
   //! compute the transitive reduction of the graph.
-  //! \details This version uses a different algorithm than the matrix one.
+  //! \details This version uses a different algorithm than the matrix
+  //! one.  For acyclic graphs it computes reachability sets as 64-bit
+  //! word bit sets over the topologically sorted nodes, one block of
+  //! target nodes at a time, so that memory use stays proportional to
+  //! the number of nodes.  Cyclic graphs fall back to a depth-first
+  //! search. 
   digraph<nodeid_t> treduce(void) const;
 
   //! perform a topological sort and store the results in the node objects
@@ -614,6 +620,8 @@ public:
   static bool no_descendants(const nodelist_value_t &n) {return n.second.successors.empty();}
   static bool has_descendants(const nodelist_value_t &n) {return !n.second.successors.empty();}
   void treduce_internal(const nodeid_t &nodename, const nodeid_t &last);
+  void treduce_dfs(void);
+  bool rank_order(std::vector<unsigned> &rank, std::vector<std::vector<unsigned> > &succ) const;
   nodeid_t find_srcsink_internal(const std::set<nodeid_t> &subg, bool reverse) const;
   nodeid_t find_srcsink_internal(const bitvector &subg, bool reverse) const;
   void find_sources_or_sinks_internal(const std::set<nodeid_t> &subg, std::set<nodeid_t> &rslt,
@@ -1142,6 +1150,74 @@ bool digraph<nodeid_t>::DFS(const nodeid_t &start, bitvector &seen,
   return rv;
 }
 
+//! Order the nodes of an acyclic graph for the word-parallel algorithms 
+//! \details Sorts the nodes topologically without disturbing the
+//! stored topological sort.  Self edges are ignored. 
+//! \param rank Output: rank of each node, indexed by position in the
+//!        node list.
+//! \param succ Output: successors of each node, indexed by rank and
+//!        given as ranks in increasing order.
+//! \return false if the graph has a cycle, in which case the outputs
+//!         are not valid. 
+template <class nodeid_t>
+bool digraph<nodeid_t>::rank_order(std::vector<unsigned> &rank,
+                                   std::vector<std::vector<unsigned> > &succ) const
+{
+  unsigned n = allnodes.size();
+
+  // use the mutable mark field to record the position of each node in
+  // the node list so that edges can be converted to indices.
+  unsigned idx = 0;
+  for(nodelist_c_iter_t nit=allnodes.begin(); nit != allnodes.end(); ++nit)
+    nit->second.mark = idx++;
+
+  std::vector<std::vector<unsigned> > adj(n);
+  std::vector<unsigned> nedgein(n,0);
+  idx = 0;
+  for(nodelist_c_iter_t nit=allnodes.begin(); nit != allnodes.end(); ++nit, ++idx) {
+    const std::set<nodeid_t> &children = nit->second.successors;
+    for(typename std::set<nodeid_t>::const_iterator child = children.begin();
+        child != children.end(); ++child) {
+      unsigned cidx = allnodes.find(*child)->second.mark;
+      if(cidx != idx) {
+        adj[idx].push_back(cidx);
+        ++nedgein[cidx];
+      }
+    }
+  }
+  for(nodelist_c_iter_t nit=allnodes.begin(); nit != allnodes.end(); ++nit)
+    nit->second.mark = 0;
+
+  // Kahn's algorithm, using the output order as the queue of ready nodes
+  std::vector<unsigned> order;
+  order.reserve(n);
+  for(unsigned i=0; i<n; ++i)
+    if(nedgein[i] == 0)
+      order.push_back(i);
+  for(unsigned head=0; head < order.size(); ++head) {
+    const std::vector<unsigned> &children = adj[order[head]];
+    for(unsigned k=0; k<children.size(); ++k)
+      if(--nedgein[children[k]] == 0)
+        order.push_back(children[k]);
+  }
+  if(order.size() < n)
+    return false;
+
+  rank.resize(n);
+  for(unsigned r=0; r<n; ++r)
+    rank[order[r]] = r;
+
+  succ.assign(n, std::vector<unsigned>());
+  for(unsigned i=0; i<n; ++i) {
+    std::vector<unsigned> &si = succ[rank[i]];
+    si.reserve(adj[i].size());
+    for(unsigned k=0; k<adj[i].size(); ++k)
+      si.push_back(rank[adj[i][k]]);
+    std::sort(si.begin(), si.end());
+  }
+  return true;
+}
+
 template <class nodeid_t>
 void digraph<nodeid_t>::tcomplete(bmatrix &A, std::vector<nodeid_t> &nodeids) const
 {
@@ -1149,12 +1225,52 @@ void digraph<nodeid_t>::tcomplete(bmatrix &A, std::vector<nodeid_t> &nodeids) co
   int n = nodeids.size();
   A.resize(n,n);
 
-  for(int i=0; i<n; ++i)
+  std::vector<unsigned> rank;
+  std::vector<std::vector<unsigned> > succ;
+  if(!rank_order(rank, succ)) {
+    // cyclic graph:  search for each pair individually
+    for(int i=0; i<n; ++i)
+      for(int j=0; j<n; ++j)
+        if(is_descendant(nodeids[i],nodeids[j]))
+          A[i][j] = 1;
+        else
+          A[i][j] = 0;
+    return;
+  }
+
+  // The descendants of a node are the union of its successors and
+  // their descendants, all of which come later in the topological
+  // order.  Working backward through the order, each union is a
+  // series of word-wise ORs (which the compiler can vectorize).  The
+  // descendants of node s have ranks greater than s, so the words
+  // before the one containing s can be skipped.
+  const unsigned nword = (n+63)/64;
+  std::vector<uint64_t> reach(size_t(n)*nword, 0);
+  for(unsigned r=n; r-- > 0;) {
+    uint64_t *row = &reach[size_t(r)*nword];
+    const std::vector<unsigned> &sr = succ[r];
+    for(unsigned k=0; k<sr.size(); ++k) {
+      unsigned s = sr[k];
+      const uint64_t *srow = &reach[size_t(s)*nword];
+      for(unsigned w=s/64; w<nword; ++w)
+        row[w] |= srow[w];
+      row[s/64] |= uint64_t(1) << (s%64);
+    }
+  }
+
+  for(int i=0; i<n; ++i) {
+    const uint64_t *row = &reach[size_t(rank[i])*nword];
     for(int j=0; j<n; ++j)
-      if(is_descendant(nodeids[i],nodeids[j]))
-        A[i][j] = 1;
-      else
-        A[i][j] = 0;
+      A[i][j] = (row[rank[j]/64] >> (rank[j]%64)) & 1;
+  }
+
+  // rank_order ignores self edges, but a node with a self edge is its
+  // own descendant (as is_descendant finds in the cyclic case).
+  for(int i=0; i<n; ++i) {
+    const std::set<nodeid_t> &children = allnodes.find(nodeids[i])->second.successors;
+    if(children.find(nodeids[i]) != children.end())
+      A[i][i] = 1;
+  }
 }
 
 template <class nodeid_t>
@@ -1162,13 +1278,88 @@ digraph<nodeid_t> digraph<nodeid_t>::treduce(void) const
 {
   digraph<nodeid_t> Greduce(*this);
   Greduce.gtitle += "_transitive_reduction";
+
+  std::vector<unsigned> rank;
+  std::vector<std::vector<unsigned> > succ;
+  if(!rank_order(rank, succ)) {
+    Greduce.treduce_dfs();
+    return Greduce;
+  }
+
+  unsigned n = allnodes.size();
+  std::vector<nodeid_t> ids(n);
+  unsigned idx = 0;
+  for(nodelist_c_iter_t nit=allnodes.begin(); nit != allnodes.end(); ++nit, ++idx) {
+    ids[rank[idx]] = nit->first;
+    // self edges are never part of the reduction
+    if(nit->second.successors.find(nit->first) != nit->second.successors.end())
+      Greduce.deledge(nit->first, nit->first);
+  }
+
+  // An edge r->s is redundant if s can be reached through another
+  // successor of r.  Since a node is not its own descendant in an
+  // acyclic graph, that is the case exactly when s is in the union of
+  // the descendant sets of all of r's successors.  The descendant sets
+  // are computed as in tcomplete, but restricted to one block of
+  // target nodes at a time to bound the memory needed.  Only nodes
+  // ranked before the end of the block can reach into it.
+  const unsigned blockbits = 4096;
+  const unsigned nword = std::min(blockbits, (n+63)/64*64) / 64;
+  std::vector<uint64_t> reach(size_t(n)*nword);
+  std::vector<std::pair<unsigned,unsigned> > redundant;
+  for(unsigned c0=0; c0<n; c0 += blockbits) {
+    unsigned c1 = std::min(n, c0+blockbits);
+    for(unsigned r=c1; r-- > 0;) {
+      uint64_t *row = &reach[size_t(r)*nword];
+      std::fill(row, row+nword, 0);
+      const std::vector<unsigned> &sr = succ[r];
+      // successors are sorted by rank, so we can stop at the first
+      // one past the end of the block.
+      unsigned nsucc = std::lower_bound(sr.begin(), sr.end(), c1) - sr.begin();
+      for(unsigned k=0; k<nsucc; ++k) {
+        unsigned s = sr[k];
+        const uint64_t *srow = &reach[size_t(s)*nword];
+        for(unsigned w = s < c0 ? 0 : (s-c0)/64; w<nword; ++w)
+          row[w] |= srow[w];
+      }
+      for(unsigned k=0; k<nsucc; ++k) {
+        unsigned s = sr[k];
+        if(s >= c0) {
+          unsigned b = s-c0;
+          uint64_t mask = uint64_t(1) << (b%64);
+          if(row[b/64] & mask)
+            redundant.push_back(std::make_pair(r,s));
+        }
+      }
+      for(unsigned k=0; k<nsucc; ++k) {
+        unsigned s = sr[k];
+        if(s >= c0) {
+          unsigned b = s-c0;
+          row[b/64] |= uint64_t(1) << (b%64);
+        }
+      }
+    }
+  }
+
+  for(unsigned i=0; i<redundant.size(); ++i)
+    Greduce.deledge(ids[redundant[i].first], ids[redundant[i].second]);
+
+  return Greduce;
+}
+
+//! Transitive reduction by depth-first search 
+//! \details Reduces the graph in place.  Used for graphs with cycles,
+//! for which the reduction may not be unique. 
+template <class nodeid_t>
+void digraph<nodeid_t>::treduce_dfs(void)
+{
   // unmark all nodes
-  for(nodelist_iter_t nodeit=Greduce.allnodes.begin();
-      nodeit != Greduce.allnodes.end(); ++nodeit)
+  for(nodelist_iter_t nodeit=allnodes.begin();
+      nodeit != allnodes.end(); ++nodeit)
     nodeit->second.mark = 0;
   
   std::set<nodeid_t> srcnodes;
-  Greduce.find_all_sources(srcnodes);
+  find_all_sources(srcnodes);
   if(srcnodes.empty()) {
     std::cerr << "No source nodes in this graph => cyclic => transitive reduction may not be unique.\n";
     // we'll start with an arbitrary first node in the graph and see what happens
@@ -1176,9 +1367,8 @@ digraph<nodeid_t> digraph<nodeid_t>::treduce(void) const
   }
   for(typename std::set<nodeid_t>::iterator snodeit = srcnodes.begin();
       snodeit != srcnodes.end(); ++snodeit) {
-    Greduce.treduce_internal(*snodeit,*snodeit);
+    treduce_internal(*snodeit,*snodeit);
   }
-  return Greduce;
 }
 
 template <class nodeid_t>
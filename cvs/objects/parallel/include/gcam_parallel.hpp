@@ -38,6 +38,7 @@
 /* standard headers */
 #include <list>
 #include <set>
+#include <map>
 
 /* graph analysis headers */
 #include "parallel/include/digraph.hpp"
@@ -59,7 +60,9 @@ class GcamFlowGraph {
     friend class MarketDependencyFinder;
 private:
     //! Private constructor to only allow select classes to create flow graphs.
-    GcamFlowGraph() : mTBBFlowGraph(), mHead( mTBBFlowGraph ), mPeriod( 0 ), mCalcList( 0 ) {}
+    GcamFlowGraph() : mTBBFlowGraph(), mHead( mTBBFlowGraph ), mPeriod( 0 ), mCalcList( 0 ), mState( 0 ),
+                      mNumProfileCalls( 0 ), mNumProfiled( 0 ), mObservedTime( 0 ), mIsCostWeighted( false ),
+                      mPredictedCriticalPath( 0 ) {}
     
     //! The TBB calculation flow graph.
     tbb::flow::graph mTBBFlowGraph;
@@ -75,6 +78,40 @@ private:
     //! not be calculated for sub-graphs.  Note when null it implies all activities
     //! will be calculated.
     const std::vector<IActivity*>* mCalcList;
+    
+    //! The state slot of the thread which started the calculation that every
+    //! thread working on the graph must use.
+    double* mState;
+    
+    //! The activities in each grain in the order they are calculated.  The grains
+    //! are in topological order.  This is kept to be able to save the structure
+    //! of the graph and to predict the critical path once activity costs are known.
+    std::vector<std::vector<IActivity*> > mGrains;
+    
+    //! The indices into mGrains of the grains which depend on each grain.
+    std::vector<std::vector<size_t> > mGrainSuccessors;
+    
+    //! The number of remaining full model calculations for which the cost of each
+    //! activity should be measured.  Profiling is off when this is zero.
+    int mNumProfileCalls;
+    
+    //! The number of full model calculations which have been profiled so far.
+    int mNumProfiled;
+    
+    //! The total wall clock time in seconds of the profiled calculations.
+    double mObservedTime;
+    
+    //! The accumulated calc time in seconds for each activity during profiled
+    //! calculations.  All activities are inserted before the graph is run so
+    //! that threads only update the value of distinct entries.
+    mutable std::map<IActivity*, double> mActivityCost;
+    
+    //! If the grains of this graph were collected using measured activity costs.
+    bool mIsCostWeighted;
+    
+    //! The critical path in seconds predicted from the measured activity costs
+    //! used to collect the grains of this graph, if mIsCostWeighted.
+    double mPredictedCriticalPath;
 };
 
 /*!
@@ -94,18 +131,44 @@ public:
     //! Flow graph of calc vertex dependencies for parallel analysis
     typedef digraph<FlowGraphNodeType> FlowGraph;
     
+    //! Map of the measured cost of each vertex in seconds
+    typedef std::map<FlowGraphNodeType, double> ActivityCostMap;
+    
+    //! The vertices of each grain in calculation order
+    typedef std::vector<std::vector<FlowGraphNodeType> > GrainList;
+    
+    //! The indices of the successors of each grain
+    typedef std::vector<std::vector<size_t> > GrainSuccessorList;
+    
     GcamParallel();
     
+    //! Get the grain size target which affects how activities are collected into grains.
+    int getGrainSizeTarget() const { return mGrainSizeTarget; }
+    
     /* Graph analysis and parsing methods */
     void makeGCAMFlowGraph( const MarketDependencyFinder& aDependencyFinder, FlowGraph& aGCAMFlowGraph );
     
-    void graphParseGrainCollect( const FlowGraph& aGCAMFlowGraph, FlowGraph& aGrainGraph );
+    void graphParseGrainCollect( const FlowGraph& aGCAMFlowGraph, FlowGraph& aGrainGraph,
+                                 const ActivityCostMap* aActivityCosts = 0 );
     
     void graphParseGrainCollect( const FlowGraph& aGCAMFlowGraph, FlowGraph& aGrainGraph,
                                  const std::vector<FlowGraphNodeType>& aCalcItems );
     
     void makeTBBFlowGraph( const FlowGraph& aGrainGraph, const FlowGraph& aTopology,
                            GcamFlowGraph& aTBBGraph );
+    
+    void makeTBBFlowGraph( const GrainList& aGrains, const GrainSuccessorList& aGrainSuccessors,
+                           GcamFlowGraph& aTBBGraph );
+    
+    void startProfiling( GcamFlowGraph& aTBBGraph ) const;
+    
+    void regrainFromProfile( const FlowGraph& aGCAMFlowGraph, const GcamFlowGraph& aProfiledGraph,
+                             GcamFlowGraph& aTBBGraph );
+    
+    static bool finishProfiledCalc( GcamFlowGraph& aTBBGraph, const double aWallTime );
+    
+    static double predictCriticalPath( const GcamFlowGraph& aTBBGraph, const ActivityCostMap& aActivityCosts,
+                                       double& aTotalWork );
   
 protected:
     //! Helper class for sorting lists in topological order
@@ -127,14 +190,13 @@ protected:
      * place a bunch of these into a tbb::flow::graph structure, and TBB
      * will take care of the dispatch.  What this structure has to do is
      * to provide a way to execute the calculation vertices in the
-     * topologically correct order.  We do that by taking in the set of
-     * vertices and the graph structure that defines the topology.  From
-     * that we can create a list that is sorted in topological order.
-     * After that, the body struct no longer needs the graph.
+     * topologically correct order.  We do that by taking in the
+     * vertices already sorted in topological order, either using the
+     * graph structure that defines the topology or as they were saved
+     * from a previous run.
      */
     struct TBBFlowGraphBody {
-        TBBFlowGraphBody( const std::set<FlowGraphNodeType>& aNodes, const FlowGraph& aTopology,
-                          const GcamFlowGraph& aGraph );
+        TBBFlowGraphBody( const std::vector<FlowGraphNodeType>& aNodes, const GcamFlowGraph& aGraph );
         
         void operator()( tbb::flow::continue_msg aMessage );
 
@@ -161,8 +223,14 @@ protected:
     //! Default grain size
     static const int DEFAULT_GRAIN_SIZE;
     
-    // right now, grain size is the only parameter in the heuristics.
-    // We may add more later.
+    /*!
+     * \brief The number of full model calculations to profile
+     * \details When positive the calc time of each activity is measured for this
+     *          many calculations of the full model flow graph after which the
+     *          grains are collected again using the measured costs.  The default
+     *          of zero disables profiling.
+     */
+    int mNumProfileCalls;
 };
 
   
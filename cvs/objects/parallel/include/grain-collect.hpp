@@ -37,6 +37,8 @@
 #include "parallel/include/clanid.hpp"
 #include "parallel/include/bitvector.hpp"
 #include <sstream>
+#include <map>
+#include <cmath>
 
 template<class T> T* unique_nodetitle(T* bestnode, size_t setsize)
 {
@@ -109,11 +111,46 @@ nodeid_t grain_title(const bitvector &nodeset, const digraph<nodeid_t> &topology
 }
 
 
+/* Compute the weight of a set of nodes for the purposes of grain sizing
+ *
+ * Without node weights every node counts as one, so the weight is just
+ * the size of the set.  Otherwise it is the sum of the weights of the
+ * member nodes, looked up by their id in the topology.  Nodes missing
+ * from the weight table count as one.
+ */
+template<class nodeid_t>
+double nodeset_weight(const bitvector &nodeset, const digraph<nodeid_t> &topology,
+                      const std::map<nodeid_t, double> *node_weights)
+{
+  if(!node_weights)
+    return nodeset.count();
+
+  double weight = 0.0;
+  bitvector_iterator nodeit(&nodeset);
+  while(nodeit.next()) {
+    typename std::map<nodeid_t, double>::const_iterator wt =
+      node_weights->find(topology.topological_lookup(nodeit.bindex()));
+    weight += wt != node_weights->end() ? wt->second : 1.0;
+  }
+  return weight;
+}
+
+
+/* Collect the nodes of a clan into grains
+ *
+ * The grain_min target is measured in node weight (see
+ * nodeset_weight).  When no node_weights are given every node has
+ * unit weight and grain_min is simply the target number of nodes.
+ * When weights are given they should be scaled so that the average
+ * node has unit weight, so that grain_min keeps roughly the same
+ * meaning while expensive nodes end up in smaller grains.
+ */
 template<class nodeid_t>
 void grain_collect(const digraph<clanid<nodeid_t> > &ClanTree,
                    const typename digraph<clanid<nodeid_t> >::nodelist_c_iter_t &claniterator,
                    digraph <nodeid_t> &GrainGraph,
-                   unsigned grain_min)
+                   unsigned grain_min,
+                   const std::map<nodeid_t, double> *node_weights = 0)
 {
   // define the clanid type
   typedef clanid<nodeid_t> Clanid;
@@ -146,10 +183,10 @@ void grain_collect(const digraph<clanid<nodeid_t> > &ClanTree,
     {
     for(typename std::set<Clanid>::const_iterator subclan = claniterator->second.successors.begin();
         subclan != claniterator->second.successors.end(); ++subclan) {
-      unsigned nsub = subclan->nodes().count();
+      double nsub = nodeset_weight(subclan->nodes(), topology, node_weights);
       // search large subclans for grains
       if(nsub >= grain_min)
-        grain_collect(ClanTree, ClanTree.nodelist().find(*subclan), GrainGraph, grain_min);
+        grain_collect(ClanTree, ClanTree.nodelist().find(*subclan), GrainGraph, grain_min, node_weights);
       else
         node_group.setunion(subclan->nodes());
     }
@@ -160,8 +197,8 @@ void grain_collect(const digraph<clanid<nodeid_t> > &ClanTree,
     // exactly, since we don't know the distribution of the sizes of
     // the leftover clans.  We'll guess that they're pretty uniform
     // and build heuristics around that.
-    int nnode = node_group.count(); // cache the number of nodes in the group.  Be careful to update whenever we change the group membership!
-    int nbreakup = nnode / grain_min;
+    double nnode = nodeset_weight(node_group, topology, node_weights); // cache the weight of the group.  Be careful to update whenever we change the group membership!
+    int nbreakup = int(nnode / grain_min);
     if(nbreakup < 2 && nnode >= ind_split_min )
       // fudge the minimum grain size a little for extra parallelism.
       // It was probably just a guess anyhow.
@@ -169,19 +206,24 @@ void grain_collect(const digraph<clanid<nodeid_t> > &ClanTree,
 
     if(nbreakup > 1) {
       // this will be the approximate size of the new grains we will make.
-      unsigned grain_size_thresh = nnode / nbreakup;
+      double grain_size_thresh = std::floor(nnode / nbreakup);
+      double group_weight = 0.0;
       node_group.clearall();       // nnode no lonber valid!
       for(typename std::set<Clanid>::const_iterator subclan = claniterator->second.successors.begin();
-          subclan != claniterator->second.successors.end(); ++subclan)
-        if(subclan->nodes().count() < grain_min) { // skip the ones that were already processed above
+          subclan != claniterator->second.successors.end(); ++subclan) {
+        double subweight = nodeset_weight(subclan->nodes(), topology, node_weights);
+        if(subweight < grain_min) { // skip the ones that were already processed above
           node_group.setunion(subclan->nodes());
-          if(node_group.count() >= grain_size_thresh) {
+          group_weight += subweight;
+          if(group_weight >= grain_size_thresh) {
             // have enough for a grain
             grain_name = grain_title(node_group, topology);
             GrainGraph.collapse_subgraph(topology.convert_to_set(node_group), grain_name);
             node_group.clearall();   // start the next grain
+            group_weight = 0.0;
           }
         }
+      }
     }
     
     if(!node_group.empty()) {
@@ -213,7 +255,7 @@ void grain_collect(const digraph<clanid<nodeid_t> > &ClanTree,
     for(typename std::set<Clanid>::const_iterator subclan = claniterator->second.successors.begin();
         subclan != claniterator->second.successors.end(); ++subclan) {
       if( (subclan->type == independent || subclan->type == pseudoindependent) &&
-          subclan->nodes().count() >= ind_split_min ) {
+          nodeset_weight(subclan->nodes(), topology, node_weights) >= ind_split_min ) {
         // only recurse on independent clans that are guaranteed to
         // split (an independent could split with as few as
         // grain_min+1 clans, but it's not guaranteed and rarely
@@ -226,7 +268,7 @@ void grain_collect(const digraph<clanid<nodeid_t> > &ClanTree,
           node_group.clearall();   // start the next grain
         }
         // then recurse on the subclan
-        grain_collect(ClanTree, ClanTree.nodelist().find(*subclan), GrainGraph, grain_min);
+        grain_collect(ClanTree, ClanTree.nodelist().find(*subclan), GrainGraph, grain_min, node_weights);
       }
       else {
         // add this clan's nodes to the node group
@@ -32,6 +32,7 @@
 
 #if GCAM_PARALLEL_ENABLED
 #include <map>
+#include <tbb/tick_count.h>
 /* gcam headers */
 #include "parallel/include/gcam_parallel.hpp"
 #include "util/base/include/configuration.h"
@@ -41,6 +42,7 @@
 #include "util/logger/include/ilogger.h"
 #include "util/base/include/timer.h"
 #include "util/base/include/auto_file.h"
+#include "util/base/include/manage_state_variables.hpp"
 /* more graph analysis headers */
 #include "parallel/include/clanid.hpp"
 #include "parallel/include/graph-parse.hpp"
@@ -64,7 +66,9 @@ const int GcamParallel::DEFAULT_GRAIN_SIZE = 30;
  */
 GcamParallel::GcamParallel()
 {
-    mGrainSizeTarget = Configuration::getInstance()->getInt( "parallel-grain-size", DEFAULT_GRAIN_SIZE );
+    const Configuration* conf = Configuration::getInstance();
+    mGrainSizeTarget = conf->getInt( "parallel-grain-size", DEFAULT_GRAIN_SIZE );
+    mNumProfileCalls = conf->getInt( "parallel-grain-profile-calls", 0 );
 }
   
 
@@ -158,8 +162,13 @@ void GcamParallel::makeGCAMFlowGraph( const MarketDependencyFinder& aDependencyF
  * \param[in] aGCAMFlowGraph: The gcam flow graph generated by makeGCAMFlowGraph 
  * \param[out] aGrainGraph: The graph of computational grains.  On input it
  *                          should be empty. 
+ * \param[in] aActivityCosts: Optionally the measured cost of each activity in
+ *                            which case grains are sized by cost rather than by
+ *                            the number of activities.  Null to treat every
+ *                            activity as equal cost.
  */
-void GcamParallel::graphParseGrainCollect( const FlowGraph& aGCAMFlowGraph, FlowGraph& aGrainGraph )
+void GcamParallel::graphParseGrainCollect( const FlowGraph& aGCAMFlowGraph, FlowGraph& aGrainGraph,
+                                           const ActivityCostMap* aActivityCosts )
 {
     // some intermediate types involving "clans".  These will hold the
     // intermediate results of the parsing.
@@ -186,7 +195,32 @@ void GcamParallel::graphParseGrainCollect( const FlowGraph& aGCAMFlowGraph, Flow
     // with a copy of the node graph.
     graintimer.start();
     FlowGraph grainGraphTemp = gcamFGReduce;
-    grain_collect( parseTree, parseTree.nodelist().begin(), grainGraphTemp, mGrainSizeTarget );
+    if( aActivityCosts ) {
+        // Scale the costs so the average activity has a weight of one so that the
+        // grain size target keeps its meaning.  Activities which measured as free
+        // still have some dispatch overhead so we do not let any weight go to zero.
+        const double MIN_WEIGHT = 0.01;
+        double totalCost = 0;
+        for( FlowGraph::nodelist_c_iter_t nodeIt = gcamFGReduce.nodelist().begin();
+             nodeIt != gcamFGReduce.nodelist().end(); ++nodeIt )
+        {
+            ActivityCostMap::const_iterator costIt = aActivityCosts->find( nodeIt->first );
+            totalCost += costIt != aActivityCosts->end() ? costIt->second : 0.0;
+        }
+        const double meanCost = totalCost / gcamFGReduce.nodelist().size();
+        ActivityCostMap weights;
+        for( FlowGraph::nodelist_c_iter_t nodeIt = gcamFGReduce.nodelist().begin();
+             nodeIt != gcamFGReduce.nodelist().end(); ++nodeIt )
+        {
+            ActivityCostMap::const_iterator costIt = aActivityCosts->find( nodeIt->first );
+            double cost = costIt != aActivityCosts->end() ? costIt->second : 0.0;
+            weights[ nodeIt->first ] = meanCost > 0 ? max( cost / meanCost, MIN_WEIGHT ) : 1.0;
+        }
+        grain_collect( parseTree, parseTree.nodelist().begin(), grainGraphTemp, mGrainSizeTarget, &weights );
+    }
+    else {
+        grain_collect( parseTree, parseTree.nodelist().begin(), grainGraphTemp, mGrainSizeTarget );
+    }
     
     // set the output graph to the transitive reduction of what came out of the
     // grain collection algorithm.
@@ -249,104 +283,285 @@ void GcamParallel::graphParseGrainCollect( const FlowGraph& aGCAMFlowGraph, Flow
  */
 void GcamParallel::makeTBBFlowGraph( const FlowGraph& aGrainGraph, const FlowGraph& aTopology,
                                      GcamFlowGraph& aTBBGraph )
+{
+    if( !aTopology.topology_valid() ) {
+        ILogger& pgLog = ILogger::getLogger( "parallel-grain-log" );
+        pgLog.setLevel( ILogger::SEVERE );
+        pgLog << "Creating tbbfg_body with invalid topology." << endl;
+        abort();
+    }
+    
+    // Number the grains in topological order and, for each, find the nodes from
+    // the original graph that are in it.  We have to extract them from the subgraph
+    // contained in the node, which is a little ugly.  That subgraph has the
+    // information we need to order the nodes without carrying an otherwise
+    // superfluous topology graph any further.
+    const vector<FlowGraphNodeType>& grainOrder = aGrainGraph.topological_sort();
+    map<FlowGraphNodeType, size_t> grainIndex;
+    GrainList grains( grainOrder.size() );
+    for( size_t i = 0; i < grainOrder.size(); ++i ) {
+        grainIndex[ grainOrder[ i ] ] = i;
+        const FlowGraph::node_t& grainNode = aGrainGraph.getnode( grainOrder[ i ] );
+        if( grainNode.subgraph ) {
+            getkeys( grainNode.subgraph->nodelist(), grains[ i ] );
+        }
+        else {
+            grains[ i ].push_back( grainOrder[ i ] );
+        }
+        sort( grains[ i ].begin(), grains[ i ].end(), TopologicalComparator( aTopology ) );
+    }
+    
+    GrainSuccessorList grainSuccessors( grainOrder.size() );
+    for( size_t i = 0; i < grainOrder.size(); ++i ) {
+        const set<FlowGraphNodeType>& children = aGrainGraph.getnode( grainOrder[ i ] ).successors;
+        for( set<FlowGraphNodeType>::const_iterator cnodeIt = children.begin();
+             cnodeIt != children.end(); ++cnodeIt )
+        {
+            grainSuccessors[ i ].push_back( grainIndex[ *cnodeIt ] );
+        }
+    }
+    
+    makeTBBFlowGraph( grains, grainSuccessors, aTBBGraph );
+}
+
+/*!
+ * \brief Build the TBB flow graph for a list of grains 
+ * \details This performs the same function as the version which takes the grain
+ *          graph, however the structure of the grains is given directly.  This
+ *          allows a flow graph to be built from a grain structure saved by a
+ *          previous run.
+ * \param[in] aGrains: The activities of each grain in the order they must be
+ *                     calculated.  The grains must be in topological order.
+ * \param[in] aGrainSuccessors: The indices of the grains which depend on each
+ *                              grain.
+ * \param[inout] aTBBGraph: The class that will hold the flow graph nodes.  On
+ *             input it should be default-constructed.
+ */
+void GcamParallel::makeTBBFlowGraph( const GrainList& aGrains, const GrainSuccessorList& aGrainSuccessors,
+                                     GcamFlowGraph& aTBBGraph )
 {
     using tbb::flow::continue_node;
     using tbb::flow::continue_msg;
     
     tbb::flow::graph& tbbFlowGraph = aTBBGraph.mTBBFlowGraph;
     tbb::flow::broadcast_node<tbb::flow::continue_msg>& head = aTBBGraph.mHead;
+    aTBBGraph.mGrains = aGrains;
+    aTBBGraph.mGrainSuccessors = aGrainSuccessors;
     
     ILogger& pgLog = ILogger::getLogger( "parallel-grain-log" );
     pgLog.setLevel( ILogger::NOTICE );
     
-    // We need a place to stash all of the TBB flow graph nodes, and we need to be
-    // able to find them from the node identifiers.
-    map<FlowGraphNodeType, continue_node<continue_msg>* > nodeTable;
-    map<FlowGraphNodeType, int> nodeSizeTable;
-    
     // The TBB flow graph structures don't automatically create nodes, so we'll do
     // two passes, creating nodes on the first and connecting them on the second.
-    for( FlowGraph::nodelist_c_iter_t gnodeIt = aGrainGraph.nodelist().begin();
-         gnodeIt != aGrainGraph.nodelist().end(); ++gnodeIt )
-    {
-        // Find the nodes from the original graph that are in this node.  We have to
-        // extract them from the subgraph contained in the node, which is a little
-        // ugly.  That subgraph has the information we need to order the nodes
-        // without carrying an otherwise superfluous topology graph down into this
-        // function.  Thus, this should be a prime candidate for refactoring.
-        set<FlowGraphNodeType> subGraphNodes;
-        getkeys( gnodeIt->second.subgraph->nodelist(), subGraphNodes );
-        
-        // create the node for this grain.  Note that the tbbfg_body constructor
-        // uses the topology to order the elements of the grain, but does not store
-        // a reference.
-        size_t nodeSize = subGraphNodes.size();
-        nodeTable[ gnodeIt->first ] = new continue_node<continue_msg>( tbbFlowGraph,
-            TBBFlowGraphBody( subGraphNodes, aTopology, aTBBGraph ) );
-        nodeSizeTable[ gnodeIt->first ] = nodeSize;
-        pgLog << "\tContinue node: " << nodeTable[ gnodeIt->first ] << endl;
+    vector<continue_node<continue_msg>*> nodeTable( aGrains.size() );
+    for( size_t i = 0; i < aGrains.size(); ++i ) {
+        nodeTable[ i ] = new continue_node<continue_msg>( tbbFlowGraph,
+            TBBFlowGraphBody( aGrains[ i ], aTBBGraph ) );
+        pgLog << "\tContinue node: " << nodeTable[ i ] << endl;
     }
     
     // In the second pass, connect edges in the nodes we just created.
     // This will make the TBB flow graph isomorphic to the grain graph.
-    for( FlowGraph::nodelist_c_iter_t gnodeIt= aGrainGraph.nodelist().begin();
-         gnodeIt != aGrainGraph.nodelist().end(); ++gnodeIt )
-    {
-        // get the children of each node in the flow graph
-        set<FlowGraphNodeType> children = gnodeIt->second.successors;
-        for( set<FlowGraphNodeType>::const_iterator cnodeIt = children.begin();
-             cnodeIt != children.end(); ++cnodeIt )
+    // Any grain that is not the successor of another is a source node which
+    // we connect to the TBB broadcast node.
+    vector<bool> hasParent( aGrains.size(), false );
+    for( size_t i = 0; i < aGrains.size(); ++i ) {
+        for( vector<size_t>::const_iterator childIt = aGrainSuccessors[ i ].begin();
+             childIt != aGrainSuccessors[ i ].end(); ++childIt )
         {
-            // find the TBB flow graph nodes for the grain graph node and
-            // the child node.  Connect them in the TBB flow graph.
-            tbb::flow::make_edge( *nodeTable[ gnodeIt->first ], *nodeTable[ *cnodeIt ] );
-            pgLog << nodeTable[ gnodeIt->first ] << "_" << nodeSizeTable[ gnodeIt->first ]
-                << " -> " << nodeTable[ *cnodeIt ] << "_" << nodeSizeTable[ *cnodeIt ] << endl;
+            tbb::flow::make_edge( *nodeTable[ i ], *nodeTable[ *childIt ] );
+            hasParent[ *childIt ] = true;
+            pgLog << nodeTable[ i ] << "_" << aGrains[ i ].size()
+                << " -> " << nodeTable[ *childIt ] << "_" << aGrains[ *childIt ].size() << endl;
         }
     }
-    
-    // Find the source nodes and connect the TBB broadcast node to all of them.
-    set<FlowGraphNodeType> sources;
-    aGrainGraph.find_all_sources( sources );
-    for( set<FlowGraphNodeType>::const_iterator srcIt = sources.begin();
-         srcIt != sources.end(); ++srcIt )
-    {
-        tbb::flow::make_edge( head, *nodeTable[ *srcIt ] );
-        pgLog << "start node found:  " << nodeTable[ *srcIt ] << "_" << nodeSizeTable[ *srcIt ] << endl;
+    for( size_t i = 0; i < aGrains.size(); ++i ) {
+        if( !hasParent[ i ] ) {
+            tbb::flow::make_edge( head, *nodeTable[ i ] );
+            pgLog << "start node found:  " << nodeTable[ i ] << "_" << aGrains[ i ].size() << endl;
+        }
     }
     // TBB flow graph is ready to go.
 }
 
+/*!
+ * \brief Turn on profiling of the activity costs for a newly built flow graph.
+ * \details If parallel-grain-profile-calls is positive the calc time of each
+ *          activity will be measured for that many calculations of the full
+ *          graph.  The caller should then pass the wall clock time of each of
+ *          those calculations to finishProfiledCalc.  This does nothing if
+ *          profiling is not enabled.
+ * \param[inout] aTBBGraph: The flow graph to profile.
+ */
+void GcamParallel::startProfiling( GcamFlowGraph& aTBBGraph ) const
+{
+    if( mNumProfileCalls <= 0 ) {
+        return;
+    }
+    
+    aTBBGraph.mNumProfileCalls = mNumProfileCalls;
+    aTBBGraph.mNumProfiled = 0;
+    aTBBGraph.mObservedTime = 0;
+    aTBBGraph.mActivityCost.clear();
+    for( GrainList::const_iterator grainIt = aTBBGraph.mGrains.begin(); grainIt != aTBBGraph.mGrains.end(); ++grainIt ) {
+        for( vector<FlowGraphNodeType>::const_iterator nodeIt = grainIt->begin(); nodeIt != grainIt->end(); ++nodeIt ) {
+            aTBBGraph.mActivityCost[ *nodeIt ] = 0.0;
+        }
+    }
+}
+
+/*!
+ * \brief Collect grains again using the activity costs measured while running
+ *        a profiled flow graph.
+ * \details The new graph is itself profiled for the same number of calculations
+ *          so that the critical path predicted from the measured costs can be
+ *          compared to what is actually observed.
+ * \param[in] aGCAMFlowGraph: The gcam flow graph generated by makeGCAMFlowGraph
+ * \param[in] aProfiledGraph: The flow graph which has finished profiling.
+ * \param[inout] aTBBGraph: The flow graph to build.  On input it should be
+ *                          default-constructed.
+ */
+void GcamParallel::regrainFromProfile( const FlowGraph& aGCAMFlowGraph, const GcamFlowGraph& aProfiledGraph,
+                                       GcamFlowGraph& aTBBGraph )
+{
+    // Use the average cost per calculation.
+    ActivityCostMap costs = aProfiledGraph.mActivityCost;
+    for( ActivityCostMap::iterator costIt = costs.begin(); costIt != costs.end(); ++costIt ) {
+        costIt->second /= max( aProfiledGraph.mNumProfiled, 1 );
+    }
+    
+    FlowGraph grainGraph;
+    graphParseGrainCollect( aGCAMFlowGraph, grainGraph, &costs );
+    makeTBBFlowGraph( grainGraph, aGCAMFlowGraph, aTBBGraph );
+    
+    double totalWork = 0;
+    aTBBGraph.mIsCostWeighted = true;
+    aTBBGraph.mPredictedCriticalPath = predictCriticalPath( aTBBGraph, costs, totalWork );
+    startProfiling( aTBBGraph );
+    
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Collected " << aTBBGraph.mGrains.size() << " grains weighted by activity cost, was "
+            << aProfiledGraph.mGrains.size() << "." << endl;
+}
+
+/*!
+ * \brief Record a profiled calculation of the full flow graph and report on the
+ *        critical path once profiling is complete.
+ * \details The report compares the critical path predicted from the measured
+ *          activity costs with the observed wall clock time of a calculation.
+ *          For a graph whose grains were collected by cost the prediction is the
+ *          one made from the costs used to collect them.
+ * \param[inout] aTBBGraph: The flow graph which was just calculated.
+ * \param[in] aWallTime: The wall clock time in seconds the calculation took.
+ * \return True if profiling just finished on a graph whose grains should now
+ *         be collected again using the measured costs.
+ */
+bool GcamParallel::finishProfiledCalc( GcamFlowGraph& aTBBGraph, const double aWallTime ) {
+    aTBBGraph.mObservedTime += aWallTime;
+    ++aTBBGraph.mNumProfiled;
+    if( --aTBBGraph.mNumProfileCalls > 0 ) {
+        return false;
+    }
+    
+    ActivityCostMap costs = aTBBGraph.mActivityCost;
+    for( ActivityCostMap::iterator costIt = costs.begin(); costIt != costs.end(); ++costIt ) {
+        costIt->second /= aTBBGraph.mNumProfiled;
+    }
+    double totalWork = 0;
+    const double measuredCriticalPath = predictCriticalPath( aTBBGraph, costs, totalWork );
+    const double observed = aTBBGraph.mObservedTime / aTBBGraph.mNumProfiled;
+    
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Flow graph profile of " << aTBBGraph.mNumProfiled << " calculations with "
+            << ( aTBBGraph.mIsCostWeighted ? "cost weighted" : "fixed size" ) << " grains:" << endl;
+    mainLog << "\tTotal activity time: " << totalWork << " s" << endl;
+    if( aTBBGraph.mIsCostWeighted ) {
+        mainLog << "\tPredicted critical path: " << aTBBGraph.mPredictedCriticalPath << " s" << endl;
+    }
+    mainLog << "\tMeasured critical path: " << measuredCriticalPath << " s" << endl;
+    mainLog << "\tObserved time per calculation: " << observed << " s" << endl;
+    if( measuredCriticalPath > 0 && observed > 0 ) {
+        mainLog << "\tAvailable parallelism: " << totalWork / measuredCriticalPath
+                << ", achieved: " << totalWork / observed << endl;
+    }
+    return !aTBBGraph.mIsCostWeighted;
+}
+
+/*!
+ * \brief Compute the longest path through the grains of a flow graph given the
+ *        cost of each activity.
+ * \details The cost of a grain is the sum of the costs of the activities in it
+ *          as they are calculated serially.
+ * \param[in] aTBBGraph: The flow graph.
+ * \param[in] aActivityCosts: The cost of each activity.
+ * \param[out] aTotalWork: The sum of the cost of all grains.
+ * \return The cost of the most expensive path through the graph.
+ */
+double GcamParallel::predictCriticalPath( const GcamFlowGraph& aTBBGraph, const ActivityCostMap& aActivityCosts,
+                                          double& aTotalWork )
+{
+    aTotalWork = 0;
+    double criticalPath = 0;
+    // The cost of the most expensive path which must be completed before each grain
+    // can start.  Grains are in topological order so it is final once we get to it.
+    vector<double> startCost( aTBBGraph.mGrains.size(), 0.0 );
+    for( size_t i = 0; i < aTBBGraph.mGrains.size(); ++i ) {
+        double grainCost = 0;
+        for( vector<FlowGraphNodeType>::const_iterator nodeIt = aTBBGraph.mGrains[ i ].begin();
+             nodeIt != aTBBGraph.mGrains[ i ].end(); ++nodeIt )
+        {
+            ActivityCostMap::const_iterator costIt = aActivityCosts.find( *nodeIt );
+            grainCost += costIt != aActivityCosts.end() ? costIt->second : 0.0;
+        }
+        aTotalWork += grainCost;
+        
+        const double pathCost = startCost[ i ] + grainCost;
+        for( vector<size_t>::const_iterator childIt = aTBBGraph.mGrainSuccessors[ i ].begin();
+             childIt != aTBBGraph.mGrainSuccessors[ i ].end(); ++childIt )
+        {
+            startCost[ *childIt ] = max( startCost[ *childIt ], pathCost );
+        }
+        criticalPath = max( criticalPath, pathCost );
+    }
+    return criticalPath;
+}
+
 void GcamParallel::TBBFlowGraphBody::operator()( tbb::flow::continue_msg aMessage )
 {
+    // Calculate in the same state as the thread which started the graph as this
+    // thread may otherwise be using a different "scratch" state.
+    double* prevState = ManageStateVariables::setThreadState( mGraph.mState );
+    // Only full calculations are profiled.
+    const bool isProfiling = mGraph.mNumProfileCalls > 0 && !mGraph.mCalcList;
     for( list<FlowGraphNodeType>::const_iterator nodeIt = mNodes.begin();
          nodeIt != mNodes.end(); ++nodeIt )
     {
-        if( !mGraph.mCalcList ||
+        if( isProfiling ) {
+            tbb::tick_count start = tbb::tick_count::now();
+            (*nodeIt)->calc( mGraph.mPeriod );
+            // Each activity is only in one grain so no other thread will update
+            // this entry.
+            mGraph.mActivityCost.find( *nodeIt )->second += ( tbb::tick_count::now() - start ).seconds();
+        }
+        else if( !mGraph.mCalcList ||
             find( mGraph.mCalcList->begin(), mGraph.mCalcList->end(), *nodeIt ) != mGraph.mCalcList->end() )
         {
             (*nodeIt)->calc( mGraph.mPeriod );
         }
     }
+    ManageStateVariables::setThreadState( prevState );
 }
 
-GcamParallel::TBBFlowGraphBody::TBBFlowGraphBody( const std::set<FlowGraphNodeType>& aNodes,
-                                                  const FlowGraph& aTopology,
+GcamParallel::TBBFlowGraphBody::TBBFlowGraphBody( const vector<FlowGraphNodeType>& aNodes,
                                                   const GcamFlowGraph& aGraph )
-:mGraph( aGraph )
+:mNodes( aNodes.begin(), aNodes.end() ),
+mGraph( aGraph )
 {
     ILogger& pgLog = ILogger::getLogger( "parallel-grain-log" );
     pgLog.setLevel( ILogger::NOTICE );
     
-    if( !aTopology.topology_valid() ) {
-        pgLog.setLevel( ILogger::SEVERE );
-        pgLog << "Creating tbbfg_body with invalid topology." << endl;
-        abort();
-    }
-    
-    mNodes.insert( mNodes.end(), aNodes.begin(), aNodes.end() );
-    mNodes.sort( TopologicalComparator( aTopology ) );
-    
     // log some output to allow us to analyze the parallel grain
     // structure (this allows us to see what is in the grains, but not
     // the relationships between grains)
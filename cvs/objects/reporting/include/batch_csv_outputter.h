@@ -59,6 +59,8 @@ class BatchCSVOutputter : public DefaultVisitor {
 public:
     BatchCSVOutputter();
 
+    explicit BatchCSVOutputter( const std::string& aFileName );
+
     ~BatchCSVOutputter();
 
     void writeDidScenarioSolve( bool aDidSolve );
@@ -68,6 +68,20 @@ mIsFirstScenario(true)
 {
 }
 
+/*!
+ * \brief Constructor which writes to the given file rather than the one set in
+ *        the configuration.
+ * \details This is used when batch scenarios are run concurrently and each one
+ *          writes its results to a separate file which are combined once all
+ *          scenarios have finished.
+ * \param aFileName The name of the file to write to.
+ */
+BatchCSVOutputter::BatchCSVOutputter( const string& aFileName ):
+mFile( aFileName ),
+mIsFirstScenario(true)
+{
+}
+
 /*!
  * \brief Destructor
  */
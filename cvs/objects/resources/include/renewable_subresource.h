@@ -102,5 +102,6 @@ protected:
 
     virtual const std::string& getXMLName() const;
     virtual bool XMLDerivedClassParse( const std::string& nodeName, const xercesc::DOMNode* node );
+    virtual void initSupplyCurve( const int aPeriod );
 };
 #endif // _RENEWABLE_SUBRESOURCE_H_
@@ -54,6 +54,7 @@
 
 // Forward declaration.
 class SubResource;
+class CachedMarket;
 
 /*! 
 * \ingroup Objects
@@ -113,6 +114,10 @@ protected:
     //! Vector of object meta info to pass to the market
     object_meta_info_vector_type mObjectMetaInfo;
 
+    //! A pre-located market which has been cached from the marketplace to get
+    //! the price of this resource during calcSupply.
+    std::auto_ptr<CachedMarket> mCachedMarket;
+
     virtual bool XMLDerivedClassParse( const std::string& aNodeName,
                                        const xercesc::DOMNode* aNode );
     virtual const std::string& getXMLName() const;
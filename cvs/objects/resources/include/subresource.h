@@ -103,9 +103,36 @@ public:
     virtual void accept( IVisitor* aVisitor, const int aPeriod ) const;
     virtual double getLowestPrice( const int aPeriod ) const;
     virtual double getHighestPrice( const int aPeriod ) const;
+    double getSupplyCurveSlope( const int aPeriod ) const;
 protected:
+    /*!
+     * \brief The grades of a single period flattened into a piecewise linear
+     *        supply curve.
+     * \details Built once per period in initCalc so that evaluating the supply
+     *          at a price is a binary search and an interpolation rather than a
+     *          walk over the grades.  The quantity is zero at or below the first
+     *          cost, interpolated between costs, and mMaxQuantity above the last.
+     */
+    struct SupplyCurveTable {
+        SupplyCurveTable();
+
+        double getQuantity( const double aPrice ) const;
+
+        double getSlope( const double aPrice ) const;
+
+        //! The cost of each point on the curve in increasing order.
+        std::vector<double> mCost;
+
+        //! The quantity supplied at each point on the curve.
+        std::vector<double> mQuantity;
+
+        //! The quantity supplied at prices above the last cost.
+        double mMaxQuantity;
+    };
+
     virtual const std::string& getXMLName() const;
     virtual bool XMLDerivedClassParse( const std::string& nodeName, const xercesc::DOMNode* node );
+    virtual void initSupplyCurve( const int aPeriod );
 
     DEFINE_DATA(
         /* Declare all subclasses of SubResource to allow automatic traversal of the
@@ -152,6 +179,9 @@ protected:
     
     //!< The subsector's information store.
     std::auto_ptr<IInfo> mSubresourceInfo;
+
+    //! The supply curve by period as computed from the grades in initCalc.
+    objects::PeriodVector<SupplyCurveTable> mSupplyCurve;
 };
 
 #endif // _SUBRESOURCE_H_
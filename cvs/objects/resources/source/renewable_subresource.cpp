@@ -130,6 +130,25 @@ void SubRenewableResource::completeInit( const string& aRegionName, const string
     }
 }
 
+/*!
+ * \brief Build the supply curve for the given period from the grades.
+ * \details The grades of a renewable resource are points on a cost curve of
+ *          price and cumulative fraction available so they are used directly.
+ *          The fraction available is zero below the first point and stays at the
+ *          fraction available of the last point above it.
+ * \param aPeriod Model period.
+ */
+void SubRenewableResource::initSupplyCurve( const int aPeriod ) {
+    SupplyCurveTable& curve = mSupplyCurve[ aPeriod ];
+    curve.mCost.resize( mGrade.size() );
+    curve.mQuantity.resize( mGrade.size() );
+    for( unsigned int i = 0; i < mGrade.size(); ++i ) {
+        curve.mCost[ i ] = mGrade[ i ]->getCost( aPeriod );
+        curve.mQuantity[ i ] = mGrade[ i ]->getAvail();
+    }
+    curve.mMaxQuantity = mGrade.empty() ? 0.0 : mGrade.back()->getAvail();
+}
+
 //! Cumulative Production
 /*! Cumulative production Is not needed for renewable resources. But still do
 *   any preliminary calculations that need to be done before calculating
@@ -156,45 +175,13 @@ void SubRenewableResource::annualsupply( const string& aRegionName, const string
 {
     ITechnology* currTech = mTechnology->getNewVintageTechnology( aPeriod );
     currTech->calcCost( aRegionName, aResourceName, aPeriod );
-    double fractionAvailable = -1;
     const double effectivePrice = aPrice + mPriceAdder[ aPeriod ] - currTech->getCost( aPeriod );
+    mEffectivePrice[ aPeriod ] = effectivePrice;
 
-    // Move up the cost curve until a point is found above the current price.
-    for ( unsigned int i = 0; i < mGrade.size(); ++i ) {
-        if( effectivePrice <= mGrade[ i ]->getCost( aPeriod ) ) {
-            if( i == 0 ) {
-                // Below the bottom of the supply curve which means the fraction
-                // available is zero.
-                fractionAvailable = 0;
-            }
-            else {
-                // Determine the cost and available for the previous
-                // point. 
-                double prevGradeCost = mGrade[ i - 1 ]->getCost( aPeriod );
-                double prevGradeAvailable = mGrade[ i - 1 ]->getAvail();
-
-                // This should not be able to happen because the above if
-                // statement would fail.
-                assert( mGrade[ i ]->getCost( aPeriod ) > prevGradeCost );
-                double gradeFraction = ( effectivePrice - prevGradeCost )
-                    / ( mGrade[ i ]->getCost( aPeriod ) - prevGradeCost );
-                // compute production as fraction of total possible
-                fractionAvailable = prevGradeAvailable + gradeFraction
-                    * ( mGrade[ i ]->getAvail() - prevGradeAvailable ); 
-            }
-
-            break;
-        }
-    }
-
-    // If the fraction available has not been set there is not a point with a
-    // cost greater than the price. This means the price is above the curve.
-    if( fractionAvailable == -1 ){
-        // Calculate the total fraction of the max subresource to use. Note that
-        // the max fraction available can be more than 100 percent.
-        double maxFraction = mGrade[ mGrade.size() - 1 ]->getAvail();
-        fractionAvailable = maxFraction;
-    }
+    // Look up the fraction of the max subresource available at the current price
+    // on the cost curve.  Note that the max fraction available can be more than
+    // 100 percent.
+    const double fractionAvailable = mSupplyCurve[ aPeriod ].getQuantity( effectivePrice );
 
     // Calculate the amount of resource expansion due to GDP increase.
     double resourceSupplyIncrease = pow( aGdp->getApproxGDP( aPeriod ) / aGdp->getApproxGDP( 0 ),
@@ -56,6 +56,7 @@
 #include "containers/include/scenario.h"
 #include "util/base/include/model_time.h"
 #include "marketplace/include/marketplace.h"
+#include "marketplace/include/cached_market.h"
 #include "marketplace/include/imarket_type.h"
 #include "resources/include/renewable_subresource.h"
 #include "resources/include/smooth_renewable_subresource.h"
@@ -294,6 +295,8 @@ void Resource::initCalc( const string& aRegionName, const int aPeriod ) {
         maxprice = std::max( maxprice, mSubResource[i]->getHighestPrice( aPeriod ) );
     }
     SectorUtils::setSupplyBehaviorBounds( mName, aRegionName, minprice, maxprice, aPeriod );
+
+    mCachedMarket = scenario->getMarketplace()->locateMarket( mName, aRegionName, aPeriod );
 }
 
 /*! \brief Perform any calculations needed for each period after solution is
@@ -365,9 +368,7 @@ const string& Resource::getName() const {
 //! Calculate total resource supply for a period.
 void Resource::calcSupply( const string& aRegionName, const GDP* aGDP, const int aPeriod ){
     // This code is moved down from Region
-    Marketplace* marketplace = scenario->getMarketplace();
-
-    double price = marketplace->getPrice( mName, aRegionName, aPeriod );
+    double price = mCachedMarket->getPrice( mName, aRegionName, aPeriod );
     
     // calculate annual supply
     annualsupply( aRegionName, aPeriod, aGDP, price );
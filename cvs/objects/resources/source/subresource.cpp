@@ -43,6 +43,7 @@
 #include <string>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 
@@ -234,6 +235,7 @@ void SubResource::initCalc( const string& aRegionName, const string& aResourceNa
         // Determine cost
         mGrade[gr]->calcCost( mCumulativeTechChange[ aPeriod ], aPeriod );
     }
+    initSupplyCurve( aPeriod );
 
     // Fill price added after it is calibrated.  This will interpolate to any
     // price adders read in the future or just copy forward if there is nothing
@@ -346,45 +348,89 @@ void SubResource::cumulsupply( const string& aRegionName, const string& aResourc
     
     double prevCumul = aPeriod != 0 ? mCumulProd[ aPeriod - 1 ] : 0.0;
 
-    // Case 1
-    // if market price is less than cost of first grade, then zero cumulative
-    // production
-    if ( mEffectivePrice[ aPeriod ] <= mGrade[0]->getCost( aPeriod )) {
-        mCumulProd[ aPeriod ] = prevCumul;
+    // The supply curve gives zero cumulative production if the market price is
+    // less than the cost of the first grade, interpolates if it is in between the
+    // cost of the first and last grade, and gives the amount in all grades if it
+    // is greater than the cost of the last grade.
+    mCumulProd[ aPeriod ] = std::max( mSupplyCurve[ aPeriod ].getQuantity( mEffectivePrice[ aPeriod ] ),
+                                      prevCumul );
+}
+
+/*!
+ * \brief Build the supply curve for the given period from the grades.
+ * \details Each grade is produced as the price rises from its cost to the cost
+ *          of the next grade so the cumulative production at the cost of a grade
+ *          is the amount in all of the grades below it.  The amount in the last
+ *          grade is only produced once the price exceeds its cost.  Must be
+ *          called after the grade costs have been calculated for the period.
+ * \param aPeriod Model period.
+ */
+void SubResource::initSupplyCurve( const int aPeriod ) {
+    SupplyCurveTable& curve = mSupplyCurve[ aPeriod ];
+    curve.mCost.resize( mGrade.size() );
+    curve.mQuantity.resize( mGrade.size() );
+    double cumulAvail = 0.0;
+    for( unsigned int i = 0; i < mGrade.size(); ++i ) {
+        curve.mCost[ i ] = mGrade[ i ]->getCost( aPeriod );
+        curve.mQuantity[ i ] = cumulAvail;
+        cumulAvail += mGrade[ i ]->getAvail();
     }
-    
-    // Case 2
-    // if market price is in between cost of first and last grade, then calculate
-    // cumulative production in between those grades
-    if ( mEffectivePrice[ aPeriod ] > mGrade[0]->getCost( aPeriod ) && mEffectivePrice[ aPeriod ] <= mGrade[ mGrade.size() - 1 ]->getCost( aPeriod )) {
-        mCumulProd[ aPeriod ] = 0;
-        int i = 0;
-        int iL = 0;
-        int iU = 0;
-        while ( mGrade[ i ]->getCost( aPeriod ) < mEffectivePrice[ aPeriod ] ) {
-            iL=i; i++; iU=i;
-        }
-        // add subrsrcs up to the lower grade
-        for ( i = 0; i <= iL; i++ ) {
-            mCumulProd[ aPeriod ] += Value( mGrade[i]->getAvail() );
-        }
-        // price must reach upper grade cost to produce all of lower grade
-        double slope = mGrade[iL]->getAvail()
-            / ( mGrade[iU]->getCost( aPeriod ) - mGrade[iL]->getCost( aPeriod ) );
-        mCumulProd[ aPeriod ] -= Value( slope * ( mGrade[iU]->getCost( aPeriod ) - mEffectivePrice[ aPeriod ] ) );
+    curve.mMaxQuantity = cumulAvail;
+}
+
+/*!
+ * \brief Get the slope of the supply curve at the effective price most recently
+ *        calculated.
+ * \details This is the analytic derivative of the grade based supply curve
+ *          with respect to price, in the units of grade availability, which is
+ *          cumulative production for depletable resources and the fraction of
+ *          the maximum annual production for renewable resources.
+ * \param aPeriod Model period.
+ * \return The slope of the supply curve.
+ */
+double SubResource::getSupplyCurveSlope( const int aPeriod ) const {
+    return mSupplyCurve[ aPeriod ].getSlope( mEffectivePrice[ aPeriod ] );
+}
+
+//! Constructor
+SubResource::SupplyCurveTable::SupplyCurveTable():
+mMaxQuantity( 0.0 )
+{
+}
+
+/*!
+ * \brief Get the quantity supplied at the given price.
+ * \param aPrice The price.
+ * \return The quantity supplied.
+ */
+double SubResource::SupplyCurveTable::getQuantity( const double aPrice ) const {
+    if( mCost.empty() || aPrice <= mCost.front() ) {
+        return 0.0;
     }
-    
-    // Case 3
-    // if market price greater than the cost of the last grade, then
-    // cumulative production is the amount in all grades
-    if ( mEffectivePrice[ aPeriod ] > mGrade[ mGrade.size() - 1 ]->getCost( aPeriod ) ) {
-        mCumulProd[ aPeriod ] = 0;
-        for ( unsigned int i = 0; i < mGrade.size(); i++ ) {
-            mCumulProd[ aPeriod ] += Value( mGrade[i]->getAvail() );
-        }
+    else if( aPrice > mCost.back() ) {
+        return mMaxQuantity;
     }
-    
-    mCumulProd[ aPeriod ] = std::max( mCumulProd[ aPeriod ].get(), prevCumul );
+    // Find the first point with a cost at least as large as the price which can
+    // not be the first point given the check above.
+    const size_t upper = lower_bound( mCost.begin(), mCost.end(), aPrice ) - mCost.begin();
+    const size_t lower = upper - 1;
+    return mQuantity[ lower ] + ( aPrice - mCost[ lower ] ) / ( mCost[ upper ] - mCost[ lower ] )
+        * ( mQuantity[ upper ] - mQuantity[ lower ] );
+}
+
+/*!
+ * \brief Get the slope of the supply curve at the given price.
+ * \details The supply curve is flat below the first and above the last cost.
+ * \param aPrice The price.
+ * \return The change in quantity supplied per unit change in price.
+ */
+double SubResource::SupplyCurveTable::getSlope( const double aPrice ) const {
+    if( mCost.empty() || aPrice <= mCost.front() || aPrice > mCost.back() ) {
+        return 0.0;
+    }
+    const size_t upper = lower_bound( mCost.begin(), mCost.end(), aPrice ) - mCost.begin();
+    const size_t lower = upper - 1;
+    return ( mQuantity[ upper ] - mQuantity[ lower ] ) / ( mCost[ upper ] - mCost[ lower ] );
 }
 
 double SubResource::getCumulProd( const int aPeriod ) const {
@@ -398,10 +444,11 @@ double SubResource::getCumulProd( const int aPeriod ) const {
 *
 */
 void SubResource::updateAvailable( const int aPeriod ){
-    mAvailable[ aPeriod ] = 0;
+    double available = 0.0;
     for ( unsigned int i = 0; i < mGrade.size(); ++i ) {
-        mAvailable[ aPeriod ] += Value( mGrade[ i ]->getAvail() );
+        available += mGrade[ i ]->getAvail();
     }
+    mAvailable[ aPeriod ] = available;
 }
 
 //! calculate annual supply
@@ -77,6 +77,8 @@ public:
     virtual void completeInit( const IInfo* aRegionInfo,
                                ILandAllocator* aLandAllocator );
 
+    virtual void calcFinalSupplyPrice( const GDP* aGDP, const int aPeriod );
+
     virtual void supply( const GDP* aGDP, const int aPeriod );
 protected:
 	virtual double getPrice( const GDP* aGDP,
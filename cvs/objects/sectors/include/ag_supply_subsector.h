@@ -61,7 +61,8 @@ public:
     virtual ~AgSupplySubsector();
     static const std::string& getXMLNameStatic();
 
-    virtual double calcShare( const IDiscreteChoice* aChoiceFun, const GDP* aGDP, const int aPeriod ) const;
+    virtual double calcShare( const IDiscreteChoice* aChoiceFun, const GDP* aGDP, const double aPrice,
+                              const int aPeriod ) const;
     
     virtual void interpolateShareWeights( const int aPeriod );
 protected:
@@ -74,7 +74,11 @@ protected:
 
     )
     
-    const std::vector<double> calcChildShares( const GDP* aGDP, const int aPeriod ) const;
+    const std::vector<double> calcChildPrices( const GDP* aGDP, const int aPeriod ) const;
+    const std::vector<double> calcChildShares( const std::vector<double>& aChildPrices, const GDP* aGDP,
+                                               const int aPeriod ) const;
+    double calcPriceFromChildShares( const std::vector<double>& aChildShares,
+                                     const std::vector<double>& aChildPrices ) const;
     virtual bool getCalibrationStatus( const int aPeriod ) const;
     virtual bool XMLDerivedClassParse( const std::string& nodeName, const xercesc::DOMNode* curr );
     virtual const std::string& getXMLName() const;
@@ -95,6 +99,7 @@ public:
                            const int aPeriod );
 
     virtual double getPrice( const GDP* aGDP, const int aPeriod ) const;
+    virtual double calcPrice( const GDP* aGDP, const int aPeriod );
     virtual bool allOutputFixed( const int period ) const;
     virtual bool containsOnlyFixedOutputTechnologies( const int period ) const;
     virtual double getAverageFuelPrice( const GDP* aGDP, const int aPeriod ) const;
@@ -152,7 +152,10 @@ protected:
     virtual const std::string& getXMLName() const = 0;
     
     virtual double getFixedOutput( const int aPeriod ) const;
-    const std::vector<double> calcSubsectorShares( const GDP* aGDP, const int aPeriod ) const;
+    const std::vector<double> calcSubsectorShares( const std::vector<double>& aSubsecPrices,
+                                                   const GDP* aGDP, const int aPeriod ) const;
+    double calcPriceFromShares( const std::vector<double>& aSubsecShares,
+                                const std::vector<double>& aSubsecPrices ) const;
 
     bool outputsAllFixed( const int period ) const;
     
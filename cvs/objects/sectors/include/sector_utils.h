@@ -80,6 +80,7 @@ public:
 
     static double normalizeShares( std::vector<double>& aShares );
     static std::pair<double, double> normalizeLogShares( std::vector<double> & alogShares );
+    static std::pair<double, double> normalizeLogShares( double* aLogShares, const size_t aSize );
 
     static double calcPriceRatio( const std::string& aRegionName,
                                   const std::string& aSectorName,
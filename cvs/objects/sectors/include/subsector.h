@@ -124,6 +124,10 @@ protected:
         //! Subsector logit share weights
         DEFINE_VARIABLE( ARRAY | STATE, "share-weight", mShareWeights, objects::PeriodVector<Value> ),
 
+        //! Normalized share of the sector's new investment, stored when the
+        //! sector price is calculated so that setting output can reuse it.
+        DEFINE_VARIABLE( ARRAY | STATE, "share", mShare, objects::PeriodVector<Value> ),
+
         //! The original subsector logit share weights that were parsed
         DEFINE_VARIABLE( ARRAY, "parsed-share-weight", mParsedShareWeights, objects::PeriodVector<Value> ),
                     
@@ -166,6 +170,7 @@ protected:
     void parseBaseTechHelper( const xercesc::DOMNode* curr, BaseTechnology* aNewTech );
     
     virtual const std::vector<double> calcTechShares ( const GDP* gdp, const int period ) const;
+    double calcPriceFromTechShares( const std::vector<double>& aTechShares, const int aPeriod ) const;
     
     void clear();
     void clearInterpolationRules();
@@ -191,14 +196,18 @@ public:
     void toDebugXML( const int period, std::ostream& out, Tabs* tabs ) const;
     static const std::string& getXMLNameStatic();
     virtual double getPrice( const GDP* aGDP, const int aPeriod ) const;
+    virtual double calcPrice( const GDP* aGDP, const int aPeriod );
     virtual bool allOutputFixed( const int period ) const;
     virtual bool containsOnlyFixedOutputTechnologies( const int period ) const;
     virtual double getAverageFuelPrice( const GDP* aGDP, const int aPeriod ) const;
 
     virtual void calcCost( const int aPeriod );
 
-    virtual double calcShare( const IDiscreteChoice* aChoiceFn, const GDP* aGDP, const int aPeriod) const;
+    virtual double calcShare( const IDiscreteChoice* aChoiceFn, const GDP* aGDP, const double aPrice,
+                              const int aPeriod ) const;
     virtual double getShareWeight( const int period ) const;
+    double getShare( const int aPeriod ) const;
+    void setShare( const double aShare, const int aPeriod );
 
     virtual void setOutput( const double aVariableDemand,
                             const double aFixedOutputScaleFactor,
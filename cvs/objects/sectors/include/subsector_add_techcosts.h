@@ -68,6 +68,7 @@ public:
     SubsectorAddTechCosts( const std::string& aRegionName, const std::string& aSectorName );
     static const std::string& getXMLNameStatic();
 	virtual double getPrice( const GDP* aGDP, const int aPeriod ) const;
+    virtual double calcPrice( const GDP* aGDP, const int aPeriod );
 protected:
     
     // Define data such that introspection utilities can process the data from this
@@ -78,6 +78,7 @@ public:
                            const MoreSectorInfo* aMoreSectorInfo,
                            const int aPeriod );
     double getPrice( const GDP* aGDP, const int aPeriod ) const;
+    virtual double calcPrice( const GDP* aGDP, const int aPeriod );
 
     virtual void setOutput( const double aVariableSubsectorDemand,
                             const double aFixedOutputScaleFactor,
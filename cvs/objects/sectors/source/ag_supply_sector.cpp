@@ -138,6 +138,24 @@ double AgSupplySector::getPrice( const GDP* aGDP, const int aPeriod ) const {
     return scenario->getMarketplace()->getPrice( mName, mRegionName, aPeriod, true );
 }
 
+/*! \brief Calculate the final supply price for the AgSupplySector.
+* \details The sector price is the solved market price, so the subsector shares
+*          are not needed and are not calculated or stored.  The subsectors
+*          still calculate their prices to store the technology shares used
+*          when setting output.
+* \param aGDP The regional GDP container.
+* \param aPeriod The period in which to calculate the final supply price.
+*/
+void AgSupplySector::calcFinalSupplyPrice( const GDP* aGDP, const int aPeriod ){
+    // Calculate the costs for all subsectors.
+    calcCosts( aPeriod );
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
+        mSubsectors[ i ]->calcPrice( aGDP, aPeriod );
+    }
+
+    scenario->getMarketplace()->setPrice( mName, mRegionName, getPrice( aGDP, aPeriod ), aPeriod, true );
+}
+
 /*! \brief Get the XML node name for output to XML.
 *
 * This public function accesses the private constant string, XML_NAME.
@@ -87,7 +87,8 @@ const string& AgSupplySubsector::getXMLNameStatic() {
 
 // subsector shares not used for AgSupplySectors, so overridden to return 1
 
-double AgSupplySubsector::calcShare( const IDiscreteChoice* aChoiceFn, const GDP* aGDP, const int aPeriod ) const
+double AgSupplySubsector::calcShare( const IDiscreteChoice* aChoiceFn, const GDP* aGDP, const double aPrice,
+                                     const int aPeriod ) const
 {
     return 1;
 }
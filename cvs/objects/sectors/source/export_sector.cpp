@@ -81,13 +81,18 @@ double ExportSector::getPrice( const GDP* aGDP, const int aPeriod ) const {
 /*! \brief Calculate the final supply price for the ExportSector, which will
 *          leave the international price unchanged.
 * \details Currently this function does not calculate or set a price into the
-*          marketplace, so that the read-in price is preserved.
+*          marketplace, so that the read-in price is preserved.  The subsectors
+*          still calculate their prices to store the technology shares used
+*          when setting output.
 * \param aGDP The regional GDP container.
 * \param aPeriod The period in which to calculate the final supply price.
 */
 void ExportSector::calcFinalSupplyPrice( const GDP* aGDP, const int aPeriod ){
     // Calculate the costs for all subsectors.
     calcCosts( aPeriod );
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
+        mSubsectors[ i ]->calcPrice( aGDP, aPeriod );
+    }
 }
 
 /*! \brief Set the ExportSector output.
@@ -183,20 +183,37 @@ void NestingSubsector::initCalc( NationalAccount* aNationalAccount,
     Subsector::initCalc( aNationalAccount, aDemographics, aMoreSectorInfo, aPeriod );
 }
 
+/*!
+ * \brief Get the price of each child subsector within this nest.
+ * \param aGDP Regional GDP object.
+ * \param aPeriod model period
+ * \return A vector of child subsector prices.
+*/
+const vector<double> NestingSubsector::calcChildPrices( const GDP* aGDP, const int aPeriod ) const {
+    vector<double> childPrices( mSubsectors.size() );
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
+        childPrices[ i ] = mSubsectors[ i ]->getPrice( aGDP, aPeriod );
+    }
+    return childPrices;
+}
+
 /*!
  * \brief calculate child subsector shares within this nest 
  *
- * Calls child subsectors to first calculate cost, then their share. Follows this by normalizing shares. 
+ * Calculates the share of each child subsector given its price. Follows this by normalizing shares. 
  *
+ * \param aChildPrices The price of each child subsector.
  * \param aGDP The GDP object in case of fuel preference elasticity is used.
  * \param aPeriod model period
  * \return A vector of subsector shares.
 */
-const vector<double> NestingSubsector::calcChildShares( const GDP* aGDP, const int aPeriod ) const {
+const vector<double> NestingSubsector::calcChildShares( const vector<double>& aChildPrices, const GDP* aGDP,
+                                                        const int aPeriod ) const
+{
     // Calculate unnormalized shares.
     vector<double> subsecShares( mSubsectors.size() );
     for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
-        subsecShares[ i ] = mSubsectors[ i ]->calcShare( mDiscreteChoiceModel, aGDP, aPeriod );
+        subsecShares[ i ] = mSubsectors[ i ]->calcShare( mDiscreteChoiceModel, aGDP, aChildPrices[ i ], aPeriod );
     }
 
     // Normalize the shares.  After normalization they will be true shares, not log(shares).
@@ -213,10 +230,10 @@ const vector<double> NestingSubsector::calcChildShares( const GDP* aGDP, const i
         // minimum cost subsector.
         assert( subsec.size() > 0 );
         int minPriceIndex = 0;
-        double minPrice = mSubsectors[ minPriceIndex ]->getPrice( aGDP, aPeriod );
+        double minPrice = aChildPrices[ minPriceIndex ];
         subsecShares[ 0 ] = 0.0;
         for( int i = 1; i < mSubsectors.size(); ++i ) {
-            double currPrice = mSubsectors[ i ]->getPrice( aGDP, aPeriod );
+            double currPrice = aChildPrices[ i ];
             subsecShares[ i ] = 0.0;                  // zero out all subsector shares ...
             if( currPrice < minPrice ) {
                 minPrice = currPrice;
@@ -238,17 +255,47 @@ const vector<double> NestingSubsector::calcChildShares( const GDP* aGDP, const i
 * \param aPeriod Model period
 */
 double NestingSubsector::getPrice( const GDP* aGDP, const int aPeriod ) const {
+    const vector<double> childPrices = calcChildPrices( aGDP, aPeriod );
+    return calcPriceFromChildShares( calcChildShares( childPrices, aGDP, aPeriod ), childPrices );
+}
+
+/*! \brief Calculate the subsector price and store the shares it is based on.
+* \details Has each child subsector calculate its price, which stores the
+*          technology shares below it, then stores the share of each child so
+*          that setOutput can reuse them.
+* \param aGDP Regional GDP object.
+* \param aPeriod Model period
+* \return The subsector price.
+*/
+double NestingSubsector::calcPrice( const GDP* aGDP, const int aPeriod ) {
+    vector<double> childPrices( mSubsectors.size() );
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ) {
+        childPrices[ i ] = mSubsectors[ i ]->calcPrice( aGDP, aPeriod );
+    }
+    const vector<double> childShares = calcChildShares( childPrices, aGDP, aPeriod );
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ) {
+        mSubsectors[ i ]->setShare( childShares[ i ], aPeriod );
+    }
+    return calcPriceFromChildShares( childShares, childPrices );
+}
+
+/*! \brief Calculate the share weighted price of the child subsectors.
+* \param aChildShares Normalized child subsector shares.
+* \param aChildPrices The price of each child subsector.
+* \return The subsector price or NaN if no child has a share.
+*/
+double NestingSubsector::calcPriceFromChildShares( const vector<double>& aChildShares,
+                                                   const vector<double>& aChildPrices ) const
+{
     double subsectorPrice = 0.0; // initialize to 0 for summing
     double sharesum = 0.0;
-    const vector<double>& techShares = calcChildShares( aGDP, aPeriod );
     for ( unsigned int i = 0; i < mSubsectors.size(); ++i ) {
-        double currCost = mSubsectors[i]->getPrice( aGDP, aPeriod );
         // calculate weighted average price for Subsector.
         /*!
          * \note Negative prices may be produced and are valid.
          */
-        subsectorPrice += techShares[ i ] * currCost;
-        sharesum += techShares[i];
+        subsectorPrice += aChildShares[ i ] * aChildPrices[ i ];
+        sharesum += aChildShares[i];
     }
 
     if( sharesum < util::getSmallNumber() ) {
@@ -301,7 +348,7 @@ double NestingSubsector::getAverageFuelPrice( const GDP* aGDP, const int aPeriod
     // current period's are unknown.
     const int sharePeriod = ( aPeriod == 0 ) ? aPeriod : aPeriod - 1;
 
-    const vector<double>& techShares = calcChildShares( aGDP, sharePeriod );
+    const vector<double>& techShares = calcChildShares( calcChildPrices( aGDP, sharePeriod ), aGDP, sharePeriod );
     for ( unsigned int i = 0; i < mSubsectors.size(); ++i) {
         // calculate weighted average price of fuel only
         // subsector shares are based on total cost
@@ -361,9 +408,9 @@ void NestingSubsector::setOutput( const double aSubsectorVariableDemand,
                            const int aPeriod )
 
 {
-    const vector<double>& subsecShares = calcChildShares( aGDP, aPeriod );
+    // The child shares were stored when the subsector price was calculated.
     for( size_t i = 0; i < mSubsectors.size(); ++i ) {
-        mSubsectors[i]->setOutput( subsecShares[i] * aSubsectorVariableDemand,
+        mSubsectors[i]->setOutput( mSubsectors[i]->getShare( aPeriod ) * aSubsectorVariableDemand,
                 aFixedOutputScaleFactor, aGDP, aPeriod );
     }
 }
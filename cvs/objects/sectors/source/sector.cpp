@@ -367,15 +367,20 @@ void Sector::calcCosts( const int aPeriod ){
 *          calculated an unnormalized share, and then calls normShare to
 *          normalize the shares for each subsector. Fixed subsectors are ignored
 *          here as they do not have a share of the new investment.
+* \param aSubsecPrices The price of each subsector.
 * \param aGDP Regional GDP container.
 * \param aPeriod Model period.
 * \return A vector of normalized shares, one per subsector, ordered by subsector.
 */
-const vector<double> Sector::calcSubsectorShares( const GDP* aGDP, const int aPeriod ) const {
+const vector<double> Sector::calcSubsectorShares( const vector<double>& aSubsecPrices,
+                                                  const GDP* aGDP, const int aPeriod ) const
+{
+    /*! \pre There is one price per subsector. */
+    assert( aSubsecPrices.size() == mSubsectors.size() );
     // Calculate unnormalized shares.
     vector<double> subsecShares( mSubsectors.size() );
     for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
-        subsecShares[ i ] = mSubsectors[ i ]->calcShare( mDiscreteChoiceModel, aGDP, aPeriod );
+        subsecShares[ i ] = mSubsectors[ i ]->calcShare( mDiscreteChoiceModel, aGDP, aSubsecPrices[ i ], aPeriod );
     }
 
     // Normalize the shares.  After normalization they will be true shares, not log(shares).
@@ -392,10 +397,10 @@ const vector<double> Sector::calcSubsectorShares( const GDP* aGDP, const int aPe
         // minimum cost subsector.
         assert( subsec.size() > 0 );
         int minPriceIndex = 0;
-        double minPrice = mSubsectors[ minPriceIndex ]->getPrice( aGDP, aPeriod );
+        double minPrice = aSubsecPrices[ minPriceIndex ];
         subsecShares[ 0 ] = 0.0;
         for( int i = 1; i < mSubsectors.size(); ++i ) {
-            double currPrice = mSubsectors[ i ]->getPrice( aGDP, aPeriod );
+            double currPrice = aSubsecPrices[ i ];
             subsecShares[ i ] = 0.0;                  // zero out all subsector shares ...
             if( currPrice < minPrice ) {
                 minPrice = currPrice;
@@ -417,16 +422,33 @@ const vector<double> Sector::calcSubsectorShares( const GDP* aGDP, const int aPe
 * \return Weighted sector price.
 */
 double Sector::getPrice( const GDP* aGDP, const int aPeriod ) const {
-    const vector<double>& subsecShares = calcSubsectorShares( aGDP, aPeriod );
+    vector<double> subsecPrices( mSubsectors.size() );
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
+        subsecPrices[ i ] = mSubsectors[ i ]->getPrice( aGDP, aPeriod );
+    }
+    return calcPriceFromShares( calcSubsectorShares( subsecPrices, aGDP, aPeriod ), subsecPrices );
+}
+
+/*! \brief Calculate the weighted average price of subsectors given their shares.
+* \details Allows callers which have already calculated the subsector prices and
+*          shares to calculate the sector price without repeating either.
+* \param aSubsecShares Normalized subsector shares, one per subsector.
+* \param aSubsecPrices The price of each subsector.
+* \return Weighted sector price.
+*/
+double Sector::calcPriceFromShares( const vector<double>& aSubsecShares,
+                                    const vector<double>& aSubsecPrices ) const
+{
+    /*! \pre There is one share per subsector. */
+    assert( aSubsecShares.size() == mSubsectors.size() );
     double sectorPrice = 0;
     double sumSubsecShares = 0;
     for ( unsigned int i = 0; i < mSubsectors.size(); ++i ){
-        // Subsectors with no share cannot affect price. The getPrice function
-        // is constant so skipping it will not avoid any side effects. What?
-        if( subsecShares[ i ] > util::getSmallNumber() ){
-            sumSubsecShares += subsecShares[ i ];
-            double currPrice = mSubsectors[ i ]->getPrice( aGDP, aPeriod );
-            sectorPrice += subsecShares[ i ] * currPrice;
+        // Subsectors with no share cannot affect price, and may have a NaN
+        // price if none of their technologies have a share.
+        if( aSubsecShares[ i ] > util::getSmallNumber() ){
+            sumSubsecShares += aSubsecShares[ i ];
+            sectorPrice += aSubsecShares[ i ] * aSubsecPrices[ i ];
         }
     }
     
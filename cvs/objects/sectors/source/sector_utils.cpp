@@ -216,16 +216,33 @@ double SectorUtils::calcFixedOutputScaleFactor( const double aMarketDemand,
  *         calculations using these values in a numerically stable way.
  */
 pair<double, double> SectorUtils::normalizeLogShares( vector<double>& alogShares ){
+    return normalizeLogShares( alogShares.empty() ? 0 : &alogShares[ 0 ], alogShares.size() );
+}
+
+/*!
+ * \brief Normalize a contiguous array of log shares in place.
+ * \details Identical to normalizeLogShares( vector<double>& ) however operates
+ *          on a raw array so that callers which keep the shares of many nests
+ *          in a single flat buffer can normalize each nest without copying.
+ *          Each pass is a simple loop over contiguous memory so that the
+ *          compiler is free to vectorize it.
+ * \param aLogShares Pointer to the first of the logs of unnormalized shares on
+ *                   input, normalized shares (not logs) on output.
+ * \param aSize The number of shares.
+ * \return The unnormalized sum of the shares and a log(adjustment factor) that
+ *         has been factored out of the sum.
+ */
+pair<double, double> SectorUtils::normalizeLogShares( double* aLogShares, const size_t aSize ){
     // find the log of the largest unnormalized share
-    double lfac = *max_element(alogShares.begin(), alogShares.end());
+    double lfac = *max_element( aLogShares, aLogShares + aSize );
     double sum = 0.0;
     
     // check for all zero prices
     if( lfac == -numeric_limits<double>::infinity() ) {
         // In this case, set all shares to zero and return.
         // This is arguably wrong, but the rest of the code seems to expect it.
-        for( size_t i = 0; i < alogShares.size(); ++i ) {
-            alogShares[ i ] = 0.0;
+        for( size_t i = 0; i < aSize; ++i ) {
+            aLogShares[ i ] = 0.0;
         }
         return make_pair( 0.0, 0.0 );
     }
@@ -234,16 +251,16 @@ pair<double, double> SectorUtils::normalizeLogShares( vector<double>& alogShares
     // shares are calculated, it would seem like that can't happen.
 
     // rescale and get normalization sum
-    for( size_t i = 0; i < alogShares.size(); ++i ) {
-        alogShares[ i ] -= lfac;
-        sum += exp( alogShares[ i ] );
+    for( size_t i = 0; i < aSize; ++i ) {
+        aLogShares[ i ] -= lfac;
+        sum += exp( aLogShares[ i ] );
     }
     double unnormAdjustedSum = sum;
     double norm = log( sum );
     sum = 0.0;                               // double check the normalization
-    for( size_t i = 0; i < alogShares.size(); ++i ) {
-        alogShares[ i ] = exp( alogShares[ i ] - norm );   // divide by norm constant and unlog
-        sum += alogShares[ i ];                      // accumulate sum of normalized shares 
+    for( size_t i = 0; i < aSize; ++i ) {
+        aLogShares[ i ] = exp( aLogShares[ i ] - norm );   // divide by norm constant and unlog
+        sum += aLogShares[ i ];                      // accumulate sum of normalized shares 
                                                      //   (should be 1.0 when we're done.)
     }
     
@@ -508,17 +508,44 @@ void Subsector::initCalc( NationalAccount* aNationalAccount,
 * \param aPeriod Model period
 */
 double Subsector::getPrice( const GDP* aGDP, const int aPeriod ) const {
+    return calcPriceFromTechShares( calcTechShares( aGDP, aPeriod ), aPeriod );
+}
+
+/*! \brief Calculate the subsector price and store the technology shares it is
+*          based on.
+* \details Calculates the technology shares once and stores them in the new
+*          vintage technologies so that setOutput can reuse them.  The returned
+*          price is the same as getPrice.  Subclasses which override getPrice
+*          must also override this method.
+* \param aGDP Regional GDP object.
+* \param aPeriod Model period
+* \return The subsector price.
+* \sa setOutput
+*/
+double Subsector::calcPrice( const GDP* aGDP, const int aPeriod ) {
+    const vector<double> techShares = calcTechShares( aGDP, aPeriod );
+    for( unsigned int i = 0; i < mTechContainers.size(); ++i ) {
+        mTechContainers[ i ]->getNewVintageTechnology( aPeriod )->setShare( techShares[ i ], aPeriod );
+    }
+    return calcPriceFromTechShares( techShares, aPeriod );
+}
+
+/*! \brief Calculate the share weighted price of the technologies.
+* \param aTechShares Normalized technology shares, one per technology.
+* \param aPeriod Model period
+* \return The subsector price or NaN if no technology has a share.
+*/
+double Subsector::calcPriceFromTechShares( const vector<double>& aTechShares, const int aPeriod ) const {
     double subsectorPrice = 0.0; // initialize to 0 for summing
     double sharesum = 0.0;
-    const vector<double>& techShares = calcTechShares( aGDP, aPeriod );
     for ( unsigned int i = 0; i < mTechContainers.size(); ++i ) {
         double currCost = mTechContainers[i]->getNewVintageTechnology(aPeriod)->getCost( aPeriod );
         // calculate weighted average price for Subsector.
         /*!
          * \note Negative prices may be produced and are valid.
          */
-        subsectorPrice += techShares[ i ] * currCost;
-        sharesum += techShares[i];
+        subsectorPrice += aTechShares[ i ] * currCost;
+        sharesum += aTechShares[i];
     }
 
     if( sharesum < util::getSmallNumber() ) {
@@ -635,16 +662,17 @@ void Subsector::calcCost( const int aPeriod ){
  * \param aChoiceFn Discrete choice model for the subsector competition within
  *                  the sector.
  * \param aGDP gdp object
+ * \param aPrice The subsector price as returned by getPrice or calcPrice.
  * \param aPeriod model period
  * \warning There is no difference between demand and supply technologies.
  *          Control behavior with value of parameter mFuelPrefElasticity
  * \return The log of the subsector share.
  * \sa Technology::calcShare()
 */
-double Subsector::calcShare( const IDiscreteChoice* aChoiceFn, const GDP* aGDP, const int aPeriod ) const {
-    double subsectorPrice = getPrice( aGDP, aPeriod );
-
-    if( boost::math::isnan( subsectorPrice ) ) {
+double Subsector::calcShare( const IDiscreteChoice* aChoiceFn, const GDP* aGDP, const double aPrice,
+                             const int aPeriod ) const
+{
+    if( boost::math::isnan( aPrice ) ) {
         // Check for a NaN sentinel value.  If we find it, set the
         // subsector's share to zero.
         return -numeric_limits<double>::infinity();
@@ -654,7 +682,7 @@ double Subsector::calcShare( const IDiscreteChoice* aChoiceFn, const GDP* aGDP,
     double scaledGdpPerCapita = aGDP->getBestScaledGDPperCap( aPeriod );
     assert( scaledGdpPerCapita > 0.0 );
 
-    double logshare = aChoiceFn->calcUnnormalizedShare( mShareWeights[ aPeriod ], subsectorPrice, aPeriod )
+    double logshare = aChoiceFn->calcUnnormalizedShare( mShareWeights[ aPeriod ], aPrice, aPeriod )
         + mFuelPrefElasticity[ aPeriod ] * log( scaledGdpPerCapita );
 
     /*! \post logshare is finite or minus-infinity. */
@@ -743,7 +771,8 @@ void Subsector::interpolateShareWeights( const int aPeriod ) {
 /*! \brief The demand passed to this function is shared out at the Technology
 *          level.
 * \details Variable demand (could be energy or energy service) is passed to
-*          technologies and then shared out at the Technology level.
+*          technologies and then shared out at the Technology level using the
+*          technology shares stored by calcPrice.
 * \author Sonny Kim, Josh Lurz
 * \param aSubsectorVariableDemand Total variable demand for this subsector.
 * \param aFixedOutputScaleFactor Scale factor to scale down fixed output
@@ -758,8 +787,8 @@ void Subsector::setOutput( const double aSubsectorVariableDemand,
 {
     assert( util::isValidNumber( aSubsectorVariableDemand ) && aSubsectorVariableDemand >= 0 );
     
-    // Calculate the technology shares.
-    const vector<double>& shares = calcTechShares( aGDP, aPeriod );
+    // The technology shares were stored when the subsector price was
+    // calculated, which always happens before output is set.
     for( TechIterator techIter = mTechContainers.begin(); techIter != mTechContainers.end(); ++techIter ) {
         ITechnologyContainer::TechRangeIterator vintageIter = (*techIter)->getVintageBegin( aPeriod );
         
@@ -767,7 +796,7 @@ void Subsector::setOutput( const double aSubsectorVariableDemand,
         // Make sure that a new vintage technology exists for production.
         if( vintageIter != (*techIter)->getVintageEnd( aPeriod ) ) {
             (*vintageIter).second->production( mRegionName, mSectorName,
-                                            aSubsectorVariableDemand * shares[ techIter - mTechContainers.begin() ],
+                                            aSubsectorVariableDemand * (*techIter)->getNewVintageTechnology( aPeriod )->getShare( aPeriod ),
                                             aFixedOutputScaleFactor, aGDP, aPeriod );
             ++vintageIter;
         }
@@ -891,6 +920,31 @@ double Subsector::getShareWeight( const int period ) const {
     return mShareWeights[ period ];
 }
 
+/*! \brief Get the normalized share of the sector's new investment stored when
+*          the sector price was last calculated.
+* \param aPeriod Model period.
+* \return The stored normalized subsector share.
+* \sa setShare
+*/
+double Subsector::getShare( const int aPeriod ) const {
+    return mShare[ aPeriod ];
+}
+
+/*! \brief Store the normalized share of the sector's new investment.
+* \details The sector stores the shares it calculates along with its price so
+*          that the same shares can be used when the sector output is set
+*          without recalculating the discrete choice. The share is a state
+*          variable so the stored value always corresponds to the prices in
+*          the calculation which is currently active.
+* \param aShare The normalized subsector share.
+* \param aPeriod Model period.
+*/
+void Subsector::setShare( const double aShare, const int aPeriod ) {
+    /*! \pre The share is a valid normalized share. */
+    assert( util::isValidNumber( aShare ) && aShare >= 0 && aShare <= 1 );
+    mShare[ aPeriod ] = aShare;
+}
+
 /*! \brief returns Subsector output
 *
 * output summed every time to ensure consistency
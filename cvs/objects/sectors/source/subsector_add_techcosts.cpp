@@ -122,3 +122,17 @@ double SubsectorAddTechCosts::getPrice( const GDP* aGDP, const int aPeriod ) con
 	// Check for the condition where all technologies were fixed.
 	return ( subsectorPrice > 0 ) ? subsectorPrice : -1;
 }
+
+/*! \brief Calculate the subsector price and store the technology shares.
+*
+* The technology shares are still used to set output, but the price is the sum
+* of the technology costs as in getPrice.
+*
+* \param aGDP Regional GDP object.
+* \param aPeriod Model period
+* \return The subsector price.
+*/
+double SubsectorAddTechCosts::calcPrice( const GDP* aGDP, const int aPeriod ) {
+    Subsector::calcPrice( aGDP, aPeriod );
+    return getPrice( aGDP, aPeriod );
+}
@@ -236,7 +236,12 @@ double SupplySector::getPrice( const GDP* aGDP, const int aPeriod ) const {
 
 /*! \brief Calculate the final supply price.
 * \details Calculates shares for the sector and price for the supply sector, and
-*          then sets the price of the good into the marketplace.
+*          then sets the price of the good into the marketplace. Each subsector
+*          price is calculated once, which stores the technology shares, and the
+*          subsector shares are stored in the subsectors so that supply can
+*          reuse all of them instead of recalculating them. Subclasses which
+*          override getPrice to not use the subsector shares must also override
+*          this method and still have the subsectors calculate their prices.
 * \param aGDP The regional GDP container.
 * \param aPeriod The period in which to calculate the final supply price.
 */
@@ -245,10 +250,22 @@ void SupplySector::calcFinalSupplyPrice( const GDP* aGDP, const int aPeriod ){
     // before prices can be calculated.
     calcCosts( aPeriod );
 
+    // Calculate the prices and shares once and store the shares for use when
+    // setting output. The stored shares are state so they remain consistent
+    // with the prices during partial derivative calculations.
+    vector<double> subsecPrices( mSubsectors.size() );
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
+        subsecPrices[ i ] = mSubsectors[ i ]->calcPrice( aGDP, aPeriod );
+    }
+    const vector<double> subsecShares = calcSubsectorShares( subsecPrices, aGDP, aPeriod );
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
+        mSubsectors[ i ]->setShare( subsecShares[ i ], aPeriod );
+    }
+
     // Set the price into the market.
     Marketplace* marketplace = scenario->getMarketplace();
 
-    double avgMarginalPrice = getPrice( aGDP, aPeriod );
+    double avgMarginalPrice = calcPriceFromShares( subsecShares, subsecPrices );
 
     marketplace->setPrice( mName, mRegionName, avgMarginalPrice, aPeriod, true );
 }
@@ -273,12 +290,13 @@ void SupplySector::supply( const GDP* aGDP, const int aPeriod ) {
 
 	// Calculate the demand for new investment.
 	double newInvestment = max( marketDemand - fixedOutput, 0.0 );
-	const vector<double>& subsecShares = calcSubsectorShares( aGDP, aPeriod );
 
-	// This is where subsector and technology outputs are set
+	// This is where subsector and technology outputs are set. The subsector
+	// shares were stored when the sector price was calculated, which always
+	// happens before supply is calculated.
 	for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
 		// set subsector output from Sector demand
-		mSubsectors[ i ]->setOutput( subsecShares[ i ] * newInvestment, scaleFactor, aGDP, aPeriod );
+		mSubsectors[ i ]->setOutput( mSubsectors[ i ]->getShare( aPeriod ) * newInvestment, scaleFactor, aGDP, aPeriod );
 	}
 
 	const static bool debugChecking = Configuration::getInstance()->getBool( "debugChecking" );
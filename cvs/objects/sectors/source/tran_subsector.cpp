@@ -221,6 +221,24 @@ double TranSubsector::getPrice( const GDP* aGDP, const int aPeriod ) const {
     return Subsector::getPrice( aGDP, aPeriod );
 }
 
+/*! \brief Calculate the subsector price and store the technology shares it is
+*          based on.
+* \details Adds the value of time to the price calculated by the Subsector if
+*          it is included in the service price, in the same way as getPrice.
+* \param aGDP The regional GDP container.
+* \param aPeriod The model period.
+* \return The subsector price with or without value of time.
+*/
+double TranSubsector::calcPrice( const GDP* aGDP, const int aPeriod ) {
+    const double price = Subsector::calcPrice( aGDP, aPeriod );
+    if( mAddTimeValue ) {
+        // Save time value so can print out
+        mTimeValue = getTimeValue( aGDP, aPeriod );
+        return price + mTimeValue;
+    }
+    return price;
+}
+
 /*! \brief Get the time value for the period.
 * \param aGDP The regional GDP container.
 * \param aPeriod The model period.
@@ -46,9 +46,12 @@
  */
 
 #include <string>
+#include <map>
+#include <vector>
 #include <boost/numeric/ublas/matrix.hpp>
 #include "solution/util/include/solvable_nr_solution_info_filter.h"
 #include "solution/util/include/edfun.hpp"
+#include "solution/util/include/sparse_lu.hpp"
 
 #define UBLAS boost::numeric::ublas
 #if USE_LAPACK
@@ -83,7 +86,8 @@ public:
   LogBroyden(Marketplace *mktplc, World *world, CalcCounter *ccounter, int itmax=250,
              double ftol=1.0e-4) :
       SolverComponent(mktplc,world,ccounter), mMaxIter( itmax ), mFTOL( ftol ),
-      mLogPricep( true ) {}
+      mLogPricep( true ), mSparseJacobian( false ), mWarmStart( false ),
+      mWarmStartSavedEvals( 0 ) {}
   virtual ~LogBroyden() {}
 
   // SolverComponent methods
@@ -102,7 +106,15 @@ public:
 protected:
   //! Perform the Broyden's method iterations.
   int bsolve(VecFVec<double,double> &F, UBLAS::vector<double> &x, UBLAS::vector<double> &fx,
-             UBMATRIX &B, int &neval);
+             UBMATRIX &B, SparseColumnMatrix *Bsp, int &neval);
+  //! Seed the solution from the warm start cache if possible.
+  template<class MATRIX>
+  bool warmStart(LogEDFun &F, const SolutionInfoSet &aSolutionSet, const int aPeriod,
+                 UBLAS::vector<double> &x, UBLAS::vector<double> &fx, MATRIX &J, int &neval);
+  //! Save the solution in the warm start cache.
+  template<class MATRIX>
+  void saveWarmStart(const LogEDFun &F, const SolutionInfoSet &aSolutionSet, const int aPeriod,
+                     const UBLAS::vector<double> &x, const MATRIX &B);
   //! Additional logging for visualizing solver progress.
   void reportVec(const std::string &aname, const UBLAS::vector<double> &av, const std::vector<int> &amktids,
                  const std::vector<bool> &aissolvable);
@@ -125,6 +137,48 @@ protected:
 
   bool mLogPricep;              //<! flag indicating whether we should work in price or log-price
 
+  //! Flag indicating whether the Jacobian should be stored, updated, and factored
+  //! using only its structural nonzeros.  This requires the ED function to
+  //! report the pattern of each partial derivative.
+  bool mSparseJacobian;
+
+  //! Flag indicating whether solutions should be cached by period so that
+  //! solving the same period again, such as for each trial of a policy target,
+  //! can start from the previous prices and Jacobian.
+  bool mWarmStart;
+
+  /*!
+   * \brief The solution of a single period kept to warm start the next solve
+   *        of that period.
+   * \details Values are stored without the scaling applied by LogEDFun since the
+   *          scale factors are based on forecasts which change between solves.
+   */
+  struct WarmStartEntry {
+    //! The ids of the solvable markets in the order of the entries below.
+    std::vector<int> mMarketIDs;
+    //! The unscaled solution inputs (log-price or price).
+    UBLAS::vector<double> mX;
+    //! The unscaled Jacobian at the solution if it was solved with a dense Jacobian.
+    UBMATRIX mJ;
+    //! The unscaled Jacobian at the solution if it was solved with a sparse Jacobian.
+    SparseColumnMatrix mJsp;
+
+    bool getJacobian(const UBLAS::vector<double> &fxscl, const UBLAS::vector<double> &xscl,
+                     UBMATRIX &J) const;
+    bool getJacobian(const UBLAS::vector<double> &fxscl, const UBLAS::vector<double> &xscl,
+                     SparseColumnMatrix &J) const;
+    void setJacobian(const UBLAS::vector<double> &fxscl, const UBLAS::vector<double> &xscl,
+                     const UBMATRIX &B);
+    void setJacobian(const UBLAS::vector<double> &fxscl, const UBLAS::vector<double> &xscl,
+                     const SparseColumnMatrix &B);
+  };
+
+  //! The warm start cache by model period.
+  std::map<int, WarmStartEntry> mWarmStartCache;
+
+  //! Total number of model evaluations avoided by warm starts.
+  int mWarmStartSavedEvals;
+
   // These next two have to be class variables because we sometimes
   // have multiple logbroyden solvers operating.
   static int mLastPer;                 //<! used to detect when the period has changed, so we can reset mPerIter.
@@ -68,6 +68,7 @@
 #include "solution/util/include/ublas-helpers.hpp"
 #include "util/base/include/fltcmp.hpp"
 #include "solution/util/include/jacobian-precondition.hpp"
+#include "solution/util/include/sparse_lu.hpp"
 
 #if USE_LAPACK
 #include <boost/numeric/bindings/traits/ublas_vector.hpp>
@@ -159,6 +160,12 @@ bool LogBroyden::XMLParse( const DOMNode* aNode ) {
         else if(nodeName == "log-price") {
           mLogPricep = true;    // not strictly necessary, as this is the default.
         }
+        else if(nodeName == "sparse-jacobian") {
+          mSparseJacobian = true;
+        }
+        else if(nodeName == "warm-start") {
+          mWarmStart = true;
+        }
         else if( SolutionInfoFilterFactory::hasSolutionInfoFilter( nodeName ) ) {
             mSolutionInfoFilter.reset( SolutionInfoFilterFactory::createAndParseSolutionInfoFilter( nodeName, curr ) );
         }
@@ -292,11 +299,52 @@ SolverComponent::ReturnCode LogBroyden::solve(SolutionInfoSet &solnset, int peri
 
     // Precondition the x values to avoid singular columns in the Jacobian
     solverLog.setLevel(ILogger::DEBUG);
-    UBMATRIX J(F.narg(), F.nrtn());
-    fdjac(F, x, fx, J, true);
+    // When configured, keep the Jacobian in sparse storage using the
+    // structure of the partial derivatives reported by F.  The dense
+    // Jacobian is then never built.
+    // The structure is checked by fdjac the first time it is used for each
+    // period and set of solvable markets.  A structure found to be missing
+    // a dependency would silently drop derivatives so is not used.
+    const std::vector<std::vector<int> >* pattern = mSparseJacobian ? F.partialPattern() : 0;
+    bool sparsep = pattern && pattern->size() == nsolv && F.jacobianCheckStatus() != JACOBIAN_INVALID;
+    UBMATRIX J;
+    SparseColumnMatrix Jsp;
+    int pcfail;
+    if(sparsep) {
+      Jsp.setPattern(*pattern);
+      solverLog << "Using sparse jacobian with " << Jsp.nnz() << " structural nonzeros of "
+                << nsolv*nsolv << ".\n";
+      // Only start from a saved jacobian once the structure has been checked.
+      if(!mWarmStart || F.jacobianCheckStatus() != JACOBIAN_VALID ||
+         !warmStart(F, solnset, period, x, fx, Jsp, neval))
+      {
+        fdjac(F, x, fx, Jsp, true);
+      }
+      sparsep = F.jacobianCheckStatus() != JACOBIAN_INVALID;
+    }
+    if(sparsep) {
+      solverLog << ">>>> Main loop jacobian called.\n";
+      pcfail = jacobian_precondition(x, fx, Jsp, F, &solverLog, mLogPricep);
+    }
+    else {
+      if(mSparseJacobian) {
+        solverLog.setLevel(ILogger::WARNING);
+        if(pattern && pattern->size() == nsolv) {
+          solverLog << "Sparse jacobian requested but the structure of the jacobian is missing a dependency.  Using dense jacobian.\n";
+        }
+        else {
+          solverLog << "Sparse jacobian requested but the structure of the jacobian is not available.  Using dense jacobian.\n";
+        }
+        solverLog.setLevel(ILogger::DEBUG);
+      }
+      J.resize(F.narg(), F.nrtn(), false);
+      if(!mWarmStart || !warmStart(F, solnset, period, x, fx, J, neval)) {
+        fdjac(F, x, fx, J, true);
+      }
 
-    solverLog << ">>>> Main loop jacobian called.\n";
-    int pcfail = jacobian_precondition(x, fx, J, F, &solverLog, mLogPricep);
+      solverLog << ">>>> Main loop jacobian called.\n";
+      pcfail = jacobian_precondition(x, fx, J, F, &solverLog, mLogPricep);
+    }
 
     if( pcfail ) {
       solverLog.setLevel(ILogger::WARNING);
@@ -310,8 +358,16 @@ SolverComponent::ReturnCode LogBroyden::solve(SolutionInfoSet &solnset, int peri
     cSolInfo = &solnset;        // make available for log outputs
 
     // call the solver
-    int bstatus = bsolve(F, x, fx, J, neval);
+    int bstatus = bsolve(F, x, fx, J, sparsep ? &Jsp : 0, neval);
     mPerIter++;                 // increment the iteration count.  This should produce a visible gap in the trace plots.
+    if(mWarmStart && bstatus == 0) {
+      if(sparsep) {
+        saveWarmStart(F, solnset, period, x, Jsp);
+      }
+      else {
+        saveWarmStart(F, solnset, period, x, J);
+      }
+    }
 
     solverTimer.stop(); 
 
@@ -367,7 +423,7 @@ SolverComponent::ReturnCode LogBroyden::solve(SolutionInfoSet &solnset, int peri
 }
 
 int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
-                       UBMATRIX & B, int &neval)
+                       UBMATRIX & B, SparseColumnMatrix *Bsp, int &neval)
 {
 #if !USE_LAPACK
   using boost::numeric::ublas::permutation_matrix;
@@ -376,17 +432,21 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
 #endif
   using boost::numeric::ublas::axpy_prod;
   using boost::numeric::ublas::inner_prod;
-  int nrow = B.size1(), ncol = B.size2();
+  // In sparse mode B is kept only in Bsp and the dense B and its work space
+  // are left empty.
+  const bool sparsep = Bsp != 0;
+  int nrow = F.nrtn(), ncol = F.narg();
+  int ndense = sparsep ? 0 : ncol;
   int ageB = 0;   // number of iterations since the last reset on B
   // svd decomposition elements (note nrow == ncol)
 #if USE_LAPACK
-  UBMATRIX Usv(nrow,ncol),VTsv(ncol,ncol);
-  UBVECTOR Ssv( ncol );
+  UBMATRIX Usv(ndense,ndense),VTsv(ndense,ndense);
+  UBVECTOR Ssv( ndense );
 #else
-  permutation_matrix<int> p(F.narg()); // permutation vector for pivoting in L-U decomposition
+  permutation_matrix<int> p(ndense); // permutation vector for pivoting in L-U decomposition
 #endif
 
-  UBMATRIX Btmp(nrow, ncol);
+  UBMATRIX Btmp(ndense, ndense);
   ILogger &solverLog = ILogger::getLogger("solver_log");
   ILogger& worstMarketLog = ILogger::getLogger( "worst_market_log" );
   worstMarketLog.setLevel( ILogger::DEBUG );
@@ -414,6 +474,9 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
   F(x,fx);
 
   solverLog.setLevel(ILogger::DEBUG);
+  // Formatting whole vectors is expensive, even when the log would discard them,
+  // so check ahead of time whether the per-iteration dumps below will be printed.
+  const bool logVectors = solverLog.wouldPrint(ILogger::DEBUG);
   
   neval += 1 + x.size();        // initial function evaluation + jacobian calculations
 
@@ -426,6 +489,9 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
   assert(x.size() == F.narg());
   assert(fx.size() == F.nrtn());
   UBVECTOR jdiag(F.narg());
+
+  SparseLU Blu;
+
   // do the asserts manually, since we can't turn on normal assertions
   // (GCAM is riddled with asserts that fail under normal
   // circumstances).
@@ -459,19 +525,26 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
     for(int j=0;j<F.narg();++j) {
       // double bjj= B(j,j);
       // jdiag[j] = bjj;
-      jdiag[j] = B(j,j);
+      jdiag[j] = sparsep ? Bsp->diag(j) : B(j,j);
     }
     static_cast<LogEDFun&>(F).setSlope(jdiag);
     double jdmax=0.0, jdmin=0.0;
     int jdjmax=0, jdjmin=0;
     locate_vector_minmax(jdiag, jdmax, jdmin, jdjmax, jdjmin);
-    solverLog << "diag( B ):\n" << jdiag << "\n";
+    if(logVectors) {
+      solverLog << "diag( B ):\n" << jdiag << "\n";
+    }
     solverLog << "maxval= " << jdmax << " jmax= " << jdjmax << "  "
               << "minval= " << jdmin << "  jmin= " << jdjmin << "\n";
     
-    axpy_prod(fx,B,gx);         // compute the gradient of F*F (= fx^T * B == B^T * fx)
+    if(sparsep) {
+      Bsp->trans_prod(fx,gx);    // compute the gradient of F*F (= B^T * fx)
+    }
+    else {
+      axpy_prod(fx,B,gx);       // compute the gradient of F*F (= fx^T * B == B^T * fx)
                                 // axpy_prod clears gx on entry, so we don't have to do it.
                                 // NB: the order of fx and B in that last call is significant!
+    }
 
     // Check for zero gradient.  This indicates a local minimum in f,
     // from which we are unlikely to escape.  We will need to try
@@ -483,79 +556,113 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       return -3;
     }
 
-    Btmp = B;                   // save the jacobian approximant
-#if USE_LAPACK /* Solve using SVD */
-    int ierr = boost::numeric::bindings::lapack::gesvd('O','A','A', // control parameters
-                                                       B,           // input matrix
-                                                       Ssv,Usv,VTsv); // outputs
-    if(ierr>0) {
-      // svd failed.  It's not even clear under what circumstances
-      // this can happen
-      solverLog.setLevel(ILogger::SEVERE);
-      solverLog << "****************SVD failed.  This shouldn't happen.  It can't mean anything good.\n";
-      return ierr;
+    if(sparsep) {
+      // Factor B, attempting to salvage it with the jacobian preconditioner
+      // once if it is singular, just as the dense L-U decomposition below.
+      int sing = Blu.factorize(*Bsp);
+      if(sing>0) {
+        solverLog << "Salvaging Jacobian.\n";
+        int fail = jacobian_precondition(x, fx, *Bsp, F, &solverLog, mLogPricep);
+        f0 = inner_prod(fx,fx);
+
+        // log the diagonal of the new jacobian
+        for(int j=0; j<F.narg(); ++j) {
+          jdiag[j] = Bsp->diag(j);
+        }
+        solverLog << "After jacobian salvage.  diag( B )=\n" << jdiag << "\n";
+        if(!fail) {
+          sing = Blu.factorize(*Bsp);
+          fail = sing;
+        }
+        if( fail ) {
+          solverLog.setLevel(ILogger::WARNING);
+          solverLog << "Singular Jacobian in column " << sing << ".\n";
+          return sing;
+        }
+      }
+      dx = -1.0*fx;
+      Blu.solve(dx);            // solve dx = J^-1 F
+      if(logVectors) {
+        solverLog << "dx: " << dx << "\n";
+      }
     }
+    else {
+      Btmp = B;                   // save the jacobian approximant
+#if USE_LAPACK /* Solve using SVD */
+      int ierr = boost::numeric::bindings::lapack::gesvd('O','A','A', // control parameters
+                                                         B,           // input matrix
+                                                         Ssv,Usv,VTsv); // outputs
+      if(ierr>0) {
+        // svd failed.  It's not even clear under what circumstances
+        // this can happen
+        solverLog.setLevel(ILogger::SEVERE);
+        solverLog << "****************SVD failed.  This shouldn't happen.  It can't mean anything good.\n";
+        return ierr;
+      }
 
-    // At this point, U, S, and VT contain the SVD of the original Jacobian
-    solverLog.setLevel(ILogger::DEBUG);
-    dx = -1.0*fx; 
-    int nsing = svdInvertSolve(Usv,Ssv,VTsv,dx, solverLog);
+      // At this point, U, S, and VT contain the SVD of the original Jacobian
+      solverLog.setLevel(ILogger::DEBUG);
+      dx = -1.0*fx; 
+      int nsing = svdInvertSolve(Usv,Ssv,VTsv,dx, solverLog);
 
-    solverLog << "\nIteration " << iter << "\nf0= " << f0
-              << "\tnsing= " << nsing
-              << "\nx: " << x << "\nF( x ): " << fx << "\ndx: " << dx << "\n";
+      solverLog << "\nIteration " << iter << "\nf0= " << f0
+                << "\tnsing= " << nsing
+                << "\nx: " << x << "\nF( x ): " << fx << "\ndx: " << dx << "\n";
 
 #else /* No USE_LAPACK.  Solve using L-U decomposition */
-    int itrial = 0;
-    /* If the L-U decomposition fails the first time around, we will
-       invoke the jacobian preconditioner and try again.  If it fails
-       a second time, we bail out */
-    do {
-      for(size_t i=0; i<p.size(); ++i) {
-        p[i] = i;
-      }
-      int sing = lu_factorize(B,p);
-      if(sing>0) {
-        int fail=1;
-        B = Btmp;           // restore Jacobian
-        if(itrial == 0) {
-            solverLog << "Salvaging Jacobian.\n";
-            fail = jacobian_precondition(x, fx, B, F, &solverLog, mLogPricep);
-            f0 = inner_prod(fx,fx);
-
-            // log the diagonal of the new jacobian
-            for(int j=0; j<F.narg(); ++j) {
-                jdiag[j] = B(j,j); 
-            }
-            solverLog << "After jacobian salvage.  diag( B )=\n" << jdiag << "\n";
-
+      int itrial = 0;
+      /* If the L-U decomposition fails the first time around, we will
+         invoke the jacobian preconditioner and try again.  If it fails
+         a second time, we bail out */
+      do {
+        for(size_t i=0; i<p.size(); ++i) {
+          p[i] = i;
         }
+        int sing = lu_factorize(B,p);
+        if(sing>0) {
+          int fail=1;
+          B = Btmp;           // restore Jacobian
+          if(itrial == 0) {
+              solverLog << "Salvaging Jacobian.\n";
+              fail = jacobian_precondition(x, fx, B, F, &solverLog, mLogPricep);
+              f0 = inner_prod(fx,fx);
+
+              // log the diagonal of the new jacobian
+              for(int j=0; j<F.narg(); ++j) {
+                  jdiag[j] = B(j,j); 
+              }
+              solverLog << "After jacobian salvage.  diag( B )=\n" << jdiag << "\n";
+
+          }
         
-        if( fail ) {
-            solverLog.setLevel(ILogger::WARNING);
-            solverLog << "Singular Jacobian:\n" << B << "\n";
-            return sing;
+          if( fail ) {
+              solverLog.setLevel(ILogger::WARNING);
+              solverLog << "Singular Jacobian:\n" << B << "\n";
+              return sing;
+          }
+        }
+        else {
+          // L-U decomp was successful.  Continue with the next phase of the algorithm.
+          break;
         }
+      } while(++itrial < 2);
+    
+      // J now holds the L-U decomposition of the Jacobian.  Attempt backsubstitution
+      dx = -1.0*fx;
+      try {
+        lu_substitute(B,p,dx);    // solve dx = J^-1 F
       }
-      else {
-        // L-U decomp was successful.  Continue with the next phase of the algorithm.
-        break;
+      catch (const boost::numeric::ublas::internal_logic &err) {
+        // This error seems to be thrown when the Jacobian is
+        // ill-conditioned.  We let it go because often the solver will
+        // muddle through to a solution.  If not, then it will
+        // eventually stop with a genuinely singular matrix.
+      }
+      if(logVectors) {
+        solverLog << "dx: " << dx << "\n";
       }
-    } while(++itrial < 2);
-    
-    // J now holds the L-U decomposition of the Jacobian.  Attempt backsubstitution
-    dx = -1.0*fx;
-    try {
-      lu_substitute(B,p,dx);    // solve dx = J^-1 F
-    }
-    catch (const boost::numeric::ublas::internal_logic &err) {
-      // This error seems to be thrown when the Jacobian is
-      // ill-conditioned.  We let it go because often the solver will
-      // muddle through to a solution.  If not, then it will
-      // eventually stop with a genuinely singular matrix.
-    }
-    solverLog << "dx: " << dx << "\n"; 
 #endif /* USE_LAPACK */
+    }
 
     // log the proposal step
     solverLog << "Proposal step magnitude dxmag= " << sqrt(inner_prod(dx,dx)) << "\n\n";
@@ -580,13 +687,18 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
         // call fdjac such that it re-calculates the model at x as linesearch will
         // have left off on some other price vector thus we could have bad state
         // data from which we calculate derivatives
-        fdjac(F,x,B);
+        if(sparsep) {
+          fdjac(F,x,*Bsp);
+        }
+        else {
+          fdjac(F,x,B);
+        }
         neval += x.size();
         ageB = 0;  // reset the age on B
 
         // Log the diagonal of the new jacobian after the failed line search
         for(int j=0; j<F.narg(); ++j) {
-            jdiag[j] = B(j,j);
+            jdiag[j] = sparsep ? Bsp->diag(j) : B(j,j);
         }
         solverLog << "New Jacobian: diag( B )=\n" << jdiag << "\n";
         static_cast<LogEDFun&>(F).setSlope(jdiag);
@@ -603,6 +715,11 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       if(msf < mFTOL) {
         // basically, we're letting ourselves converge to the sqrt of
         // our intended tolerance.
+        // B may have been factored in place so restore the Jacobian
+        // for the caller.
+        if(!sparsep) {
+          B = Btmp;
+        }
         return 0;
       }
 
@@ -629,7 +746,9 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
 
     UBVECTOR fxnew(fx.size());
     fnorm.lastF( fxnew );            // get the last value of big-F
-    solverLog << "\nxnew: " << xnew << "\nfxnew: " << fxnew << "\n";
+    if(logVectors) {
+      solverLog << "\nxnew: " << xnew << "\nfxnew: " << fxnew << "\n";
+    }
     UBVECTOR fxstep(fxnew -fx); // change in F( x ).  We will need this for the secant update
 
     // log the worst market info
@@ -660,6 +779,11 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       solverLog << "Solution successful.\n";
       x = xnew;
       fx = fxnew;
+      // B may have been factored in place so restore the Jacobian
+      // for the caller.
+      if(!sparsep) {
+        B = Btmp;
+      }
       return 0;                 // SUCCESS 
     }
 
@@ -689,12 +813,18 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
     // update B for next iteration
     double fratio_cutoff = 1.0 - 1.0/nrow;
     if(fnew/f0 < fratio_cutoff) { // making adequate progress with the Broyden formula
-      double dx2 = inner_prod(xstep,xstep);
-      UBVECTOR Bdx(F.nrtn());
-      B = Btmp;
-      fxstep -= axpy_prod(B, xstep, Bdx);
-      fxstep /= dx2;
-      B += outer_prod(fxstep, xstep);
+      if(sparsep) {
+        // use the secant update which preserves the sparsity of B
+        Bsp->broydenUpdate(fxstep, xstep);
+      }
+      else {
+        double dx2 = inner_prod(xstep,xstep);
+        UBVECTOR Bdx(F.nrtn());
+        B = Btmp;
+        fxstep -= axpy_prod(B, xstep, Bdx);
+        fxstep /= dx2;
+        B += outer_prod(fxstep, xstep);
+      }
       ageB++;                // increment the age of B
     }
     else {
@@ -705,13 +835,18 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
         solverLog << "Insufficient progress with Broyden formula.  Resetting the Jacobian.\n(f0= " << f0 << ", fnew= " << fnew << ")\n";
         // just in case call fdjac such that it re-calculates the model at xnew
         // otherwise we could have bad state data from which we calculate derivatives
-        fdjac(F,xnew,B);
+        if(sparsep) {
+          fdjac(F,xnew,*Bsp);
+        }
+        else {
+          fdjac(F,xnew,B);
+        }
         neval += x.size();
         ageB = 0;
 
         // Log the results of the Jacobian reset
         for(int j=0; j<F.narg(); ++j) {
-            jdiag[j] = B(j,j);
+            jdiag[j] = sparsep ? Bsp->diag(j) : B(j,j);
         }
             
         solverLog << "New Jacobian:  diag( B )=\n" << jdiag << "\n";
@@ -763,6 +898,150 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
  *           period, iteration, variable name, market id, solvable (T/F), value
  *
  */
+/*!
+ * \brief Seed the solution from the warm start cache.
+ * \details If the same markets were solved the last time this period was
+ *          solved then the cached solution is evaluated and used as the
+ *          starting point if it is better than the current one.  In either
+ *          case the cached Jacobian is rescaled and used in place of
+ *          calculating a finite difference Jacobian.
+ * \param F The ED function for the current solve.
+ * \param aSolutionSet The solution set being solved.
+ * \param aPeriod The model period.
+ * \param x The current inputs, which may be replaced by the cached solution.
+ * \param fx F( x ), which will be updated if x is replaced.
+ * \param J The Jacobian to fill in, either dense or sparse.  A sparse
+ *          Jacobian is only filled if the cached one has the same pattern.
+ * \param neval The model evaluation count to update.
+ * \return Whether J was filled from the cache.
+ */
+template<class MATRIX>
+bool LogBroyden::warmStart(LogEDFun &F, const SolutionInfoSet &aSolutionSet, const int aPeriod,
+                           UBVECTOR &x, UBVECTOR &fx, MATRIX &J, int &neval)
+{
+  std::map<int, WarmStartEntry>::const_iterator cacheIt = mWarmStartCache.find(aPeriod);
+  if(cacheIt == mWarmStartCache.end()) {
+    return false;
+  }
+  const WarmStartEntry &entry = (*cacheIt).second;
+  std::vector<int> mktids;
+  aSolutionSet.getMarketIDs(mktids, true);
+  ILogger &solverLog = ILogger::getLogger("solver_log");
+  if(mktids != entry.mMarketIDs) {
+    solverLog << "Solvable markets changed since the last solution for this period.  Not using warm start.\n";
+    return false;
+  }
+
+  const UBVECTOR &xscl = F.getInputScale();
+  const UBVECTOR &fxscl = F.getOutputScale();
+  const int nsolv = x.size();
+
+  if(!entry.getJacobian(fxscl, xscl, J)) {
+    solverLog << "The cached Jacobian does not match the current Jacobian storage.  Not using warm start.\n";
+    return false;
+  }
+
+  // try the previous solution as a starting point
+  UBVECTOR xc(nsolv), fxc(nsolv);
+  for(int i=0; i<nsolv; ++i) {
+    xc[i] = entry.mX[i] / xscl[i];
+  }
+  F(xc,fxc);
+  int usedEvals = 1;
+  if(inner_prod(fxc,fxc) < inner_prod(fx,fx)) {
+    solverLog << "Warm start: using the cached solution as the initial guess.\n";
+    x = xc;
+    fx = fxc;
+  }
+  else {
+    // reset the model state to the current guess
+    F(x,fx);
+    ++usedEvals;
+  }
+
+  neval += usedEvals;
+  mWarmStartSavedEvals += nsolv - usedEvals;
+  solverLog.setLevel(ILogger::NOTICE);
+  solverLog << "Warm start: using the cached Jacobian saved " << nsolv - usedEvals
+            << " model evaluations, " << mWarmStartSavedEvals << " in total.\n";
+  solverLog.setLevel(ILogger::DEBUG);
+  return true;
+}
+
+/*!
+ * \brief Save a solution to the warm start cache.
+ * \param F The ED function for the current solve.
+ * \param aSolutionSet The solution set which was solved.
+ * \param aPeriod The model period.
+ * \param x The solution.
+ * \param B The Jacobian at the solution, either dense or sparse.
+ */
+template<class MATRIX>
+void LogBroyden::saveWarmStart(const LogEDFun &F, const SolutionInfoSet &aSolutionSet, const int aPeriod,
+                               const UBVECTOR &x, const MATRIX &B)
+{
+  const UBVECTOR &xscl = F.getInputScale();
+  const UBVECTOR &fxscl = F.getOutputScale();
+  const int nsolv = x.size();
+
+  WarmStartEntry &entry = mWarmStartCache[aPeriod];
+  aSolutionSet.getMarketIDs(entry.mMarketIDs, true);
+  entry.mX.resize(nsolv, false);
+  for(int i=0; i<nsolv; ++i) {
+    entry.mX[i] = x[i] * xscl[i];
+  }
+  entry.setJacobian(fxscl, xscl, B);
+}
+
+//! Copy the cached dense Jacobian, rescaled, into J.
+bool LogBroyden::WarmStartEntry::getJacobian(const UBVECTOR &fxscl, const UBVECTOR &xscl, UBMATRIX &J) const
+{
+  const int nsolv = xscl.size();
+  if(static_cast<int>(mJ.size1()) != nsolv) {
+    return false;
+  }
+  for(int i=0; i<nsolv; ++i) {
+    for(int j=0; j<nsolv; ++j) {
+      J(i,j) = mJ(i,j) * fxscl[i] * xscl[j];
+    }
+  }
+  return true;
+}
+
+//! Copy the cached sparse Jacobian, rescaled, into J if it has the same pattern.
+bool LogBroyden::WarmStartEntry::getJacobian(const UBVECTOR &fxscl, const UBVECTOR &xscl,
+                                             SparseColumnMatrix &J) const
+{
+  if(!mJsp.samePattern(J)) {
+    return false;
+  }
+  J = mJsp;
+  J.scale(fxscl, xscl);
+  return true;
+}
+
+//! Store the unscaled dense Jacobian B, dropping any sparse one.
+void LogBroyden::WarmStartEntry::setJacobian(const UBVECTOR &fxscl, const UBVECTOR &xscl, const UBMATRIX &B)
+{
+  const int nsolv = xscl.size();
+  mJsp = SparseColumnMatrix();
+  mJ.resize(nsolv, nsolv, false);
+  for(int i=0; i<nsolv; ++i) {
+    for(int j=0; j<nsolv; ++j) {
+      mJ(i,j) = B(i,j) / (fxscl[i] * xscl[j]);
+    }
+  }
+}
+
+//! Store the unscaled sparse Jacobian B, dropping any dense one.
+void LogBroyden::WarmStartEntry::setJacobian(const UBVECTOR &fxscl, const UBVECTOR &xscl,
+                                             const SparseColumnMatrix &B)
+{
+  mJ.resize(0, 0, false);
+  mJsp = B;
+  mJsp.unscale(fxscl, xscl);
+}
+
 void LogBroyden::reportVec(const std::string &aname, const UBVECTOR &av, const std::vector<int> &amktids,
                            const std::vector<bool> &aissolvable)
 {
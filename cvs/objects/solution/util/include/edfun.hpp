@@ -44,6 +44,7 @@
 #include <map>
 #include <set>
 #include <vector>
+#include <string>
 #include "marketplace/include/marketplace.h"
 #include "containers/include/world.h"
 #include "solution/util/include/solution_info_set.h"
@@ -94,6 +95,7 @@ class LogEDFun : public VecFVec<double,double>
                        //!required.
   int period;
   bool mLogPricep;               //!< Flag indicating whether inputs are prices or log-prices
+  bool mSerialPartials;          //!< Flag indicating partial derivatives should not use market flow graphs
 
   // diagnostic variables
   std::vector<double> mstate;
@@ -104,8 +106,18 @@ public:
   virtual void operator()(const UBVECTOR<double> &x, UBVECTOR<double> &fx, const int partj=-1);
   virtual void partial(int ip);
   virtual double partialSize(int ip) const;
+  virtual const std::vector<std::vector<int> >* partialPattern() const;
+  virtual void partialGroup(const UBVECTOR<double> &x, UBVECTOR<double> &fx, const std::vector<int> &partjs);
+  virtual bool hasParallelPartials() const;
+  virtual void setSerialPartials(bool serial);
+  virtual JacobianCheckStatus jacobianCheckStatus() const;
+  virtual void setJacobianCheckStatus(JacobianCheckStatus status);
   void scaleInitInputs(UBVECTOR<double> &ax);
   void setSlope(UBVECTOR<double> &adx);
+  //! Scale factors applied to the inputs (x = xraw / xscl)
+  const UBVECTOR<double> &getInputScale() const {return mxscl;}
+  //! Scale factors applied to the outputs (fx = fxraw * fxscl)
+  const UBVECTOR<double> &getOutputScale() const {return mfxscl;}
 
   // Constants to protect against overflow: 
   static const double PMAX;            //!< Greatest allowable price
@@ -119,6 +131,18 @@ protected:
   UBVECTOR<double> mfxscl;
   // supply correction slope to use for prices below the "lower bound"
   UBVECTOR<double> slope;
+
+  //! Rows of the Jacobian which may be affected by each market, computed
+  //! on demand by partialPattern.
+  mutable std::vector<std::vector<int> > mPartialPattern;
+  //! Positions in the global ordering of the dependencies of each market,
+  //! used to merge the calculations for a group of partial derivatives.
+  mutable std::vector<std::vector<int> > mDependencyIndices;
+
+  void calcOutputs(const UBVECTOR<double> &x, UBVECTOR<double> &fx);
+  //! The period and names of the solvable markets under which the
+  //! result of the Jacobian check is kept.
+  std::pair<int, std::string> mJacobianCheckKey;
     
 };  
 
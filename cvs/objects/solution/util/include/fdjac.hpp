@@ -48,8 +48,11 @@
 
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
 #include "functor.hpp"
 #include <iostream>
+#include <vector>
+#include <algorithm>
 #include "solution/util/include/ublas-helpers.hpp"
 
 #define UBLAS boost::numeric::ublas
@@ -57,23 +60,57 @@
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/task_group.h>
 #include <tbb/parallel_for_each.h>
+#include <tbb/parallel_for.h>
+#include <atomic>
 #endif
 
 #include "util/base/include/timer.h"
 #include "containers/include/scenario.h"
 #include "util/base/include/manage_state_variables.hpp"
+#include "util/base/include/configuration.h"
+#include "util/logger/include/ilogger.h"
+#include "solution/util/include/sparse_lu.hpp"
 
 extern Scenario* scenario;
 
+/*!
+ * Store a column of finite difference derivatives into a dense Jacobian.
+ */
+template<class FTYPE,class MTRAIT>
+inline void fdjac_set_column(UBLAS::matrix<FTYPE,MTRAIT> &J, int j, const UBLAS::vector<FTYPE> &dfdx) {
+  for(size_t i=0; i<dfdx.size(); ++i) {
+    J(i,j) = dfdx[i];
+  }
+}
+
+/*!
+ * Store a column of finite difference derivatives into a sparse Jacobian.
+ * Only the rows in the sparsity pattern of the Jacobian are kept.
+ */
+inline void fdjac_set_column(SparseColumnMatrix &J, int j, const UBLAS::vector<double> &dfdx) {
+  J.setColumn(j, dfdx);
+}
+
+//! A dense Jacobian keeps every derivative.
+template<class FTYPE,class MTRAIT>
+inline bool fdjac_is_sparse(const UBLAS::matrix<FTYPE,MTRAIT> &J) {
+  return false;
+}
+
+//! A sparse Jacobian keeps only the derivatives in its pattern.
+inline bool fdjac_is_sparse(const SparseColumnMatrix &J) {
+  return true;
+}
+
 /*!
  * Compute a single column in a Jacobian matrix.  We have broken this
  * out from the fdjac subroutine so that we can easily test a single
  * column for nonsingularity without duplicating any code.
  */
-template<class FTYPE,class MTRAIT>
+template<class FTYPE,class MATRIX>
 inline void jacol(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
                   const UBLAS::vector<FTYPE> &fx, int j, 
-                  UBLAS::matrix<FTYPE,MTRAIT> &J,
+                  MATRIX &J,
                   bool usepartial=true, std::ostream *diagnostic=NULL) {
   const FTYPE heps = 1.0e-6;
   const FTYPE TINY = 1.0e-6;
@@ -99,8 +136,180 @@ inline void jacol(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
   // compute the finite difference derivatives
   FTYPE hinv = 1.0/h;
   for(size_t i=0; i<fxx.size(); ++i) {
-    J(i,j) = (fxx[i] - fx[i]) * hinv;
+    fxx[i] = (fxx[i] - fx[i]) * hinv;
   } 
+  fdjac_set_column(J, j, fxx);
+}
+
+
+/*!
+ * Partition the columns of a Jacobian into groups that can be
+ * computed from a single function evaluation.
+ * \details This is the Curtis-Powell-Reid scheme: two columns may share
+ *          a group only if there is no row in which both could be
+ *          nonzero, so that the change in each row of F can be attributed
+ *          to exactly one of the perturbed columns.  Columns are assigned
+ *          greedily, largest first, to the first group they fit in.
+ * \param[in] pattern: For each column, the rows which may be nonzero.
+ * \param[in] nrow: The number of rows in the Jacobian.
+ * \param[out] colors: The groups of columns.
+ */
+inline void fdjac_color(const std::vector<std::vector<int> > &pattern, size_t nrow,
+                        std::vector<std::vector<int> > &colors)
+{
+  std::vector<int> order(pattern.size());
+  for(size_t j=0; j<order.size(); ++j) {
+    order[j] = j;
+  }
+  std::stable_sort(order.begin(), order.end(), [&pattern](int a, int b) {
+      return pattern[a].size() > pattern[b].size();
+  });
+
+  colors.clear();
+  std::vector<std::vector<char> > rowUsed; // rows claimed by each group
+  for(size_t k=0; k<order.size(); ++k) {
+    const int j = order[k];
+    const std::vector<int> &rows = pattern[j];
+    size_t c = 0;
+    for(; c<colors.size(); ++c) {
+      bool fits = true;
+      for(size_t r=0; r<rows.size() && fits; ++r) {
+        fits = !rowUsed[c][rows[r]];
+      }
+      if(fits) {
+        break;
+      }
+    }
+    if(c == colors.size()) {
+      colors.push_back(std::vector<int>());
+      rowUsed.push_back(std::vector<char>(nrow, 0));
+    }
+    colors[c].push_back(j);
+    for(size_t r=0; r<rows.size(); ++r) {
+      rowUsed[c][rows[r]] = 1;
+    }
+  }
+}
+
+/*!
+ * Compute a group of columns in a Jacobian matrix which have been
+ * found to be structurally independent by fdjac_color.  All of the
+ * columns in the group are perturbed at once and the changes in F are
+ * unpacked into the columns using the sparsity pattern.
+ */
+template<class FTYPE,class MATRIX>
+inline void jacolor(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
+                    const UBLAS::vector<FTYPE> &fx, const std::vector<int> &group,
+                    const std::vector<std::vector<int> > &pattern,
+                    MATRIX &J, std::ostream *diagnostic=NULL) {
+  const FTYPE heps = 1.0e-6;
+  const FTYPE TINY = 1.0e-6;
+  UBLAS::vector<FTYPE> xx(x); // temporary, so we can respect the const on x
+  UBLAS::vector<FTYPE> fxx(fx.size());        // hold the values of F(xx)
+  std::vector<FTYPE> h(group.size());
+
+  for(size_t k=0; k<group.size(); ++k) {
+    const int j = group[k];
+    FTYPE t = xx[j];
+    xx[j] = t + heps * (fabs(t)+TINY);
+    h[k]  = xx[j]-t; // reduce roundoff error
+  }
+  if(diagnostic) {
+      (*diagnostic) << "group of " << group.size() << " starting with j= " << group[0]
+                    << "\nxx:\n" << xx << "\n";
+  }
+  F.partial(group[0]);   // hint to the function that this is a partial derivative calculation
+  F.partialGroup(xx, fxx, group);
+
+  if(diagnostic) {
+    (*diagnostic) << "fxx:\n" << fxx << "\n";
+  }
+
+  // unpack the finite difference derivatives, each row of fxx was changed
+  // by at most one of the columns in the group
+  UBLAS::vector<FTYPE> dfdx(fx.size());
+  for(size_t k=0; k<group.size(); ++k) {
+    const int j = group[k];
+    const std::vector<int> &rows = pattern[j];
+    FTYPE hinv = 1.0/h[k];
+    dfdx.clear();
+    for(size_t r=0; r<rows.size(); ++r) {
+      dfdx[rows[r]] = (fxx[rows[r]] - fx[rows[r]]) * hinv;
+    }
+    fdjac_set_column(J, j, dfdx);
+  }
+}
+
+
+/*!
+ * Check a Jacobian which relied on shortcuts allowed by F against the
+ * same Jacobian computed a column at a time with each partial derivative
+ * evaluated on a single thread, and record the result with F.  The
+ * shortcuts are using the sparsity pattern reported by F to group columns
+ * (see fdjac_color) or to decide which derivatives to keep, and
+ * evaluating a single partial derivative on several threads.  Neither can
+ * be checked structurally: the pattern must list every output that each
+ * input can change, and every calculation must be safe to run alongside
+ * the others in the same partial derivative.  If any element disagrees,
+ * including a nonzero outside of the pattern which a sparse J can not
+ * hold, a warning is logged, J is replaced with the checked values and F
+ * will report that the shortcuts should not be used.  Callers keeping a
+ * sparse J must then switch to a dense one.
+ * \param[in,out] F: The function the Jacobian was calculated for.
+ * \param[in,out] J: The Jacobian computed using the shortcuts.
+ * \param[in] Jcheck: The Jacobian computed without them.
+ * \param[in] fillFromCheck: Whether J was left to be filled from Jcheck
+ *            since it would have been computed the same way.
+ */
+template<class FTYPE,class MATRIX>
+inline void fdjac_check(VecFVec<FTYPE,FTYPE> &F, MATRIX &J, const UBLAS::matrix<FTYPE> &Jcheck,
+                        bool fillFromCheck)
+{
+  if(fillFromCheck) {
+    for(size_t j=0; j<Jcheck.size2(); ++j) {
+      fdjac_set_column(J, j, UBLAS::vector<FTYPE>(UBLAS::column(Jcheck, j)));
+    }
+  }
+
+  // Both calculations use the same step size so should only differ by
+  // roundoff in the order the contributions were summed.
+  const FTYPE RTOL = 1.0e-4;
+  const FTYPE ATOL = 1.0e-8;
+  int badRow = -1;
+  int badCol = -1;
+  for(size_t j=0; j<Jcheck.size2() && badCol < 0; ++j) {
+    FTYPE colmax = 0.0;
+    for(size_t i=0; i<Jcheck.size1(); ++i) {
+      colmax = std::max(colmax, FTYPE(fabs(Jcheck(i,j))));
+    }
+    for(size_t i=0; i<Jcheck.size1(); ++i) {
+      const FTYPE shortcut = J(i,j);
+      const FTYPE single = Jcheck(i,j);
+      if(fabs(shortcut - single) > RTOL * std::max(fabs(shortcut), fabs(single)) + ATOL * colmax) {
+        badRow = i;
+        badCol = j;
+        break;
+      }
+    }
+  }
+
+  if(badCol < 0) {
+    F.setJacobianCheckStatus(JACOBIAN_VALID);
+    return;
+  }
+
+  F.setJacobianCheckStatus(JACOBIAN_INVALID);
+  ILogger& solverLog = ILogger::getLogger( "solver_log" );
+  solverLog.setLevel( ILogger::WARNING );
+  solverLog << "fdjac: jacobian differs from the column at a time jacobian at row "
+            << badRow << " column " << badCol << " (" << J(badRow,badCol) << " vs "
+            << Jcheck(badRow,badCol) << ").  The partial derivative pattern is missing a"
+            << " dependency or a partial derivative is not safe to evaluate on several threads;"
+            << " colored, sparse and multithreaded partial derivatives are disabled for these"
+            << " markets in this period." << std::endl;
+  for(size_t j=0; j<Jcheck.size2(); ++j) {
+    fdjac_set_column(J, j, UBLAS::vector<FTYPE>(UBLAS::column(Jcheck, j)));
+  }
 }
 
 
@@ -116,9 +325,9 @@ inline void jacol(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
  *          therefore, any function making use of either of these functions should take care
  *          that the right convention is being used.
  */
-template <class FTYPE, class MTRAIT>
+template <class FTYPE, class MATRIX>
 void fdjac(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
-           UBLAS::matrix<FTYPE,MTRAIT> &J, bool usepartial=true)
+           MATRIX &J, bool usepartial=true)
 {
   UBLAS::vector<FTYPE> fx(F.nrtn());
 
@@ -132,14 +341,23 @@ void fdjac(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
  * \param[in] F: The function to have its Jacobian calculated
  * \param[in] x: The point at which to calculate the Jacobian
  * \param[in] fx: F(x)
- * \param[out] J: The Jacobian of F
+ * \param[out] J: The Jacobian of F, either a dense ublas matrix or a SparseColumnMatrix
+ *                 in which case only the derivatives in its pattern are stored.  The
+ *                 pattern of a sparse J is expected to be the one reported by F.
  * \param[in] usepartial: (optional) use partial model evaluation for partial derivatives
  * \param[in] diagnostic: (optional) ostream pointer to which to send additional diagnostics
- *
+ * \remark If the "colored-jacobian" configuration flag is set and F can report the
+ *         sparsity pattern of its partial derivatives then structurally independent
+ *         columns are grouped (see fdjac_color) and computed together.  In a
+ *         parallel build F may also evaluate a single partial derivative on
+ *         several threads.  Until F reports that these shortcuts were checked, a
+ *         Jacobian which relies on them is also computed a column at a time with
+ *         each partial derivative on a single thread to validate it (see
+ *         fdjac_check).  They are not used once F reports that they are invalid.
  */
-template<class FTYPE, class MTRAIT>
+template<class FTYPE, class MATRIX>
 void fdjac(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
-           const UBLAS::vector<FTYPE> &fx, UBLAS::matrix<FTYPE,MTRAIT> &J, bool usepartial=true,
+           const UBLAS::vector<FTYPE> &fx, MATRIX &J, bool usepartial=true,
            std::ostream *diagnostic=NULL)
 {
   if(diagnostic) {
@@ -149,24 +367,116 @@ void fdjac(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
 
   Timer& jacTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::JACOBIAN );
   jacTimer.start();
+  TimerRegistry::getInstance().getCounter( TimerRegistry::JACOBIAN_COUNT ).add( 1 );
     if(usepartial) { scenario->getManageStateVariables()->setPartialDeriv(true); }
+
+  // When the function can tell us which outputs each input affects we can
+  // optionally group structurally independent columns together and evaluate
+  // them at once.  This is only worth doing if it reduces the number of
+  // function evaluations.
+  static const bool useColoring =
+      Configuration::getInstance()->getBool( "colored-jacobian", false, false );
+  const bool sparse = fdjac_is_sparse(J);
+  const std::vector<std::vector<int> > *pattern = usepartial && (useColoring || sparse) ? F.partialPattern() : 0;
+  std::vector<std::vector<int> > colors;
+  const JacobianCheckStatus checkStatus = usepartial ? F.jacobianCheckStatus() : JACOBIAN_UNCHECKED;
+  if(useColoring && pattern && checkStatus != JACOBIAN_INVALID) {
+    fdjac_color(*pattern, fx.size(), colors);
+    ILogger& solverLog = ILogger::getLogger( "solver_log" );
+    solverLog.setLevel( ILogger::DEBUG );
+    solverLog << "fdjac: " << x.size() << " columns in " << colors.size() << " colors" << std::endl;
+    if(colors.size() >= x.size()) {
+      colors.clear();
+    }
+  }
+  // Check the shortcuts the first time they are relied on: using the
+  // pattern to group columns or to decide which derivatives to keep, and
+  // spreading a single partial derivative over several threads.
+#if GCAM_PARALLEL_ENABLED
+  const bool parallelPartials = usepartial && F.hasParallelPartials();
+#else
+  const bool parallelPartials = false;
+#endif
+  const bool check = checkStatus == JACOBIAN_UNCHECKED &&
+      ((pattern && (!colors.empty() || sparse)) || parallelPartials);
+  // If J would be computed no differently from the check it is filled from it.
+  const bool fillFromCheck = check && colors.empty() && !parallelPartials;
+  UBLAS::matrix<FTYPE> Jcheck;
+  if(check) {
+    Jcheck.resize(fx.size(), x.size());
+  }
   
 #if !GCAM_PARALLEL_ENABLED
-  for(size_t j=0; j<x.size(); ++j) {
-    jacol(F, x, fx, j, J, usepartial, diagnostic);
+  if(!colors.empty()) {
+    for(size_t c=0; c<colors.size(); ++c) {
+      jacolor(F, x, fx, colors[c], *pattern, J, diagnostic);
+    }
+  }
+  else if(!fillFromCheck) {
+    for(size_t j=0; j<x.size(); ++j) {
+      jacol(F, x, fx, j, J, usepartial, diagnostic);
+    }
+  }
+  if(check) {
+    for(size_t j=0; j<x.size(); ++j) {
+      jacol(F, x, fx, j, Jcheck, usepartial, fillFromCheck ? diagnostic : 0);
+    }
   }
 #else
+    // Hand out the columns largest first so that the columns which
+    // affect most of the model are started early rather than being
+    // left running on their own at the end.  Once there are no more
+    // columns to start idle threads help finish the large columns
+    // which have their own flow graphs.
+    std::vector<int> columnOrder(x.size());
+    for(size_t j=0; j<columnOrder.size(); ++j) {
+        columnOrder[j] = j;
+    }
+    if(usepartial) {
+        std::vector<double> columnSize(x.size());
+        for(size_t j=0; j<columnSize.size(); ++j) {
+            columnSize[j] = F.partialSize(j);
+        }
+        std::stable_sort(columnOrder.begin(), columnOrder.end(), [&columnSize](int a, int b) {
+            return columnSize[a] > columnSize[b];
+        });
+    }
+    auto computeColumns = [&](auto &Jout) {
+        std::atomic<size_t> nextColumn(0);
+        tbb::parallel_for(0, ManageStateVariables::getMaxConcurrency(), [&](int) {
+            for(size_t k = nextColumn++; k < columnOrder.size(); k = nextColumn++) {
+                jacol(F, x, fx, columnOrder[k], Jout, usepartial, 0/*diagnostic*/);
+            }
+        });
+    };
+
     tbb::task_arena& threadPool = scenario->getManageStateVariables()->mThreadPool;
     tbb::task_group tg;
     threadPool.execute([&](){
         tg.run([&](){
-            tbb::parallel_for_each( x, [&]( const FTYPE& j ) {
-                jacol(F, x, fx, (&j - &x[0]), J, usepartial, 0/*diagnostic*/);
-            });
+            if(!colors.empty()) {
+                tbb::parallel_for_each( colors.begin(), colors.end(), [&]( const std::vector<int>& group ) {
+                    jacolor(F, x, fx, group, *pattern, J, 0/*diagnostic*/);
+                });
+            }
+            else if(!fillFromCheck) {
+                computeColumns(J);
+            }
+            if(check) {
+                // The check evaluates each partial derivative on a single
+                // thread as every column did before markets were given their
+                // own flow graphs.
+                F.setSerialPartials(true);
+                computeColumns(Jcheck);
+                F.setSerialPartials(false);
+            }
         });
     });
     threadPool.execute([&tg](){ tg.wait(); });
 #endif
+  if(check) {
+    fdjac_check(F, J, Jcheck, fillFromCheck);
+  }
     if(usepartial) { F.partial(-1); }
 
   jacTimer.stop();
@@ -45,10 +45,21 @@
  */
 
 #include <iostream>
+#include <vector>
 #include <boost/numeric/ublas/vector.hpp> 
 
 #define UBVECTOR boost::numeric::ublas::vector
 
+/*!
+ * @brief The result of checking the Jacobian shortcuts a function allows
+ *        against a Jacobian calculated without them.
+ */
+enum JacobianCheckStatus {
+  JACOBIAN_UNCHECKED,
+  JACOBIAN_VALID,
+  JACOBIAN_INVALID
+};
+
 /*!
  * @class VecFVec
  * @brief Base class template for vector function of a vector argument 
@@ -110,6 +121,73 @@ public:
    * derivative.
    */
   virtual double partialSize(int ip) const {return 1.0;}
+  /*!
+   * Returns the structural sparsity of the partial derivatives, if known.
+   *
+   * Element j of the returned pattern lists the indices of the return
+   * vector that may change when element j of the input vector
+   * changes.  Each list must include j itself.  Subroutines like
+   * fdjac can use this to perturb structurally independent inputs
+   * together and evaluate several partial derivatives with a single
+   * call to partialGroup.  The default implementation reports that no
+   * structure is known.
+   *
+   * \return A pointer to the pattern or null if it is unknown.
+   */
+  virtual const std::vector<std::vector<int> >* partialPattern() const {return 0;}
+  /*!
+   * Evaluates the function for a partial derivative calculation in
+   * which all of the elements in partjs have changed at once.
+   *
+   * The caller should give the partial() hint for one of the elements
+   * before calling this method.  The default implementation ignores
+   * the grouping and does a full evaluation.
+   *
+   * \param[in] arg: argument vector
+   * \param[out] rval: return value vector
+   * \param[in] partjs: indices of the elements of arg which have changed
+   */
+  virtual void partialGroup(const UBVECTOR<Ta> &arg, UBVECTOR<Tr> &rval, const std::vector<int> &partjs) {
+    (*this)(arg, rval, partjs.size() == 1 ? partjs[0] : -1);
+  }
+  /*!
+   * Indicates whether a partial derivative evaluation may be spread
+   * over several threads.  The default implementation reports that it
+   * is not.
+   */
+  virtual bool hasParallelPartials() const {return false;}
+  /*!
+   * Requests that each partial derivative evaluation runs on the
+   * calling thread only, or allows it to be spread over several
+   * threads again.  The default implementation ignores the request.
+   *
+   * \param serial: Whether to evaluate partial derivatives on a single thread.
+   */
+  virtual void setSerialPartials(bool serial) {}
+  /*!
+   * Returns whether a Jacobian calculated using the pattern reported
+   * by partialPattern, or with partial derivatives spread over several
+   * threads, was found to match one calculated a column at a time with
+   * each partial derivative on a single thread.
+   *
+   * Neither shortcut can be checked structurally, so subroutines like
+   * fdjac check the first Jacobian that uses them and stop using them
+   * if it does not match.  The default implementation reports that no
+   * check was done.
+   */
+  virtual JacobianCheckStatus jacobianCheckStatus() const {return JACOBIAN_UNCHECKED;}
+  /*!
+   * Records the result of checking a Jacobian calculated using the
+   * pattern reported by partialPattern or with partial derivatives
+   * spread over several threads.
+   *
+   * Implementations should keep the result for as long as the pattern
+   * is expected to hold, and no longer.  The default implementation
+   * ignores it, so that the check is repeated on every Jacobian.
+   *
+   * \param status: The result of the check.
+   */
+  virtual void setJacobianCheckStatus(JacobianCheckStatus status) {}
   /*!
    * Turns on implementation-defined diagnostics (default is no-op)
    */
@@ -35,6 +35,7 @@
 
 #include <boost/numeric/ublas/lu.hpp>
 #include "solution/util/include/functor-subs.hpp"
+#include "solution/util/include/sparse_lu.hpp"
 
 #if USE_LAPACK
 #define UBMATRIX boost::numeric::ublas::matrix<double,boost::numeric::ublas::column_major>
@@ -47,6 +48,9 @@
 int jacobian_precondition(UBVECTOR &x, UBVECTOR &fx, UBMATRIX &J, VecFVec<double,double> &F,
                           std::ostream *diagnostic=0, bool logpricep=true, double FTOL=1.0e-4);
 
+int jacobian_precondition(UBVECTOR &x, UBVECTOR &fx, SparseColumnMatrix &J, VecFVec<double,double> &F,
+                          std::ostream *diagnostic=0, bool logpricep=true, double FTOL=1.0e-4);
+
 void broyden_singular_B_reset(UBVECTOR &x, UBVECTOR &fx, UBMATRIX &B, VecFVec<double,double> &F,
                              std::ostream *diagnostic, double FTOL=1.0e-4);
 
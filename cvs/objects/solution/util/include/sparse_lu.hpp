@@ -0,0 +1,200 @@
+#ifndef SPARSE_LU_HPP_
+#define SPARSE_LU_HPP_
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*!
+ * \file sparse_lu.hpp
+ * \ingroup Solution
+ * \brief Sparse Jacobian storage and L-U factorization for the Broyden solver.
+ * \details The solver Jacobians for large numbers of markets are mostly
+ *          structurally zero since most markets only influence a handful of
+ *          others.  These classes allow the Broyden solver to store only the
+ *          structural nonzeros, update them with a sparsity preserving secant
+ *          formula, and factorize them without the O(n^3) cost of a dense L-U.
+ */
+
+#include <vector>
+#include <boost/numeric/ublas/vector.hpp>
+
+/*!
+ * \ingroup Solution
+ * \brief A square matrix stored in compressed sparse column (CSC) format.
+ * \details The sparsity pattern is fixed when the matrix is created and every
+ *          value outside of it is taken to be exactly zero.  The diagonal is
+ *          always included in the pattern.
+ */
+class SparseColumnMatrix {
+public:
+  SparseColumnMatrix():mN(0) {}
+  
+  void setPattern(const std::vector<std::vector<int> > &pattern);
+  
+  //! Number of rows (and columns) in the matrix.
+  int size() const {return mN;}
+  
+  //! Number of structural nonzeros stored.
+  int nnz() const {return mVal.size();}
+  
+  double diag(int j) const;
+  
+  double operator()(int i, int j) const;
+  
+  bool samePattern(const SparseColumnMatrix &other) const;
+  
+  //! Set column j from a dense vector, ignoring the rows outside of the pattern.
+  template <class VectorType>
+  void setColumn(int j, const VectorType &values);
+  
+  //! Copy the values in the sparsity pattern from a dense matrix.
+  template <class MatrixType>
+  void assignFromDense(const MatrixType &dense);
+  
+  //! Copy the values into a dense matrix, setting all other entries to zero.
+  template <class MatrixType>
+  void copyToDense(MatrixType &dense) const;
+  
+  void prod(const boost::numeric::ublas::vector<double> &v, boost::numeric::ublas::vector<double> &rslt) const;
+  
+  void trans_prod(const boost::numeric::ublas::vector<double> &v, boost::numeric::ublas::vector<double> &rslt) const;
+  
+  void broydenUpdate(const boost::numeric::ublas::vector<double> &df, const boost::numeric::ublas::vector<double> &dx);
+  
+  void scale(const boost::numeric::ublas::vector<double> &rowscl, const boost::numeric::ublas::vector<double> &colscl);
+  
+  void unscale(const boost::numeric::ublas::vector<double> &rowscl, const boost::numeric::ublas::vector<double> &colscl);
+  
+private:
+  friend class SparseLU;
+  
+  //! Number of rows and columns
+  int mN;
+  
+  //! Offset into mRowInd and mVal of the start of each column, with mN+1 entries.
+  std::vector<int> mColPtr;
+  
+  //! The row of each stored value, sorted within each column.
+  std::vector<int> mRowInd;
+  
+  //! The stored values.
+  std::vector<double> mVal;
+  
+  //! Offset into mVal of the diagonal element of each column.
+  std::vector<int> mDiagPtr;
+};
+
+/*!
+ * \ingroup Solution
+ * \brief Left-looking sparse L-U factorization with partial pivoting.
+ * \details Factors P*A = L*U one column at a time by solving a sparse triangular
+ *          system with the columns of L found so far (Gilbert & Peierls, 1988).
+ *          The pivot for each column is the diagonal element if it is within
+ *          a threshold of the largest candidate, which tends to preserve the
+ *          sparsity of the largely diagonally dominant solver Jacobians, and
+ *          the largest candidate otherwise.  Columns are not reordered.
+ */
+class SparseLU {
+public:
+  SparseLU():mN(0) {}
+  
+  int factorize(const SparseColumnMatrix &A, double pivtol=0.1);
+  
+  void solve(boost::numeric::ublas::vector<double> &b) const;
+  
+  //! Number of nonzeros in the L and U factors.
+  int nnz() const {return mLVal.size() + mUVal.size();}
+  
+private:
+  //! Number of rows and columns
+  int mN;
+  
+  //! The unit lower triangular factor in CSC format with the unit diagonal
+  //! stored first in each column.
+  std::vector<int> mLColPtr;
+  std::vector<int> mLRowInd;
+  std::vector<double> mLVal;
+  
+  //! The upper triangular factor in CSC format with the diagonal stored last
+  //! in each column.
+  std::vector<int> mUColPtr;
+  std::vector<int> mURowInd;
+  std::vector<double> mUVal;
+  
+  //! The pivot position of each row of the original matrix.
+  std::vector<int> mPinv;
+  
+  //! Work space for the factorization which is kept to avoid reallocating.
+  std::vector<double> mX;
+  std::vector<int> mReach;
+  std::vector<int> mStack;
+  std::vector<int> mPStack;
+  std::vector<int> mMark;
+  
+  //! Work space for solve to hold the permuted right hand side.
+  mutable boost::numeric::ublas::vector<double> mWork;
+  
+  int reach(const SparseColumnMatrix &A, int k);
+};
+
+template <class MatrixType>
+void SparseColumnMatrix::assignFromDense(const MatrixType &dense)
+{
+  for(int j=0; j<mN; ++j) {
+    for(int p=mColPtr[j]; p<mColPtr[j+1]; ++p) {
+      mVal[p] = dense(mRowInd[p], j);
+    }
+  }
+}
+
+template <class VectorType>
+void SparseColumnMatrix::setColumn(int j, const VectorType &values)
+{
+  for(int p=mColPtr[j]; p<mColPtr[j+1]; ++p) {
+    mVal[p] = values[mRowInd[p]];
+  }
+}
+
+template <class MatrixType>
+void SparseColumnMatrix::copyToDense(MatrixType &dense) const
+{
+  for(int j=0; j<mN; ++j) {
+    for(int i=0; i<mN; ++i) {
+      dense(i,j) = 0.0;
+    }
+    for(int p=mColPtr[j]; p<mColPtr[j+1]; ++p) {
+      dense(mRowInd[p], j) = mVal[p];
+    }
+  }
+}
+
+#endif // SPARSE_LU_HPP_
@@ -35,6 +35,9 @@
 #include <assert.h>
 #include <set>
 #include <vector>
+#include <map>
+#include <algorithm>
+#include <boost/dynamic_bitset.hpp>
 #include "solution/util/include/edfun.hpp"
 #include "util/base/include/fltcmp.hpp"
 #include "containers/include/iactivity.h"
@@ -60,11 +63,18 @@ LogEDFun::LogEDFun(SolutionInfoSet &sisin,
     solnset(sisin),
     world(w), mktplc(m), period(per),
     mLogPricep(aLogPricep),
+    mSerialPartials(false),
     slope(mkts.size(), 1.0)
 {
     na=nr=mkts.size();
     mdiagnostic=false;
 
+    mJacobianCheckKey.first = period;
+    for(int i=0; i<na; ++i) {
+        mJacobianCheckKey.second += mkts[i].getName();
+        mJacobianCheckKey.second += '\n';
+    }
+
     // set up the scale vectors
     mxscl.resize(na);
     mfxscl.resize(nr);          // note na==nr
@@ -129,7 +139,8 @@ void LogEDFun::partial(int ip)
     if(ip >= 0) {
         // We are about to perform partial derviatives so snap back *all* state
         // including prices/supplies/demands to a "base" state before we perform
-        // this partial derivative
+        // this partial derivative.  Only state changed by the previous partial
+        // derivative on this thread actually needs to be copied.
         scenario->mManageStateVars->copyState();
     }
     else if(ip == -1 ) {
@@ -148,6 +159,203 @@ double LogEDFun::partialSize(int ip) const
 }
 
 
+/*!
+ * \brief Determine which markets may be affected by a change in the price of
+ *        each market being solved.
+ * \details A market's supply and demand are only ever added to by activities
+ *          which depend on its price, and so are recalculated when its price
+ *          changes.  Therefore the price of market j can only affect market i
+ *          if the dependencies of j and of i have an activity in common.  This
+ *          relies on every activity which adds to a market also registering a
+ *          dependency on it, which is not checked here; fdjac validates the
+ *          first Jacobian which uses the pattern for each period and set of
+ *          solvable markets, see jacobianCheckStatus.  The
+ *          pattern is computed the first time it is requested and cached for
+ *          the life of this object since the dependencies do not change.
+ * \return For each market, the markets which may be affected by its price.
+ */
+const std::vector<std::vector<int> >* LogEDFun::partialPattern() const
+{
+  if(!mPartialPattern.empty() || mkts.empty()) {
+    return &mPartialPattern;
+  }
+
+  const std::vector<IActivity*>& globalOrdering = world->getGlobalOrdering();
+  std::map<const IActivity*, int> globalIndex;
+  for(size_t a=0; a<globalOrdering.size(); ++a) {
+    globalIndex[globalOrdering[a]] = a;
+  }
+
+  // for each activity record the set of markets which depend on it
+  std::vector<boost::dynamic_bitset<> > activityMarkets(globalOrdering.size(),
+                                                        boost::dynamic_bitset<>(mkts.size()));
+  mDependencyIndices.resize(mkts.size());
+  for(size_t j=0; j<mkts.size(); ++j) {
+    const std::vector<IActivity*>& deps = mkts[j].getDependencies();
+    mDependencyIndices[j].reserve(deps.size());
+    for(size_t k=0; k<deps.size(); ++k) {
+      std::map<const IActivity*, int>::const_iterator indexIt = globalIndex.find(deps[k]);
+      /* \invariant All dependencies are part of the global ordering */
+      assert(indexIt != globalIndex.end());
+      const int index = (*indexIt).second;
+      mDependencyIndices[j].push_back(index);
+      activityMarkets[index].set(j);
+    }
+  }
+
+  mPartialPattern.resize(mkts.size());
+  boost::dynamic_bitset<> affected(mkts.size());
+  for(size_t j=0; j<mkts.size(); ++j) {
+    affected.reset();
+    affected.set(j);
+    for(size_t k=0; k<mDependencyIndices[j].size(); ++k) {
+      affected |= activityMarkets[mDependencyIndices[j][k]];
+    }
+    for(size_t i=affected.find_first(); i!=boost::dynamic_bitset<>::npos; i=affected.find_next(i)) {
+      mPartialPattern[j].push_back(i);
+    }
+  }
+
+  return &mPartialPattern;
+}
+
+
+/*!
+ * \brief Get the result of checking the Jacobian shortcuts for this period and
+ *        set of solvable markets.
+ * \details The result is kept by the marketplace since a new LogEDFun is
+ *          created for each call to a solver.  The dependencies of a market do
+ *          not change within a scenario, however which technologies are active
+ *          and so which dependencies matter varies by period, and the pattern
+ *          depends on which markets are solvable, so the check is repeated when
+ *          either of these changes.
+ * \return The result of the check, or JACOBIAN_UNCHECKED if there was none.
+ */
+JacobianCheckStatus LogEDFun::jacobianCheckStatus() const
+{
+  std::map<std::pair<int, std::string>, int>::const_iterator statusIt =
+      mktplc->mJacobianCheckStatus.find(mJacobianCheckKey);
+  return statusIt == mktplc->mJacobianCheckStatus.end() ?
+      JACOBIAN_UNCHECKED : static_cast<JacobianCheckStatus>((*statusIt).second);
+}
+
+
+/*!
+ * \brief Record the result of checking the Jacobian shortcuts for this period
+ *        and set of solvable markets.
+ * \param status The result of the check.
+ */
+void LogEDFun::setJacobianCheckStatus(JacobianCheckStatus status)
+{
+  mktplc->mJacobianCheckStatus[mJacobianCheckKey] = status;
+}
+
+
+/*!
+ * \brief Determine if any partial derivative may be calculated on several
+ *        threads.
+ * \details This is the case for markets which were given their own flow graph
+ *          because their price affects a large part of the model.
+ * \return Whether any solvable market has a flow graph.
+ */
+bool LogEDFun::hasParallelPartials() const
+{
+#if GCAM_PARALLEL_ENABLED
+  for(size_t i=0; i<mkts.size(); ++i) {
+    if(mkts[i].getFlowGraph()) {
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+
+
+/*!
+ * \brief Set whether partial derivatives should be calculated without the
+ *        market flow graphs.
+ * \details fdjac sets this while calculating the Jacobian it checks the
+ *          multithreaded one against.  The flow graphs are also not used once
+ *          the check has failed for this period and set of solvable markets.
+ * \param serial Whether to calculate each partial derivative on a single thread.
+ */
+void LogEDFun::setSerialPartials(bool serial)
+{
+  mSerialPartials = serial;
+}
+
+
+/*!
+ * \brief Evaluate the model for a group of partial derivatives at once.
+ * \details The prices of all of the markets in the group are changed and the
+ *          union of their dependencies is calculated in the global order.  The
+ *          caller is responsible for ensuring the markets in the group do not
+ *          affect any common market (see partialPattern) so that the changes in
+ *          the outputs can be attributed to a single market.
+ * \param ax The inputs, which differ from the base state in the elements in partjs.
+ * \param fx The output vector to fill.
+ * \param partjs The markets whose prices have changed.
+ */
+void LogEDFun::partialGroup(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, const std::vector<int> &partjs)
+{
+  if(partjs.size() == 1) {
+    (*this)(ax, fx, partjs[0]);
+    return;
+  }
+  assert(ax.size() == mkts.size());
+  assert(fx.size() == mkts.size());
+  assert(!mDependencyIndices.empty());
+
+  Timer& edfunMiscTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::EDFUN_MISC );
+  Timer& edfunPreTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::EDFUN_PRE );
+  edfunMiscTimer.start();
+  edfunPreTimer.start();
+
+  UBVECTOR<double> x(ax.size());
+  for(unsigned int i=0; i<x.size(); ++i)
+      x[i] = ax[i]*mxscl[i];
+
+  mktplc->mIsDerivativeCalc = true;
+
+  if(mLogPricep) {
+    for(size_t i=0; i<x.size(); ++i) {
+      if(x[i] > ARGMAX)
+        mkts[i].setPrice(PMAX);
+      else
+        mkts[i].setPrice(exp(x[i])); // input vector = log(price)
+    }
+  }
+  else {
+    for(size_t k=0; k<partjs.size(); ++k) {
+      mkts[partjs[k]].setPrice(x[partjs[k]]);
+    }
+  }
+
+  // merge the dependencies of the group back into the global order
+  std::vector<int> calcIndices;
+  for(size_t k=0; k<partjs.size(); ++k) {
+    calcIndices.insert(calcIndices.end(), mDependencyIndices[partjs[k]].begin(),
+                       mDependencyIndices[partjs[k]].end());
+  }
+  std::sort(calcIndices.begin(), calcIndices.end());
+  calcIndices.erase(std::unique(calcIndices.begin(), calcIndices.end()), calcIndices.end());
+  const std::vector<IActivity*>& globalOrdering = world->getGlobalOrdering();
+  std::vector<IActivity*> affectedNodes(calcIndices.size());
+  for(size_t k=0; k<calcIndices.size(); ++k) {
+    affectedNodes[k] = globalOrdering[calcIndices[k]];
+  }
+  edfunMiscTimer.stop();
+  edfunPreTimer.stop();
+
+  Timer& evalPartTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::EVAL_PART );
+  evalPartTimer.start();
+  world->calc(period, affectedNodes);
+  evalPartTimer.stop();
+
+  calcOutputs(x, fx);
+}
+
+
 /*!
  * \brief Set the slope to use for the negative correction supply which
  *        is applied when prices are below the lower bound of supply behavior.
@@ -303,10 +511,26 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
     edfunPreTimer.stop();
     Timer& evalPartTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::EVAL_PART );
     evalPartTimer.start();
-    // Note even when running with GCAM_PARALLEL_ENABLED we still run in serial
-    // mode for partial derivatives.  This is because the loop over each partial
-    // derivative to run is a parallel_for.
+    // Note even when running with GCAM_PARALLEL_ENABLED we typically still run
+    // in serial mode for partial derivatives.  This is because the loop over each
+    // partial derivative to run is a parallel_for.  However markets which affect
+    // a large part of the model have their own flow graph so that idle threads
+    // may help finish them, unless fdjac has asked for serial partials or found
+    // that the flow graphs change the results.
+#if GCAM_PARALLEL_ENABLED
+    GcamFlowGraph* flowGraph = mSerialPartials ? 0 : mkts[partj].getFlowGraph();
+    if(flowGraph && jacobianCheckStatus() == JACOBIAN_INVALID) {
+      flowGraph = 0;
+    }
+    if(flowGraph) {
+      world->calc(period, flowGraph, &affectedNodes);
+    }
+    else {
+      world->calc(period, affectedNodes);
+    }
+#else
     world->calc(period, affectedNodes);
+#endif
     evalPartTimer.stop();
 
     if(mdiagnostic) {
@@ -319,7 +543,19 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
     }
   }
 
-  
+  calcOutputs(x, fx);
+}
+
+
+/*!
+ * \brief Collect the outputs from the solutionInfo objects after the model
+ *        has been evaluated and repack them in the output vector.
+ * \param x The scaled inputs which were set into the markets.
+ * \param fx The output vector to fill.
+ */
+void LogEDFun::calcOutputs(const UBVECTOR<double> &x, UBVECTOR<double> &fx)
+{
+  Timer& edfunMiscTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::EDFUN_MISC );
   edfunMiscTimer.start();
   Timer& edfunPostTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::EDFUN_POST );
   edfunPostTimer.start();
@@ -56,9 +56,12 @@
 
 
 /* ensure that markets going into a solver that uses a jacobian start
-   off in price regimes that produce nonsingular jacobians. */
-int jacobian_precondition(UBVECTOR &x, UBVECTOR &fx, UBMATRIX &J, VecFVec<double,double> &F,
-                          std::ostream *diagnostic, bool loginputsp, double FTOL)
+   off in price regimes that produce nonsingular jacobians.  Only the
+   diagonal of J is examined so the same algorithm serves for dense and
+   sparse jacobians. */
+template<class MATRIX>
+int jacobian_precondition_impl(UBVECTOR &x, UBVECTOR &fx, MATRIX &J, VecFVec<double,double> &F,
+                               std::ostream *diagnostic, bool loginputsp, double FTOL)
 {
   const double JPCMIN = util::getVerySmallNumber(); // if max column value is less than this, the column is "singular".
   const double JPCLOGINCR = 1.0;   // corresponds to an e-fold increase in price if x is a log-price.  This must always be >0
@@ -219,3 +222,14 @@ void broyden_singular_B_reset(UBVECTOR &x, UBVECTOR &fx, UBMATRIX &B, VecFVec<do
     }
 }
 
+int jacobian_precondition(UBVECTOR &x, UBVECTOR &fx, UBMATRIX &J, VecFVec<double,double> &F,
+                          std::ostream *diagnostic, bool loginputsp, double FTOL)
+{
+  return jacobian_precondition_impl(x, fx, J, F, diagnostic, loginputsp, FTOL);
+}
+
+int jacobian_precondition(UBVECTOR &x, UBVECTOR &fx, SparseColumnMatrix &J, VecFVec<double,double> &F,
+                          std::ostream *diagnostic, bool loginputsp, double FTOL)
+{
+  return jacobian_precondition_impl(x, fx, J, F, diagnostic, loginputsp, FTOL);
+}
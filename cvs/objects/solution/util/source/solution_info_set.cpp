@@ -95,17 +95,28 @@ void SolutionInfoSet::init( const unsigned int aPeriod, const double aDefaultSol
     // Create and initialize a SolutionInfo object for each market.
     typedef vector<Market*>::const_iterator ConstMarketIterator;
     MarketDependencyFinder* depFinder = marketplace->getDependencyFinder();
+#if GCAM_PARALLEL_ENABLED
+    // Markets whose price affects at least this fraction of the model are given
+    // their own flow graph so that their partial derivatives may be calculated
+    // in parallel rather than holding up the rest of the Jacobian.
+    const static double flowGraphThreshold = Configuration::getInstance()->getDouble(
+        "partial-flow-graph-threshold", 0.25, false );
+    const double globalOrderingSize = static_cast<double>( depFinder->getOrdering().size() );
+#endif
     for( ConstMarketIterator iter = marketsToSolve.begin(); iter != marketsToSolve.end(); ++iter ){
         const bool isSolvable = (*iter)->isSolvable();
         const int marketNumber = iter - marketsToSolve.begin();
         const vector<IActivity*> partialList = isSolvable ? depFinder->getOrdering( marketNumber ) : vector<IActivity*>();
 #if GCAM_PARALLEL_ENABLED
-        // TODO: As it turns out the extra time generating these graphs does not typically
-        // get paid back in terms of time saved while calculating partial derivatives.  At
-        // least in a single scenario run.  We need to come up with some methodology to figure
-        // out when it is beneficial to do this or not until then we are not generating any.
+        // As it turns out the extra time generating these graphs does not typically
+        // get paid back in terms of time saved while calculating partial derivatives
+        // for most markets.  It only pays for the few markets which affect a large
+        // part of the model and would otherwise be the last partial derivatives left
+        // running.  Note the graphs are cached so they are only generated once.
+        const bool useFlowGraph = isSolvable &&
+            static_cast<double>( partialList.size() ) >= flowGraphThreshold * globalOrderingSize;
         SolutionInfo currInfo( *iter, partialList, 
-               /*isSolvable ? depFinder->getFlowGraph( marketNumber ) :*/ 0 );
+               useFlowGraph ? depFinder->getFlowGraph( marketNumber ) : 0 );
 #else
         SolutionInfo currInfo( *iter, partialList );
 #endif
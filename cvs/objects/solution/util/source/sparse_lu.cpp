@@ -0,0 +1,351 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*!
+ * \file sparse_lu.cpp
+ * \ingroup Solution
+ * \brief Sparse Jacobian storage and L-U factorization for the Broyden solver.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "solution/util/include/sparse_lu.hpp"
+
+/*!
+ * \brief Set the sparsity pattern of the matrix and zero all of its values.
+ * \param pattern For each column the rows which may be nonzero.  The diagonal
+ *                will be added if it is missing.
+ */
+void SparseColumnMatrix::setPattern(const std::vector<std::vector<int> > &pattern)
+{
+  mN = pattern.size();
+  mColPtr.assign(mN+1, 0);
+  mRowInd.clear();
+  mDiagPtr.assign(mN, -1);
+  for(int j=0; j<mN; ++j) {
+    std::vector<int> rows(pattern[j]);
+    if(std::find(rows.begin(), rows.end(), j) == rows.end()) {
+      rows.push_back(j);
+    }
+    std::sort(rows.begin(), rows.end());
+    for(size_t k=0; k<rows.size(); ++k) {
+      assert(rows[k] >= 0 && rows[k] < mN);
+      if(rows[k] == j) {
+        mDiagPtr[j] = mRowInd.size();
+      }
+      mRowInd.push_back(rows[k]);
+    }
+    mColPtr[j+1] = mRowInd.size();
+  }
+  mVal.assign(mRowInd.size(), 0.0);
+}
+
+//! Get the diagonal element of column j.
+double SparseColumnMatrix::diag(int j) const
+{
+  return mVal[mDiagPtr[j]];
+}
+
+/*!
+ * \brief Get the element in row i of column j.
+ * \return The stored value or zero if (i,j) is outside of the pattern.
+ */
+double SparseColumnMatrix::operator()(int i, int j) const
+{
+  const std::vector<int>::const_iterator begin = mRowInd.begin() + mColPtr[j];
+  const std::vector<int>::const_iterator end = mRowInd.begin() + mColPtr[j+1];
+  const std::vector<int>::const_iterator it = std::lower_bound(begin, end, i);
+  return it != end && *it == i ? mVal[it - mRowInd.begin()] : 0.0;
+}
+
+//! Check whether this matrix has the same sparsity pattern as another.
+bool SparseColumnMatrix::samePattern(const SparseColumnMatrix &other) const
+{
+  return mN == other.mN && mColPtr == other.mColPtr && mRowInd == other.mRowInd;
+}
+
+//! Compute rslt = A * v
+void SparseColumnMatrix::prod(const boost::numeric::ublas::vector<double> &v, boost::numeric::ublas::vector<double> &rslt) const
+{
+  assert(static_cast<int>(v.size()) == mN && static_cast<int>(rslt.size()) == mN);
+  rslt.clear();
+  for(int j=0; j<mN; ++j) {
+    const double vj = v[j];
+    for(int p=mColPtr[j]; p<mColPtr[j+1]; ++p) {
+      rslt[mRowInd[p]] += mVal[p]*vj;
+    }
+  }
+}
+
+//! Compute rslt = trans(A) * v
+void SparseColumnMatrix::trans_prod(const boost::numeric::ublas::vector<double> &v, boost::numeric::ublas::vector<double> &rslt) const
+{
+  assert(static_cast<int>(v.size()) == mN && static_cast<int>(rslt.size()) == mN);
+  for(int j=0; j<mN; ++j) {
+    double sum = 0.0;
+    for(int p=mColPtr[j]; p<mColPtr[j+1]; ++p) {
+      sum += mVal[p]*v[mRowInd[p]];
+    }
+    rslt[j] = sum;
+  }
+}
+
+/*!
+ * \brief Apply the sparsity preserving secant update of Schubert (1970).
+ * \details Each row i is updated as in Broyden's formula but using only the
+ *          components of dx in the sparsity pattern of that row:
+ *          B(i,:) += (df[i] - B(i,:) . dx) * dx_i / (dx_i . dx_i),
+ *          where dx_i is dx with the components outside of the pattern of row
+ *          i set to zero.  Rows with dx_i == 0 are left unchanged.
+ * \param df The change in F( x ) over the step.
+ * \param dx The step in x.
+ */
+void SparseColumnMatrix::broydenUpdate(const boost::numeric::ublas::vector<double> &df, const boost::numeric::ublas::vector<double> &dx)
+{
+  boost::numeric::ublas::vector<double> resid(mN), rowdx2(mN);
+  prod(dx, resid);
+  rowdx2.clear();
+  for(int j=0; j<mN; ++j) {
+    const double dxj2 = dx[j]*dx[j];
+    for(int p=mColPtr[j]; p<mColPtr[j+1]; ++p) {
+      rowdx2[mRowInd[p]] += dxj2;
+    }
+  }
+  for(int i=0; i<mN; ++i) {
+    resid[i] = rowdx2[i] > 0.0 ? (df[i] - resid[i]) / rowdx2[i] : 0.0;
+  }
+  for(int j=0; j<mN; ++j) {
+    for(int p=mColPtr[j]; p<mColPtr[j+1]; ++p) {
+      mVal[p] += resid[mRowInd[p]] * dx[j];
+    }
+  }
+}
+
+//! Multiply each element (i,j) by rowscl[i] * colscl[j].
+void SparseColumnMatrix::scale(const boost::numeric::ublas::vector<double> &rowscl,
+                               const boost::numeric::ublas::vector<double> &colscl)
+{
+  for(int j=0; j<mN; ++j) {
+    for(int p=mColPtr[j]; p<mColPtr[j+1]; ++p) {
+      mVal[p] = mVal[p] * rowscl[mRowInd[p]] * colscl[j];
+    }
+  }
+}
+
+//! Divide each element (i,j) by rowscl[i] * colscl[j].
+void SparseColumnMatrix::unscale(const boost::numeric::ublas::vector<double> &rowscl,
+                                 const boost::numeric::ublas::vector<double> &colscl)
+{
+  for(int j=0; j<mN; ++j) {
+    for(int p=mColPtr[j]; p<mColPtr[j+1]; ++p) {
+      mVal[p] /= rowscl[mRowInd[p]] * colscl[j];
+    }
+  }
+}
+
+/*!
+ * \brief Find the rows of L \ A(:,k) which may be nonzero.
+ * \details Does a depth first search from each nonzero in A(:,k) through the
+ *          graph of the columns of L found so far.  The result is stored in
+ *          mReach[top..mN-1] in topological order.
+ * \param A The matrix being factored.
+ * \param k The column being factored.
+ * \return The position of the first entry in mReach.
+ */
+int SparseLU::reach(const SparseColumnMatrix &A, int k)
+{
+  const int stamp = k+1;
+  int top = mN;
+  for(int p=A.mColPtr[k]; p<A.mColPtr[k+1]; ++p) {
+    if(mMark[A.mRowInd[p]] == stamp) {
+      continue;
+    }
+    int head = 0;
+    mStack[0] = A.mRowInd[p];
+    while(head >= 0) {
+      const int j = mStack[head];
+      const int jcol = mPinv[j];
+      if(mMark[j] != stamp) {
+        // first visit; skip the unit diagonal which is stored first
+        mMark[j] = stamp;
+        mPStack[head] = jcol < 0 ? 0 : mLColPtr[jcol]+1;
+      }
+      bool done = true;
+      const int pend = jcol < 0 ? 0 : mLColPtr[jcol+1];
+      for(int q=mPStack[head]; q<pend; ++q) {
+        const int i = mLRowInd[q];
+        if(mMark[i] == stamp) {
+          continue;
+        }
+        // descend into row i and resume this column from q+1 later
+        mPStack[head] = q+1;
+        mStack[++head] = i;
+        done = false;
+        break;
+      }
+      if(done) {
+        --head;
+        mReach[--top] = j;
+      }
+    }
+  }
+  return top;
+}
+
+/*!
+ * \brief Compute the L-U factorization of A.
+ * \param A The matrix to factor.
+ * \param pivtol Use the diagonal as the pivot if its magnitude is at least
+ *               this fraction of the largest candidate.
+ * \return 0 on success or the one based index of the first singular column
+ *         in the same manner as ublas::lu_factorize.
+ */
+int SparseLU::factorize(const SparseColumnMatrix &A, double pivtol)
+{
+  mN = A.size();
+  mLColPtr.assign(mN+1, 0);
+  mUColPtr.assign(mN+1, 0);
+  mLRowInd.clear();
+  mLVal.clear();
+  mURowInd.clear();
+  mUVal.clear();
+  mPinv.assign(mN, -1);
+  mX.assign(mN, 0.0);
+  mReach.resize(mN);
+  mStack.resize(mN);
+  mPStack.resize(mN);
+  mMark.assign(mN, 0);
+  
+  for(int k=0; k<mN; ++k) {
+    mLColPtr[k] = mLVal.size();
+    mUColPtr[k] = mUVal.size();
+    
+    // solve x = L \ A(:,k) in the rows reachable from A(:,k)
+    const int top = reach(A, k);
+    for(int p=top; p<mN; ++p) {
+      mX[mReach[p]] = 0.0;
+    }
+    for(int p=A.mColPtr[k]; p<A.mColPtr[k+1]; ++p) {
+      mX[A.mRowInd[p]] = A.mVal[p];
+    }
+    for(int px=top; px<mN; ++px) {
+      const int j = mReach[px];
+      const int jcol = mPinv[j];
+      if(jcol < 0) {
+        continue;
+      }
+      const double xj = mX[j];
+      for(int p=mLColPtr[jcol]+1; p<mLColPtr[jcol+1]; ++p) {
+        mX[mLRowInd[p]] -= mLVal[p] * xj;
+      }
+    }
+    
+    // the pivoted rows go into U, pick the pivot from the rest
+    int ipiv = -1;
+    double amax = -1.0;
+    for(int p=top; p<mN; ++p) {
+      const int i = mReach[p];
+      if(mPinv[i] < 0) {
+        const double t = fabs(mX[i]);
+        if(t > amax) {
+          amax = t;
+          ipiv = i;
+        }
+      }
+      else {
+        mURowInd.push_back(mPinv[i]);
+        mUVal.push_back(mX[i]);
+      }
+    }
+    if(ipiv == -1 || amax <= 0.0) {
+      return k+1;
+    }
+    if(mPinv[k] < 0 && mMark[k] == k+1 && fabs(mX[k]) >= amax*pivtol) {
+      ipiv = k;
+    }
+    
+    const double pivot = mX[ipiv];
+    mURowInd.push_back(k);
+    mUVal.push_back(pivot);
+    mPinv[ipiv] = k;
+    mLRowInd.push_back(ipiv);
+    mLVal.push_back(1.0);
+    for(int p=top; p<mN; ++p) {
+      const int i = mReach[p];
+      if(mPinv[i] < 0) {
+        mLRowInd.push_back(i);
+        mLVal.push_back(mX[i] / pivot);
+      }
+      mX[i] = 0.0;
+    }
+  }
+  mLColPtr[mN] = mLVal.size();
+  mUColPtr[mN] = mUVal.size();
+  
+  // convert the row indices of L to the pivoted order
+  for(size_t p=0; p<mLRowInd.size(); ++p) {
+    mLRowInd[p] = mPinv[mLRowInd[p]];
+  }
+  
+  return 0;
+}
+
+/*!
+ * \brief Solve A x = b using the factorization from the last call to factorize.
+ * \param b The right hand side, which will be replaced with the solution.
+ */
+void SparseLU::solve(boost::numeric::ublas::vector<double> &b) const
+{
+  assert(static_cast<int>(b.size()) == mN);
+  mWork.resize(mN, false);
+  for(int i=0; i<mN; ++i) {
+    mWork[mPinv[i]] = b[i];
+  }
+  // L y = P b
+  for(int j=0; j<mN; ++j) {
+    const double yj = mWork[j];
+    for(int p=mLColPtr[j]+1; p<mLColPtr[j+1]; ++p) {
+      mWork[mLRowInd[p]] -= mLVal[p] * yj;
+    }
+  }
+  // U x = y
+  for(int j=mN-1; j>=0; --j) {
+    mWork[j] /= mUVal[mUColPtr[j+1]-1];
+    const double xj = mWork[j];
+    for(int p=mUColPtr[j]; p<mUColPtr[j+1]-1; ++p) {
+      mWork[mURowInd[p]] -= mUVal[p] * xj;
+    }
+  }
+  b = mWork;
+}
@@ -137,6 +137,11 @@ protected:
     //! Weak pointer to the land leaf which corresponds to this technology
     //! used to save time finding it over and over
     ALandAllocatorItem* mProductLeaf;
+
+    //! Weak pointers by period to the regional subsidy stored in the market
+    //! info, resolved in initCalc so that the profit rate calculation does not
+    //! need to look it up by name.
+    objects::PeriodVector<const double*> mSubsidy;
     
     void copy( const AgProductionTechnology& aOther );
 
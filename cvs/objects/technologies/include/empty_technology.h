@@ -104,6 +104,10 @@ public:
     virtual double calcShare( const IDiscreteChoice* aChoiceFn,
                               const GDP *aGDP,
                               int aPeriod ) const;
+
+    virtual double getShare( const int aPeriod ) const;
+
+    virtual void setShare( const double aShare, const int aPeriod );
     
     virtual void calcCost( const std::string& aRegionName,
                           const std::string& aSectorName,
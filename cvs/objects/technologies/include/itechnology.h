@@ -145,6 +145,10 @@ public:
     virtual double calcShare( const IDiscreteChoice* aChoiceFn,
                               const GDP* aGDP,
                               int aPeriod ) const = 0;
+
+    virtual double getShare( const int aPeriod ) const = 0;
+
+    virtual void setShare( const double aShare, const int aPeriod ) = 0;
     
     virtual void calcCost( const std::string& aRegionName,
                            const std::string& aSectorName,
@@ -34,6 +34,8 @@
 #if !defined( __RESIDUEBIOMASSOUTPUT_H )
 #define __RESIDUEBIOMASSOUTPUT_H    // prevent multiple includes
 
+#include <memory>
+
 #include "technologies/include/ioutput.h"
 #include "util/base/include/value.h"
 #include "util/curves/include/cost_curve.h"
@@ -41,6 +43,7 @@
 
 class Curve;
 class ALandAllocatorItem;
+class CachedMarket;
 
 /*!
  * \ingroup objects::biomass
@@ -192,6 +195,10 @@ protected :
     //! used to save time finding it over and over
     ALandAllocatorItem* mProductLeaf;
     
+    //! A pre-located market which has been cached from the marketplace to add
+    //! supply to.
+    std::auto_ptr<CachedMarket> mCachedMarket;
+    
     void copy( const ResidueBiomassOutput& aOther );
 };
 
@@ -235,6 +235,11 @@ protected :
        //! Number of no sun days
        DEFINE_VARIABLE( SIMPLE, "no-sun-days", mNoSunDays, double )
     )
+
+    //! Weak pointer to the total annual irradiance stored in the resource
+    //! market info for the current period, resolved in initCalc. Null if the
+    //! resource does not define it, in which case a default is used.
+    const double* mTotalAnnualIrradiance;
     
     void copy( const SolarTechnology& aOther );
 
@@ -196,6 +196,10 @@ public:
     virtual double calcShare( const IDiscreteChoice* aChoiceFn,
                               const GDP* aGDP,
                               int aPeriod ) const;
+
+    double getShare( const int aPeriod ) const;
+
+    void setShare( const double aShare, const int aPeriod );
     
     virtual void calcCost( const std::string& aRegionName,
                            const std::string& aSectorName,
@@ -315,6 +319,14 @@ protected:
          */
         DEFINE_VARIABLE( ARRAY | STATE, "cost", mCosts, objects::TechVintageVector<Value> ),
 
+        /*!
+         * \brief The normalized share of the subsector's new investment.
+         * \note This is stored by the Subsector when it calculates its price so
+         *       that it does not need to be recalculated when output is set.
+         * \sa Subsector::calcPrice
+         */
+        DEFINE_VARIABLE( ARRAY | STATE, "share", mShare, objects::TechVintageVector<Value> ),
+
         //! A map of a keyword to its keyword group
         DEFINE_VARIABLE( SIMPLE, "keyword", mKeywordMap, std::map<std::string, std::string> ),
 
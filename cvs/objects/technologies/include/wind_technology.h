@@ -164,10 +164,10 @@ protected :
        double aDiameter,
        double aAirDensity );
 
-   /*! Compute the realized turbine output
-    *  \param apInfo pointer to the market info
+   /*! Compute the realized turbine output using the wind resource parameters
+    *  resolved from the resource market info in initCalc.
     */
-   virtual double calcRealizedTurbineOutput( const IInfo* apInfo ) const;
+   virtual double calcRealizedTurbineOutput() const;
 
    /*! Calculate the resource area in km^2
     *  \param aRegionName the region name
@@ -272,6 +272,14 @@ protected :
     
    //! Wind Power Variance
    mutable double mWindPowerVariance;
+
+   //! Weak pointers to the wind resource parameters stored in the resource
+   //! market info for the current period, resolved in initCalc so that costs
+   //! can be calculated without looking them up by name.
+   const double* mAveWindSpeed;
+   const double* mAirDensity;
+   const double* mReferenceHeight;
+   const double* mWindVelocityExponent;
     
     void copy( const WindTechnology& aOther );
 
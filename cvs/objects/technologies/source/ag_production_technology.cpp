@@ -179,6 +179,11 @@ void AgProductionTechnology::initCalc( const string& aRegionName,
 {
     Technology::initCalc( aRegionName, aSectorName, aSubsectorInfo,
                           aDemographics, aPrevPeriodInfo, aPeriod );
+
+    // Resolve the subsidy once per period as the profit rate is recalculated
+    // every iteration.
+    mSubsidy[ aPeriod ] = scenario->getMarketplace()->getMarketInfo( aSectorName, aRegionName, aPeriod, true )
+        ->resolveDouble( aRegionName + "subsidy", true );
   
     const Modeltime* modeltime = scenario->getModeltime();
 
@@ -486,7 +491,8 @@ double AgProductionTechnology::calcProfitRate( const string& aRegionName,
     double price = marketplace->getPrice( aProductName, aRegionName, aPeriod );
 
 	// subsidy in $/kg
-    double subsidy = marketplace->getMarketInfo( aProductName, aRegionName, aPeriod, true )->getDouble( aRegionName+"subsidy", true );
+    double subsidy = mSubsidy[ aPeriod ] ? *mSubsidy[ aPeriod ] :
+        marketplace->getMarketInfo( aProductName, aRegionName, aPeriod, true )->getDouble( aRegionName+"subsidy", true );
 
     // Compute cost of variable inputs (such as water and fertilizer)
     double inputCosts = getTotalInputCost( aRegionName, aProductName, aPeriod );
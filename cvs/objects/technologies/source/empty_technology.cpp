@@ -113,6 +113,15 @@ double EmptyTechnology::calcShare( const IDiscreteChoice* aChoiceFn,
     return -numeric_limits<double>::infinity();
 }
 
+double EmptyTechnology::getShare( const int aPeriod ) const
+{
+    return 0.0;
+}
+
+void EmptyTechnology::setShare( const double aShare, const int aPeriod )
+{
+}
+
 double EmptyTechnology::getFixedOutput( const string& aRegionName,
                                   const string& aSectorName,
                                   const bool aHasRequiredInput,
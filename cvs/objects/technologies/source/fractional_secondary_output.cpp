@@ -45,6 +45,7 @@
 #include "containers/include/scenario.h"
 #include "containers/include/iinfo.h"
 #include "marketplace/include/marketplace.h"
+#include "marketplace/include/cached_market.h"
 #include "util/base/include/ivisitor.h"
 #include "containers/include/market_dependency_finder.h"
 #include "functions/include/function_utils.h"
@@ -238,6 +239,8 @@ void FractionalSecondaryOutput::initCalc( const string& aRegionName,
     // the primary good's economics.
     SectorUtils::setSupplyBehaviorBounds( getName(), mMarketName.empty() ? aRegionName : mMarketName,
             mCostCurve->getMinX(), util::getLargeNumber(), aPeriod );
+    
+    mCachedMarket = scenario->getMarketplace()->locateMarket( mName, mMarketName.empty() ? aRegionName : mMarketName, aPeriod );
 }
 
 
@@ -270,8 +273,7 @@ void FractionalSecondaryOutput::setPhysicalOutput( const double aPrimaryOutput,
      * \warning Adding to supply of an intermediate good will not work as intended, in that case a
      *          regular SecondaryOutput should be used which will subtract from demand.
      */
-    Marketplace* marketplace = scenario->getMarketplace();
-    marketplace->addToSupply( mName, mMarketName.empty() ? aRegionName : mMarketName,
+    mCachedMarket->addToSupply( mName, mMarketName.empty() ? aRegionName : mMarketName,
             mPhysicalOutputs[ aPeriod ], aPeriod, true );
 }
 
@@ -318,7 +320,7 @@ void FractionalSecondaryOutput::accept( IVisitor* aVisitor, const int aPeriod )
  * \return The market price.
  */
 double FractionalSecondaryOutput::getMarketPrice( const string& aRegionName, const int aPeriod ) const {
-    double price = scenario->getMarketplace()->getPrice( mName, mMarketName.empty() ? aRegionName : mMarketName, aPeriod, true );
+    double price = mCachedMarket->getPrice( mName, mMarketName.empty() ? aRegionName : mMarketName, aPeriod, true );
 
     // Market price should exist or there is not a sector with this good as the
     // primary output. This can be caused by incorrect input files.
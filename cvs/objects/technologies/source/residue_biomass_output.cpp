@@ -35,6 +35,7 @@
 #include "containers/include/iinfo.h"
 #include "containers/include/scenario.h"
 #include "marketplace/include/marketplace.h"
+#include "marketplace/include/cached_market.h"
 #include "technologies/include/residue_biomass_output.h"
 #include "util/base/include/ivisitor.h"
 #include "util/base/include/xml_helper.h"
@@ -300,6 +301,8 @@ void ResidueBiomassOutput::initCalc( const std::string& aRegionName, const std::
     const IInfo* productInfo = marketplace->getMarketInfo( getName(), aRegionName, aPeriod, false );
 
     mCachedCO2Coef.set( productInfo ? productInfo->getDouble( "CO2Coef", false ) : 0 );
+    
+    mCachedMarket = scenario->getMarketplace()->locateMarket( getName(), aRegionName, aPeriod );
 }
 
 void ResidueBiomassOutput::postCalc( const std::string& aRegionName, const int aPeriod )
@@ -328,8 +331,7 @@ void ResidueBiomassOutput::setPhysicalOutput( const double aPrimaryOutput, const
     mPhysicalOutputs[ aPeriod ].set( outputList.front().second );
 
     // Add output to the supply
-    Marketplace* marketplace = scenario->getMarketplace();
-    marketplace->addToSupply( getName(), aRegionName, mPhysicalOutputs[ aPeriod ],
+    mCachedMarket->addToSupply( getName(), aRegionName, mPhysicalOutputs[ aPeriod ],
             aPeriod, true );
 }
 
@@ -98,6 +98,7 @@ SolarTechnology::SolarTechnology(
     mMaxLoss = 0.55;
     mEfficiencyLossExponent = 3.0;
     mMaxSectorLoadServed = 0.15;
+    mTotalAnnualIrradiance = 0;
 }
 
 // Destructor: SolarTechnology ***********************************************
@@ -119,6 +120,8 @@ void SolarTechnology::copy( const SolarTechnology& aOther ) {
     mSectorName = aOther.mSectorName;
     mSolarFieldFraction = aOther.mSolarFieldFraction;
     mSolarFieldArea = aOther.mSolarFieldArea;
+    // The irradiance is resolved in initCalc.
+    mTotalAnnualIrradiance = 0;
 }
 
 // SolarTechnology::calcCost *************************************************
@@ -140,9 +143,8 @@ void SolarTechnology::calcCost(
 
    // Get marketplace and calculate costs
    Marketplace*       pMarketplace = scenario->getMarketplace();
-   const IInfo*       pInfo        = pMarketplace->getMarketInfo( ( *mResourceInput )->getName(), aRegionName, aPeriod, true );
 
-   double totalAnnualIrradiance = pInfo->hasValue( mTotalAnnualIrradianceKey ) ? pInfo->getDouble( mTotalAnnualIrradianceKey, true ) : DEFAULT_TOTAL_ANNUAL_IRRADIANCE;
+   double totalAnnualIrradiance = mTotalAnnualIrradiance ? *mTotalAnnualIrradiance : DEFAULT_TOTAL_ANNUAL_IRRADIANCE;
    double dConnect              = pMarketplace->getPrice( ( *mResourceInput )->getName(), aRegionName, aPeriod );
    double CSPEfficiency         = getSolarEfficiency( aPeriod );
 
@@ -211,10 +213,7 @@ double SolarTechnology::calcResourceArea(
    static const double conversionFact = kWhrtoGJ * 1e-3;
 
    // Set market demand for km^2
-   Marketplace*       pMarketplace = scenario->getMarketplace();
-   const IInfo*       pInfo        = pMarketplace->getMarketInfo( ( *mResourceInput )->getName(), aRegionName, aPeriod, true );
-
-   double totalAnnualIrradiance = pInfo->hasValue( mTotalAnnualIrradianceKey ) ? pInfo->getDouble( mTotalAnnualIrradianceKey, true ) : DEFAULT_TOTAL_ANNUAL_IRRADIANCE;
+   double totalAnnualIrradiance = mTotalAnnualIrradiance ? *mTotalAnnualIrradiance : DEFAULT_TOTAL_ANNUAL_IRRADIANCE;
    double CSPGeneration         = aVariableDemand;
    double CSPEfficiency         = getSolarEfficiency( aPeriod );
 
@@ -378,6 +377,10 @@ void SolarTechnology::initCalc(
          << ": " << mTotalAnnualIrradianceKey << std::endl;
    }
 
+   // Resolve the irradiance once per period as it is needed every time costs
+   // are calculated.
+   mTotalAnnualIrradiance = pInfo ? pInfo->resolveDouble( mTotalAnnualIrradianceKey, false ) : 0;
+
    // Get number of no sun days
    if ( pInfo || !pInfo->hasValue( "no-sun-days" ) )
    // Invalid input parameter
@@ -820,6 +820,28 @@ double Technology::calcShare( const IDiscreteChoice* aChoiceFn,
     return logshare;
 }
 
+/*!
+ * \brief Get the normalized share of the subsector's new investment stored when
+ *        the subsector price was last calculated.
+ * \param aPeriod Model period.
+ * \return The stored normalized technology share.
+ * \sa setShare
+ */
+double Technology::getShare( const int aPeriod ) const {
+    return mShare[ aPeriod ];
+}
+
+/*!
+ * \brief Store the normalized share of the subsector's new investment.
+ * \details The share is a state variable so the stored value always corresponds
+ *          to the costs in the calculation which is currently active.
+ * \param aShare The normalized technology share.
+ * \param aPeriod Model period.
+ */
+void Technology::setShare( const double aShare, const int aPeriod ) {
+    mShare[ aPeriod ] = aShare;
+}
+
 /*! \brief Return true if technology is fixed for no output or input
 * 
 * returns true if this technology is set to never produce output or input
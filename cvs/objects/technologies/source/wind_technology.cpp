@@ -120,6 +120,10 @@ WindTechnology::WindTechnology(
     mTurbineRating = -1;
     mWindCapacityFactor = -1;
     mWindFarmLoss = -1;
+    mAveWindSpeed = 0;
+    mAirDensity = 0;
+    mReferenceHeight = 0;
+    mWindVelocityExponent = 0;
 }
 
 // Destructor: WindTechnology **********************************************
@@ -145,6 +149,11 @@ void WindTechnology::copy( const WindTechnology& aOther ) {
     mTurbineRating = aOther.mTurbineRating;
     mWindCapacityFactor = aOther.mWindCapacityFactor;
     mWindFarmLoss = aOther.mWindFarmLoss;
+    // The resource parameters are resolved in initCalc.
+    mAveWindSpeed = 0;
+    mAirDensity = 0;
+    mReferenceHeight = 0;
+    mWindVelocityExponent = 0;
 }
 
 // WindTechnology::calcCost ************************************************
@@ -164,10 +173,9 @@ void WindTechnology::calcCost(
 
    // Get marketplace and calculate costs
    Marketplace*       pMarketplace = scenario->getMarketplace();
-   const IInfo*       pInfo        = pMarketplace->getMarketInfo( ( *mResourceInput )->getName(), aRegionName, aPeriod, true );
 
    // Equation 4:
-   mRealizedTurbineOutput = calcRealizedTurbineOutput( pInfo );
+   mRealizedTurbineOutput = calcRealizedTurbineOutput();
 
    // Equation 3:
    // WindCapacityFactor = RealizedTurbineOutput / TurbineRating
@@ -228,20 +236,21 @@ double WindTechnology::calcIdealTurbineOutput(
 
 // WindTechnology::calcRealizedTurbineOutput *******************************
 /*! Compute the realized turbine output
- *  \param apInfo pointer to the market info
+ *  using the resource parameters resolved in initCalc
  */
-double WindTechnology::calcRealizedTurbineOutput( const IInfo* apInfo ) const
+double WindTechnology::calcRealizedTurbineOutput() const
 {
    // Equation 5:
    // aveWindSpeedAtHub = aveWindSpeed * ( turbineHubHeight / referenceHeight ) ^ windVelocityExponent
-   double aveWindSpeed = apInfo->getDouble( sXMLTagNames[ AVERAGE_WIND_SPEED_KEY ], true );
-   double referenceHeight = apInfo->getDouble( sXMLTagNames[ REFERENCE_HEIGHT_KEY ], true );
-   double windVelocityExponent = apInfo->getDouble( sXMLTagNames[ WIND_VELOCITY_EXPONENT_KEY ], true );
+   // Missing parameters were reported in initCalc and are treated as zero.
+   double aveWindSpeed = mAveWindSpeed ? *mAveWindSpeed : 0;
+   double referenceHeight = mReferenceHeight ? *mReferenceHeight : 0;
+   double windVelocityExponent = mWindVelocityExponent ? *mWindVelocityExponent : 0;
    double aveWindSpeedAtHub = aveWindSpeed * std::pow( mTurbineHubHeight / referenceHeight, windVelocityExponent );
 
    // Equation 4:
    // RealizedTurbineOutput = ( IdealTurbineOutput / 10^6 ) * TurbineCoefficient * ( 1 - Derating ) * ( 1 - WindFarmLoss )
-   double airDensity = apInfo->getDouble( sXMLTagNames[ AIR_DENSITY_KEY ], true );
+   double airDensity = mAirDensity ? *mAirDensity : 0;
    double realizedTurbineOutput = ( calcIdealTurbineOutput( aveWindSpeedAtHub, mRotorDiameter, airDensity ) / 1.0e6 ) * calcTurbineCoefficient( aveWindSpeedAtHub, mTurbineRating, mRotorDiameter, airDensity, mCutOutSpeed ) * ( 1.0 - mTurbineDerating ) * ( 1.0 - mWindFarmLoss );
    mWindPowerVariance = computeWindPowerVariance( aveWindSpeedAtHub, mTurbineRating, mRotorDiameter, airDensity, mCutOutSpeed );
    return realizedTurbineOutput;
@@ -264,12 +273,8 @@ double WindTechnology::calcResourceArea(
    double             aVariableDemand,
    const int          aPeriod )
 {
-   // Get info object for this resource 
-   Marketplace*       pMarketplace = scenario->getMarketplace();
-   const IInfo*       pInfo        = pMarketplace->getMarketInfo( ( *mResourceInput )->getName(), aRegionName, aPeriod, true );
-
    // Equation 4:
-   mRealizedTurbineOutput = calcRealizedTurbineOutput( pInfo );
+   mRealizedTurbineOutput = calcRealizedTurbineOutput();
 
    // Equation 3:
    // WindCapacityFactor = RealizedTurbineOutput / TurbineRating
@@ -501,6 +506,13 @@ void WindTechnology::initCalc(
       msg = ObjECTS::getInvalidNames(
          &validator[0],
          &validator[numParams] );
+
+      // Resolve the resource parameters once per period as they are needed
+      // every time costs are calculated.
+      mAveWindSpeed = pInfo->resolveDouble( sXMLTagNames[ AVERAGE_WIND_SPEED_KEY ], false );
+      mAirDensity = pInfo->resolveDouble( sXMLTagNames[ AIR_DENSITY_KEY ], false );
+      mReferenceHeight = pInfo->resolveDouble( sXMLTagNames[ REFERENCE_HEIGHT_KEY ], false );
+      mWindVelocityExponent = pInfo->resolveDouble( sXMLTagNames[ WIND_VELOCITY_EXPONENT_KEY ], false );
       if ( msg.length() )
       {
          std::ostringstream ostr;
@@ -63,7 +63,8 @@ public:
     /*! \brief Open an output file with a name found from the Configuration.
     * \details Checks the Configuration for a variable with the given name. If
     *          it is not found, the given default name is used. That name is
-    *          then used to open an automatically closing output file.
+    *          then used to open an automatically closing output file.  The
+    *          output file tag of the process is included in the name.
     * \param aConfVariableName Name of the configuration variable that stores
     *        the file name.
     * \param aDefaultName Filename to use if the variable is not found.
@@ -81,6 +82,7 @@ public:
             if( conf->shouldAppendScnToFile( aConfVariableName ) ) {
                 fileName = util::appendScenarioToFileName( fileName );
             }
+            fileName = util::tagOutputFileName( fileName );
             boost::iostreams::file_sink fileBuffer( fileName );
             mWrappedFile.push( fileBuffer );
             util::checkIsOpen( fileBuffer, fileName );
@@ -44,11 +44,13 @@
  */
 
 #include <cassert>
-#include <forward_list>
+#include <vector>
 #include <string>
 #include "util/base/include/definitions.h"
 
 class Value;
+class ITechnology;
+class Market;
 
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/task_arena.h>
@@ -67,17 +69,40 @@ class Value;
  *          developers do not need to worry about any of this.  All they have to do
  *          is ensure they appropriately tag their STATE Data.
  *
+ *          A single instance is created once the Scenario has completed initialization
+ *          and is reused for every model period.  The expensive GCAMFusion search is
+ *          only done once to build a registry of where the STATE data lives which is
+ *          then cheaply filtered each period by collectState.  Should the structure
+ *          of the model change, such as when new policies are added, the registry
+ *          must be invalidated by calling invalidateRegistry.
+ *
  * \author Pralit Patel
  */
 class ManageStateVariables {
 public:
-    ManageStateVariables( const int aPeriod );
+    ManageStateVariables();
     ~ManageStateVariables();
     
+    void collectState( const int aPeriod );
+    
+    void resetState();
+    
+    void invalidateRegistry();
+    
     void copyState();
     
     void setPartialDeriv( const bool aIsPartialDeriv );
     
+    static void setMaxConcurrency( const int aMaxConcurrency );
+    
+    static int getMaxConcurrency();
+    
+#if GCAM_PARALLEL_ENABLED
+    static double* getThreadState();
+    
+    static double* setThreadState( double* aState );
+#endif
+    
 #if GCAM_PARALLEL_ENABLED
     //! A tbb task arena which is the closest tbb comes to a thread pool which we
     //! will insist parallel calculations use so that we can ensure that we have
@@ -87,6 +112,11 @@ public:
 #endif
     
 private:
+    //! The maximum number of threads the thread pool may use.  A value less than
+    //! one indicates the TBB default which is the number of hardware threads.  This
+    //! is lowered when several scenarios are run at once so they may share the cores.
+    static int sMaxConcurrency;
+    
     //! The actual home of all state data.  This is a two dimensional array where
     //! the first is by state the second is for each GCAM Data marketed as STATE.
     //! Note the first state is the "base" state and the rest are "scratch" for
@@ -97,6 +127,10 @@ private:
     //! running the code.
     double** mStateData;
     
+    //! The number of Values each slot in mStateData has been allocated to hold.
+    //! The arrays are only reallocated when a period needs more than this.
+    size_t mStateCapacity;
+    
     //! The period this state was collected for.
     int mPeriodToCollect;
     
@@ -112,18 +146,52 @@ private:
     //! be changed during World.calc( mPeriodToCollect ).
     size_t mNumCollected;
     
+    //! A flag indicating state is currently collected into mStateData and must
+    //! be reset before collecting again.
+    bool mIsCollected;
+    
+    //! A flag indicating mStateRegistry reflects the current structure of the model.
+    bool mIsRegistryValid;
+    
+    /*!
+     * \brief A record of a single piece of Data flagged as STATE along with the
+     *        containers which determine if it is active in a given period.
+     */
+    struct StateRegistryEntry {
+        //! The kinds of STATE data we know how to manage.
+        enum StateType {
+            eValue,
+            ePeriodVector,
+            eTechVintageVector,
+            eYearVector
+        };
+        
+        //! The kind of data stored in mData.
+        StateType mType;
+        
+        //! A pointer to the Value or array of Values to be cast according to mType.
+        void* mData;
+        
+        //! The Technology containing this data or null if none.
+        const ITechnology* mTechnology;
+        
+        //! The Market containing this data or null if none.
+        const Market* mMarket;
+    };
+    
+    //! All STATE data in the order GCAMFusion found it.  This is built once by
+    //! buildRegistry and filtered for each period by collectState.
+    std::vector<StateRegistryEntry> mStateRegistry;
+    
     //! The list of individual Values flagged as STATE that could possibly be
-    //! changed during World.calc( mPeriodToCollect ).  We store them in a list
-    //! since searching via GCAMFusion is a relatively expensive operation and we
-    //! will need to take three passes at them:
-    //! - Figure out how many we have so what we can allocate enough memory for mStateData.
-    //! - Copy the actual data from each Value to initialize the "base" state.
-    //! - When we are done with this period copy the "base" state back into each Value.
-    std::forward_list<Value*> mStateValues;
+    //! changed during World.calc( mPeriodToCollect ).  The order must match the
+    //! order of the data in mStateData and is kept consistent with the order
+    //! written to restart files.  The memory is reused from period to period.
+    std::vector<Value*> mStateValues;
     
-    void collectState();
+    void buildRegistry();
     
-    void resetState();
+    static size_t getNumDirtyBlocks( const size_t aNumValues );
     
     std::string getRestartFileName() const;
     
@@ -136,19 +204,26 @@ private:
      *        for data flagged STATE.
      * \details In addition to handling the processData call back we also are
      *          interested in the push/pop filter steps, particularly for Technology
-     *          and MarketContainer to avoid collecting Data in a Technology or
-     *          Market that is going to be inactive during mPeriodToCollect.
+     *          and MarketContainer so that we can record which Technology or
+     *          Market each Data is contained in and later avoid collecting Data
+     *          that is going to be inactive during a given period.
      */
     struct DoCollect {
-        //! A reference to the containing class where each collected state data
-        //! will be added.
+        //! A reference to the containing class where each found state data
+        //! will be registered.
         ManageStateVariables* mParentClass;
         
-        //! A state variable while processing GCAMFusion which when set indicates
-        //! we are in a Technology or MarketContainer that is inactive in the
-        //! current period.  This flag gets reset when the corresponding popFilterStep
-        //! is found.
-        bool mIgnoreCurrValue = false;
+        //! A state variable while processing GCAMFusion which is set to the
+        //! Technology we are currently in.  It gets reset when the corresponding
+        //! popFilterStep is found.
+        const ITechnology* mCurrTechnology = 0;
+        
+        //! A state variable while processing GCAMFusion which is set to the
+        //! Market we are currently in.  It gets reset when the corresponding
+        //! popFilterStep is found.
+        const Market* mCurrMarket = 0;
+        
+        void addEntry( const StateRegistryEntry::StateType aType, void* aData );
         
         // Templated callbacks for GCAMFusion
         template<typename DataType>
@@ -54,6 +54,7 @@
 
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/spin_mutex.h>
+#include <atomic>
 #endif
 
 /*!
@@ -83,6 +84,26 @@ private:
     double mTotalTime;
 };
 
+/*!
+ * \ingroup Objects
+ * \brief A simple running total which may be added to from multiple threads.
+ * \details This is useful alongside timers to profile how much work, such as
+ *          bytes copied, is done by some part of the model.
+ */
+class Counter : private boost::noncopyable {
+public:
+    Counter();
+    void add( const unsigned long long aAmount );
+    unsigned long long getTotal() const;
+private:
+    //! The total of all amounts added to this counter.
+#if GCAM_PARALLEL_ENABLED
+    std::atomic<unsigned long long> mTotal;
+#else
+    unsigned long long mTotal;
+#endif
+};
+
 /*!
  * \brief A central timer repository which will keep track of named timers.
  * \details Registered timers will exist for the duration of the model and can be
@@ -114,12 +135,22 @@ public:
         END
     };
     
+    //! Enumeration which describes predefined counters.
+    enum PredefinedCounters {
+        JACOBIAN_COUNT,
+        STATE_BYTES_COPIED,
+        STATE_BYTES_TOTAL,
+        END_COUNTERS
+    };
+    
     static TimerRegistry& getInstance();
     
     Timer& getTimer( const std::string& aTimerName );
     
     Timer& getTimer( const PredefinedTimers aTimerName );
     
+    Counter& getCounter( const PredefinedCounters aCounterName );
+    
     void printAllTimers( std::ostream& aOut ) const;
 private:
     //! Private constructor to prevent multiple registries
@@ -132,6 +163,9 @@ private:
     //! A vector sized for the predefined timers for fast lookup.
     std::vector<Timer> mPredefinedTimers;
     
+    //! A vector sized for the predefined counters.
+    std::vector<Counter> mPredefinedCounters;
+    
     //! A map for named timers.
     std::map<std::string, Timer> mNamedTimers;
 };
@@ -70,6 +70,7 @@
 #include <vector>
 #include <cassert>
 #include <algorithm>
+#include <functional>
 #include <math.h>
 
 #ifndef _MSC_VER
@@ -467,6 +468,14 @@ namespace objects {
     }
 
     std::string appendScenarioToFileName( const std::string& aFileName );
+
+    const std::string& getOutputFileTag();
+
+    void setOutputFileTag( const std::string& aTag );
+
+    std::string addFileNameTag( const std::string& aFileName, const std::string& aTag );
+
+    std::string tagOutputFileName( const std::string& aFileName );
     
     std::string replaceSpaces( const std::string& aString );
 
@@ -614,6 +623,12 @@ namespace objects {
    void printTime( const time_t& aTime, std::ostream& aOut );
 
    int getConfigRunPeriod( const std::string aKey );
+
+#if !defined(_WIN32) && !GCAM_PARALLEL_ENABLED
+   std::vector<bool> runInChildProcesses( const size_t aNumJobs, const int aMaxConcurrent,
+                                          const std::function<bool( const size_t )>& aRunJob,
+                                          const std::function<std::string( const size_t )>& aJobName );
+#endif
    
 } // End util namespace.
 
@@ -49,6 +49,11 @@
 #include "util/base/include/util.h"
 
 #if GCAM_PARALLEL_ENABLED
+#include <atomic>
+#include <cstring>
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
 #include <tbb/enumerable_thread_specific.h>
 #endif
 
@@ -112,6 +117,10 @@ public:
     Value& operator*=( const double& aValue );
     Value& operator/=( const double& aValue );
     Value& operator=( const double& aDblValue );
+#if GCAM_PARALLEL_ENABLED
+    void atomicAdd( const double aValue );
+    double atomicGet() const;
+#endif
 
     // XML Function here.
 private:
@@ -135,9 +144,27 @@ private:
     //! is true.  Note we make this field static so that we can quickly swap state
     //! between a "base" state or some "scratch" value from a central location.
     static CentralValueType sCentralValue;
+#if GCAM_PARALLEL_ENABLED
+    //! A copy of this thread's slot in sCentralValue which can be read at a
+    //! constant cost unlike the lookup done by sCentralValue.local().
+    static thread_local double* sThreadState;
+    //! The value of sStateGeneration when sThreadState was last copied from
+    //! sCentralValue.
+    static thread_local unsigned int sThreadStateGeneration;
+    //! Incremented each time the slots in sCentralValue are reassigned so that
+    //! threads know their copy in sThreadState is out of date.
+    static std::atomic<unsigned int> sStateGeneration;
+#endif
     //! A static reference into the "base" state of ManageStateVariables::mStateData
     //! mostly for convenience.
     static double* sBaseCentralValue;
+    //! The offset, in doubles, from the start of each slot in
+    //! ManageStateVariables::mStateData to the flags which mark which blocks of
+    //! that slot have been changed.
+    static size_t sDirtyFlagsOffset;
+    //! The number of state values in each block that is flagged when changed is
+    //! given by 1 << DIRTY_BLOCK_SHIFT.
+    static const unsigned int DIRTY_BLOCK_SHIFT = 5;
     //! The index into sCentralValue that contains the data for this instance.
     unsigned int mCentralValueIndex;
     //! A flag to indicate if this instance of Value has been identified as active
@@ -151,6 +178,10 @@ private:
 #endif
     double& getInternal();
     const double& getInternal() const;
+#if GCAM_PARALLEL_ENABLED
+    static double* getThreadState();
+    static double* updateThreadState();
+#endif
 };
 
 inline Value::Value(): mValue( 0 ), mIsInit( false ), mIsStateCopy( false ){
@@ -180,17 +211,38 @@ inline void Value::init( const double aNewValue ){
 /*!
  * \brief An accessor method to get at the actual data held in this class.
  * \details This method will appropriately get the value locally or the centrally
- *          managed state if the mIsStateCopy flag is set.
+ *          managed state if the mIsStateCopy flag is set.  Since the reference
+ *          returned may be written to, the value is flagged as changed when it
+ *          is in a "scratch" state.
  * \return A reference the the appropriate value represented by this class.
  */
 inline double& Value::getInternal() {
-    return mIsStateCopy ?
+    if( !mIsStateCopy ) {
+        return mValue;
+    }
 #if !GCAM_PARALLEL_ENABLED
-        sCentralValue[mCentralValueIndex]
+    double* state = sCentralValue;
 #else
-        sCentralValue.local()[mCentralValueIndex]
+    double* state = getThreadState();
 #endif
-        : mValue;
+    // Flag the block containing this value as changed so that only the changed
+    // blocks of a "scratch" state need to be restored by ManageStateVariables::copyState.
+    if( state != sBaseCentralValue ) {
+#if !GCAM_PARALLEL_ENABLED
+        reinterpret_cast<unsigned char*>( state + sDirtyFlagsOffset )[ mCentralValueIndex >> DIRTY_BLOCK_SHIFT ] = 1;
+#else
+        // Several threads may be working on the same "scratch" state.
+        unsigned char& dirtyFlag = reinterpret_cast<unsigned char*>( state + sDirtyFlagsOffset )[ mCentralValueIndex >> DIRTY_BLOCK_SHIFT ];
+#if defined( __cpp_lib_atomic_ref )
+        std::atomic_ref<unsigned char>( dirtyFlag ).store( 1, std::memory_order_relaxed );
+#elif defined( _MSC_VER )
+        *static_cast<volatile unsigned char*>( &dirtyFlag ) = 1;
+#else
+        __atomic_store_n( &dirtyFlag, static_cast<unsigned char>( 1 ), __ATOMIC_RELAXED );
+#endif
+#endif
+    }
+    return state[ mCentralValueIndex ];
 }
 
 /*!
@@ -204,11 +256,38 @@ inline const double& Value::getInternal() const {
 #if !GCAM_PARALLEL_ENABLED
         sCentralValue[mCentralValueIndex]
 #else
-        sCentralValue.local()[mCentralValueIndex]
+        getThreadState()[mCentralValueIndex]
 #endif
         : mValue;
 }
 
+#if GCAM_PARALLEL_ENABLED
+/*!
+ * \brief Get the slot of state the calling thread should use.
+ * \details Every access of a STATE value needs this so rather than looking up
+ *          the thread specific slot in sCentralValue each time a copy is kept
+ *          in native thread local storage.  The copy is only refreshed when the
+ *          slots have been reassigned since it was made.
+ * \return The slot of state for the calling thread.
+ */
+inline double* Value::getThreadState() {
+    if( sThreadStateGeneration != sStateGeneration.load( std::memory_order_relaxed ) ) {
+        return updateThreadState();
+    }
+    return sThreadState;
+}
+
+/*!
+ * \brief Refresh the copy of the calling thread's slot of state from sCentralValue.
+ * \return The slot of state for the calling thread.
+ */
+inline double* Value::updateThreadState() {
+    sThreadStateGeneration = sStateGeneration.load( std::memory_order_relaxed );
+    sThreadState = sCentralValue.local();
+    return sThreadState;
+}
+#endif
+
 //! Set the value.
 inline void Value::set( const double aNewValue ){
     assert( util::isValidNumber( aNewValue ) );
@@ -382,6 +461,87 @@ inline Value& Value::operator=( const double& aDblValue ) {
     return *this;
 }
 
+#if GCAM_PARALLEL_ENABLED
+/*!
+ * \brief Add to the value in a way that is safe to do from several threads at
+ *        the same time without a lock.
+ * \details The addition is done with a compare and swap loop directly on the
+ *          bits of the underlying double which will only retry if another thread
+ *          updated the value in between the read and the write.  The double is
+ *          a plain member or a slot in the central state so it is accessed
+ *          through std::atomic_ref when available and otherwise through the
+ *          compiler's atomic intrinsics rather than by pretending it is a
+ *          std::atomic<double>.  This is used for market supplies and demands
+ *          which can get added to from many activities at once during a
+ *          parallel World.calc.
+ * \param aValue The amount to add.
+ * \pre The value has already been initialized as updating mIsInit here would
+ *      not be thread safe.
+ */
+inline void Value::atomicAdd( const double aValue ) {
+    assert( mIsInit );
+    double& value = getInternal();
+#if defined( __cpp_lib_atomic_ref )
+    std::atomic_ref<double> atomicValue( value );
+    double expected = atomicValue.load( std::memory_order_relaxed );
+    while( !atomicValue.compare_exchange_weak( expected, expected + aValue, std::memory_order_relaxed ) ) {
+        // expected has been updated with the current value, just try again.
+    }
+#elif defined( _MSC_VER )
+    static_assert( sizeof( __int64 ) == sizeof( double ),
+                   "Atomic access to a Value requires a 64 bit double." );
+    volatile __int64* bits = reinterpret_cast<volatile __int64*>( &value );
+    __int64 expected = *bits;
+    while( true ) {
+        double current;
+        memcpy( &current, &expected, sizeof( double ) );
+        const double desired = current + aValue;
+        __int64 desiredBits;
+        memcpy( &desiredBits, &desired, sizeof( double ) );
+        const __int64 actual = _InterlockedCompareExchange64( bits, desiredBits, expected );
+        if( actual == expected ) {
+            break;
+        }
+        // Another thread updated the value, just try again.
+        expected = actual;
+    }
+#else
+    double expected;
+    __atomic_load( &value, &expected, __ATOMIC_RELAXED );
+    double desired = expected + aValue;
+    while( !__atomic_compare_exchange( &value, &expected, &desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) ) {
+        // expected has been updated with the current value, just try again.
+        desired = expected + aValue;
+    }
+#endif
+#if DEBUG_STATE
+    doStateCheck();
+#endif
+}
+
+/*!
+ * \brief Get the value in a way that is safe while other threads may be calling
+ *        atomicAdd on it.
+ * \return The value.
+ */
+inline double Value::atomicGet() const {
+    const double& value = getInternal();
+#if defined( __cpp_lib_atomic_ref )
+    return std::atomic_ref<double>( const_cast<double&>( value ) ).load( std::memory_order_relaxed );
+#elif defined( _MSC_VER )
+    // A compare and swap that never changes anything is an atomic read.
+    const __int64 bits = _InterlockedCompareExchange64( reinterpret_cast<volatile __int64*>( const_cast<double*>( &value ) ), 0, 0 );
+    double ret;
+    memcpy( &ret, &bits, sizeof( double ) );
+    return ret;
+#else
+    double ret;
+    __atomic_load( &value, &ret, __ATOMIC_RELAXED );
+    return ret;
+#endif
+}
+#endif
+
 //! Check if the value has been initialized.
 inline bool Value::isInited() const {
     return mIsInit;
@@ -68,9 +68,11 @@
 #include <sstream>
 #include <cassert>
 #include <vector>
+#include <list>
 #include <map>
 #include <memory>
 #include <typeinfo>
+#include <algorithm>
 
 #include <xercesc/parsers/XercesDOMParser.hpp>
 #include <xercesc/dom/DOMNode.hpp>
@@ -104,6 +106,13 @@
 #include "util/base/include/time_vector.h"
 #include "util/base/include/value.h"
 
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+#endif
+
 /*!
  * \ingroup Objects
  * \brief A basic class which is a container for a variable containing the
@@ -192,6 +201,7 @@ public:
 
    static int getNodePeriod ( const xercesc::DOMNode* node, const Modeltime* modeltime );
    static bool parseXML( const std::string& aXMLFile, IParsable* aModelElement );
+   static bool parseXMLFiles( const std::list<std::string>& aXMLFiles, IParsable* aModelElement );
    static const std::string& text();
    static const std::string& name();
    static void cleanupParser();
@@ -204,6 +214,9 @@ private:
     static xercesc::ErrorHandler** getErrorHandlerPointerInternal();
     static xercesc::DOMDocument** getDOMDocumentInternal();
     static void initParser();
+    static void configureParser( xercesc::XercesDOMParser* aParser );
+    static bool parseDocument( const std::string& aXMLFile, xercesc::XercesDOMParser* aParser,
+                               std::string& aErrorMessage );
     static xercesc::XercesDOMParser* getParser();
 };
 
@@ -1064,32 +1077,153 @@ bool XMLHelper<T>::parseXML( const std::string& aXMLFile, IParsable* aModelEleme
     static unsigned int numParses = 0;
     ++numParses;
     xercesc::XercesDOMParser* parser = XMLHelper<T>::getParser();
+    std::string errorMessage;
+    if( !parseDocument( aXMLFile, parser, errorMessage ) ){
+        std::cout << errorMessage << std::endl;
+        return false;
+    }
+
+    bool success = aModelElement->XMLParse( parser->getDocument()->getDocumentElement() );
+    // Cleanup parser memory if there are no active parses.
+    if( --numParses == 0 ){
+        parser->resetDocumentPool();
+        parser->resetCachedGrammarPool();
+    }
+    return success;
+}
+
+/*!
+* \brief Function to parse a list of scenario component files into a model element in order.
+* \details The model element parses each file in the order given, exactly as if
+*          parseXML were called for each file, and parsing stops at the first
+*          failure. In parallel builds the files are read and validated into DOM
+*          documents concurrently, using one parser per thread, while the model
+*          element parses the documents which are already available. Files are
+*          read in batches of one file per thread so that only two batches of
+*          documents are held in memory at a time.
+* \param aXMLFiles The names of the files to parse in order.
+* \param aModelElement Element to call XMLParse on.
+* \return Whether parsing of all files was successful.
+*/
+template <class T>
+bool XMLHelper<T>::parseXMLFiles( const std::list<std::string>& aXMLFiles, IParsable* aModelElement ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+#if GCAM_PARALLEL_ENABLED
+    // Make sure the XML platform and the shared error handler are initialized
+    // before any parsing threads start.
+    XMLHelper<T>::getParser();
+
+    const std::vector<std::string> files( aXMLFiles.begin(), aXMLFiles.end() );
+    const size_t batchSize = std::max( tbb::this_task_arena::max_concurrency(), 1 );
+    std::vector<xercesc::DOMDocument*> documents( files.size(), static_cast<xercesc::DOMDocument*>( 0 ) );
+    std::vector<std::string> errorMessages( files.size() );
+    tbb::enumerable_thread_specific<xercesc::XercesDOMParser*> parsers( static_cast<xercesc::XercesDOMParser*>( 0 ) );
+
+    // Read a batch of files into documents which are owned by this function
+    // rather than by the parsers.
+    auto parseBatch = [&] ( const size_t aBatchStart ) {
+        const size_t batchEnd = std::min( aBatchStart + batchSize, files.size() );
+        tbb::parallel_for( aBatchStart, batchEnd, [&] ( const size_t aIndex ) {
+            xercesc::XercesDOMParser*& parser = parsers.local();
+            if( !parser ){
+                parser = new xercesc::XercesDOMParser();
+                configureParser( parser );
+            }
+            if( parseDocument( files[ aIndex ], parser, errorMessages[ aIndex ] ) ){
+                documents[ aIndex ] = parser->adoptDocument();
+            }
+            parser->resetDocumentPool();
+            parser->resetCachedGrammarPool();
+        } );
+    };
+
+    bool success = true;
+    if( !files.empty() ){
+        parseBatch( 0 );
+    }
+    for( size_t batchStart = 0; success && batchStart < files.size(); batchStart += batchSize ){
+        // Read the next batch while the model parses the current one.
+        const size_t nextBatchStart = batchStart + batchSize;
+        tbb::task_group nextBatch;
+        if( nextBatchStart < files.size() ){
+            nextBatch.run( [&parseBatch, nextBatchStart] { parseBatch( nextBatchStart ); } );
+        }
+        for( size_t i = batchStart; success && i < std::min( nextBatchStart, files.size() ); ++i ){
+            mainLog.setLevel( ILogger::NOTICE );
+            mainLog << "Parsing " << files[ i ] << " scenario component." << std::endl;
+            if( !documents[ i ] ){
+                std::cout << errorMessages[ i ] << std::endl;
+                success = false;
+            }
+            else {
+                success = aModelElement->XMLParse( documents[ i ]->getDocumentElement() );
+                // Free the document as soon as it has been applied.
+                documents[ i ]->release();
+                documents[ i ] = 0;
+            }
+        }
+        nextBatch.wait();
+    }
+
+    // Release any documents left unapplied after a failure and the per thread
+    // parsers.
+    for( size_t i = 0; i < documents.size(); ++i ){
+        if( documents[ i ] ){
+            documents[ i ]->release();
+        }
+    }
+    for( typename tbb::enumerable_thread_specific<xercesc::XercesDOMParser*>::iterator it = parsers.begin();
+         it != parsers.end(); ++it )
+    {
+        delete *it;
+    }
+    return success;
+#else
+    for( std::list<std::string>::const_iterator currFile = aXMLFiles.begin();
+         currFile != aXMLFiles.end(); ++currFile )
+    {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Parsing " << *currFile << " scenario component." << std::endl;
+        if( !parseXML( *currFile, aModelElement ) ){
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+/*!
+* \brief Read an XML file into a DOM document held by the given parser.
+* \details Calls the parse function and handles the exceptions which it may
+*          throw.
+* \param aXMLFile The name of the file to parse.
+* \param aParser The parser with which to read the file.
+* \param aErrorMessage Set to the error message if reading failed.
+* \return Whether reading the file was successful.
+*/
+template <class T>
+bool XMLHelper<T>::parseDocument( const std::string& aXMLFile, xercesc::XercesDOMParser* aParser,
+                                  std::string& aErrorMessage )
+{
     try {
-        parser->parse( aXMLFile.c_str() );
+        aParser->parse( aXMLFile.c_str() );
     } catch ( const xercesc::XMLException& toCatch ) {
         std::string message = XMLHelper<std::string>::safeTranscode( toCatch.getMessage() );
-        std::cout << "ERROR: XML Read Exception message is:" << std::endl << message << std::endl;
+        aErrorMessage = "ERROR: XML Read Exception message is:\n" + message;
         return false;
     } catch ( const xercesc::DOMException& toCatch ) {
         std::string message = XMLHelper<std::string>::safeTranscode( toCatch.msg );
-        std::cout << "ERROR: XML Read Exception message is:" << std::endl << message << std::endl;
+        aErrorMessage = "ERROR: XML Read Exception message is:\n" + message;
         return false;
     } catch ( const xercesc::SAXException& toCatch ){
         std::string message = XMLHelper<std::string>::safeTranscode( toCatch.getMessage() );
-        std::cout << "ERROR: XML Read Exception message is:" << std::endl << message << std::endl;
+        aErrorMessage = "ERROR: XML Read Exception message is:\n" + message;
         return false;
     } catch (...) {
-        std::cout << "ERROR:Unexpected XML Read Exception." << std::endl;
+        aErrorMessage = "ERROR:Unexpected XML Read Exception.";
         return false;
     }
-
-    bool success = aModelElement->XMLParse( parser->getDocument()->getDocumentElement() );
-    // Cleanup parser memory if there are no active parses.
-    if( --numParses == 0 ){
-        parser->resetDocumentPool();
-        parser->resetCachedGrammarPool();
-    }
-    return success;
+    return true;
 }
 
 /*! \brief Function which initializes the XML Platform and creates an instance
@@ -1109,15 +1243,9 @@ void XMLHelper<T>::initParser() {
     }
 
     // Initialize the instances of the parser and error handler.
-    *getParserPointerInternal() = new xercesc::XercesDOMParser();
-    (*getParserPointerInternal())->setValidationScheme( xercesc::XercesDOMParser::Val_Always );
-    (*getParserPointerInternal())->setDoNamespaces( false );
-    (*getParserPointerInternal())->setDoSchema( true );
-    (*getParserPointerInternal())->setCreateCommentNodes( false ); // No comment nodes
-    (*getParserPointerInternal())->setIncludeIgnorableWhitespace( false ); // No text nodes
-
     *getErrorHandlerPointerInternal() = ( (xercesc::ErrorHandler*)new xercesc::HandlerBase() );
-    (*getParserPointerInternal())->setErrorHandler( *getErrorHandlerPointerInternal() );
+    *getParserPointerInternal() = new xercesc::XercesDOMParser();
+    configureParser( *getParserPointerInternal() );
     
     *getDOMDocumentInternal() = xercesc::DOMImplementation::getImplementation()->createDocument();
     
@@ -1131,6 +1259,21 @@ void XMLHelper<T>::initParser() {
     });
 }
 
+/*! \brief Set the options used by all parsers.
+* \details The error handler is shared by all parsers as it does not keep any
+*          state, so it must already have been created.
+* \param aParser The parser to configure.
+*/
+template<class T>
+void XMLHelper<T>::configureParser( xercesc::XercesDOMParser* aParser ) {
+    aParser->setValidationScheme( xercesc::XercesDOMParser::Val_Always );
+    aParser->setDoNamespaces( false );
+    aParser->setDoSchema( true );
+    aParser->setCreateCommentNodes( false ); // No comment nodes
+    aParser->setIncludeIgnorableWhitespace( false ); // No text nodes
+    aParser->setErrorHandler( *getErrorHandlerPointerInternal() );
+}
+
 /*! \brief Return the text string.
 * \author Josh Lurz
 * \return The #text string.
@@ -48,6 +48,8 @@
 #include "util/base/include/configuration.h"
 #include "util/base/include/gcam_fusion.hpp"
 #include "util/base/include/gcam_data_containers.h"
+#include "util/base/include/model_time.h"
+#include "util/base/include/timer.h"
 
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/concurrent_queue.h>
@@ -62,10 +64,20 @@ extern Scenario* scenario;
 // since Value is header only and these particular fields are just as related to
 // ManageStateVariables it seems appropriate to initialize them to NULL here.
 Value::CentralValueType Value::sCentralValue( (double*)0 );
+#if GCAM_PARALLEL_ENABLED
+thread_local double* Value::sThreadState( 0 );
+// Note threads start out at generation zero so the shared generation must start
+// ahead to ensure the first access from any thread looks up its slot.
+thread_local unsigned int Value::sThreadStateGeneration( 0 );
+std::atomic<unsigned int> Value::sStateGeneration( 1 );
+#endif
 double* Value::sBaseCentralValue( 0 );
+size_t Value::sDirtyFlagsOffset( 0 );
+
+int ManageStateVariables::sMaxConcurrency( -1 );
 
 #if GCAM_PARALLEL_ENABLED
-#define NUM_STATES tbb::task_scheduler_init::default_num_threads()+1
+#define NUM_STATES ManageStateVariables::getMaxConcurrency()+1
 #else
 #define NUM_STATES 2
 #endif
@@ -123,24 +135,29 @@ struct AssignThreadStateFun {
 #endif
 
 /*!
- * \brief Constructor which calls collectState() to begin the process to find all
- *        state data during the given model period and allocate memory to hold
- *        it in a "base" and "scratch" spaces.
- * \param aPeriod The model period to manage state in.
+ * \brief Constructor.
+ * \details No state is collected until collectState is called for a period.  The
+ *          search for state data is deferred until then as well so that it
+ *          reflects the model structure as it exists when the first period is solved.
  */
-ManageStateVariables::ManageStateVariables( const int aPeriod ):
+ManageStateVariables::ManageStateVariables():
 #if !GCAM_PARALLEL_ENABLED
 mStateData( new double*[ NUM_STATES ] ),
 #else
-mThreadPool(),
+mThreadPool( getMaxConcurrency() ),
 mStateData( new double*[ NUM_STATES ] ),
 #endif
-mPeriodToCollect( aPeriod ),
-mYearToCollect( scenario->getModeltime()->getper_to_yr( aPeriod ) ),
-mCCStartYear( mYearToCollect - scenario->getModeltime()->gettimestep( aPeriod ) + 1 ),
-mNumCollected( 0 )
+mStateCapacity( 0 ),
+mPeriodToCollect( -1 ),
+mYearToCollect( -1 ),
+mCCStartYear( 0 ),
+mNumCollected( 0 ),
+mIsCollected( false ),
+mIsRegistryValid( false )
 {
-    collectState();
+    for( size_t stateInd = 0; stateInd < NUM_STATES; ++stateInd ) {
+        mStateData[ stateInd ] = 0;
+    }
 }
 
 /*!
@@ -148,25 +165,24 @@ mNumCollected( 0 )
  *        "base" state back into the Value objects before we deallocate that memory.
  */
 ManageStateVariables::~ManageStateVariables() {
-    resetState();
+    if( mIsCollected ) {
+        resetState();
+    }
     for( size_t stateInd = 0; stateInd < NUM_STATES; ++stateInd ) {
         delete[] mStateData[ stateInd ];
     }
     delete[] mStateData;
-#if !GCAM_PARALLEL_ENABLED
-    Value::sCentralValue = 0;
-#else
-    Value::sCentralValue.clear();
-#endif
-    Value::sBaseCentralValue = 0;
 }
 
 /*!
- * \brief Search for all relevant STATE Values and allocate space for them in the
- *        central state data arrays.  The "base" state will get initialized as the
- *        actual value set in the individual Value objects before being collected.
+ * \brief Search for all Data flagged as STATE using GCAMFusion and record where
+ *        it lives along with the Technology or Market it is contained in.
+ * \details This is a relatively expensive operation so the results are kept in
+ *          mStateRegistry until invalidateRegistry is called.
  */
-void ManageStateVariables::collectState() {
+void ManageStateVariables::buildRegistry() {
+    mStateRegistry.clear();
+    
     // Set up the GCAM Fusion steps as well as the callback struct that will handle
     // the results from the search.
     DoCollect doCollectProc;
@@ -183,14 +199,103 @@ void ManageStateVariables::collectState() {
     GCAMFusion<DoCollect, true, true, true> gatherState( doCollectProc, collectStateSteps );
     gatherState.startFilter( scenario );
     
-    // DoCollect has now gathered all active state into the mStateValues list to
-    // allow faster/easier processing for the remaining tasks at hand.
+    // clean up GCAMFusion related memory
+    for( auto filterStep : collectStateSteps ) {
+        delete filterStep;
+    }
+    
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::DEBUG );
+    mainLog << "Number of registered state data: " << mStateRegistry.size() << endl;
+    mIsRegistryValid = true;
+}
+
+/*!
+ * \brief Flag that the structure of the model has changed such that the STATE
+ *        data must be searched for again the next time collectState is called.
+ * \details This should be called whenever objects containing STATE data may be
+ *          added, removed, or replaced such as when a new policy is set.
+ */
+void ManageStateVariables::invalidateRegistry() {
+    mIsRegistryValid = false;
+}
+
+/*!
+ * \brief Find all relevant STATE Values for the given period and allocate space for
+ *        them in the central state data arrays.  The "base" state will get initialized
+ *        as the actual value set in the individual Value objects before being collected.
+ * \details The Values are filtered from mStateRegistry, which is only rebuilt when it
+ *          has been invalidated.  The registry is walked in reverse so that the Values
+ *          are arranged in the same order as they always have been which keeps restart
+ *          files compatible.
+ * \param aPeriod The model period to manage state in.
+ * \pre Any previously collected state has been reset with resetState.
+ */
+void ManageStateVariables::collectState( const int aPeriod ) {
+    assert( !mIsCollected );
+    if( !mIsRegistryValid ) {
+        buildRegistry();
+    }
+    
+    const Modeltime* modeltime = scenario->getModeltime();
+    mPeriodToCollect = aPeriod;
+    mYearToCollect = modeltime->getper_to_yr( aPeriod );
+    mCCStartYear = mYearToCollect - modeltime->gettimestep( aPeriod ) + 1;
+    
+    mStateValues.clear();
+    for( auto entryIter = mStateRegistry.rbegin(); entryIter != mStateRegistry.rend(); ++entryIter ) {
+        // Ignore any data set within a Technology that is not operating or a
+        // Market which is not for the current model period.
+        if( ( *entryIter ).mTechnology && !( *entryIter ).mTechnology->isOperating( mPeriodToCollect ) ) {
+            continue;
+        }
+        if( ( *entryIter ).mMarket && ( *entryIter ).mMarket->getYear() != mYearToCollect ) {
+            continue;
+        }
+        switch( ( *entryIter ).mType ) {
+            case StateRegistryEntry::eValue:
+                // Any SINGLE value that is tagged is considered active.
+                mStateValues.push_back( static_cast<Value*>( ( *entryIter ).mData ) );
+                break;
+            case StateRegistryEntry::ePeriodVector:
+                // When an ARRAY of values are tagged only the Value in [ mPeriodToCollect]
+                // is considered active.
+                mStateValues.push_back( &( *static_cast<objects::PeriodVector<Value>*>( ( *entryIter ).mData ) )[ mPeriodToCollect ] );
+                break;
+            case StateRegistryEntry::eTechVintageVector:
+                // Note, the Technology filter should take care of out of bounds here
+                mStateValues.push_back( &( *static_cast<objects::TechVintageVector<Value>*>( ( *entryIter ).mData ) )[ mPeriodToCollect ] );
+                break;
+            case StateRegistryEntry::eYearVector: {
+                // When a year vector is tagged we only need to worry about values in
+                // the current timestep [mCCStartYear, mYearToCollect].  They are added
+                // latest year first to be consistent with the reversed registry.
+                objects::YearVector<Value>& yearVector = *static_cast<objects::YearVector<Value>*>( ( *entryIter ).mData );
+                const int startYear = std::max( mCCStartYear, yearVector.getStartYear() );
+                for( int year = mYearToCollect; year >= startYear; --year ) {
+                    mStateValues.push_back( &yearVector[ year ] );
+                }
+                break;
+            }
+        }
+    }
+    mNumCollected = mStateValues.size();
+    
     ILogger& mainLog = ILogger::getLogger( "main_log" );
     mainLog.setLevel( ILogger::DEBUG );
     mainLog << "Number of active state values: " << mNumCollected << endl;
-    // Allocate space for each active state value for each state slot.
-    for( size_t stateInd = 0; stateInd < NUM_STATES; ++stateInd ) {
-        mStateData[ stateInd ] = new double[ mNumCollected ];
+    // Allocate space for each active state value for each state slot, reusing
+    // the previous allocation if it is large enough.
+    // Each slot is followed by the flags which Value uses to mark the blocks of
+    // it that have been changed.
+    if( mNumCollected > mStateCapacity ) {
+        const size_t numFlagDoubles = ( getNumDirtyBlocks( mNumCollected ) + sizeof( double ) - 1 ) / sizeof( double );
+        for( size_t stateInd = 0; stateInd < NUM_STATES; ++stateInd ) {
+            delete[] mStateData[ stateInd ];
+            mStateData[ stateInd ] = new double[ mNumCollected + numFlagDoubles ];
+        }
+        mStateCapacity = mNumCollected;
+        Value::sDirtyFlagsOffset = mStateCapacity;
     }
     
     // We can now initialize the static Value references into mStateData for fast
@@ -200,13 +305,13 @@ void ManageStateVariables::collectState() {
 
     // Take another pass through the Value objects and copy the original data from
     // each one into the corresponding "base" state to initialize it.
-    mNumCollected = 0;
-    for( auto currValue : mStateValues ) {
+    for( size_t stateInd = 0; stateInd < mNumCollected; ++stateInd ) {
+        Value* currValue = mStateValues[ stateInd ];
         currValue->mIsStateCopy = true;
-        currValue->mCentralValueIndex = mNumCollected;
-        currValue->sBaseCentralValue[ mNumCollected ] = currValue->mValue;
-        ++mNumCollected;
+        currValue->mCentralValueIndex = stateInd;
+        currValue->sBaseCentralValue[ stateInd ] = currValue->mValue;
     }
+    mIsCollected = true;
     
     // if configured, reset initial state data from a restart file
     // note because the value could be specified via restart-period or restart-year
@@ -222,18 +327,17 @@ void ManageStateVariables::collectState() {
     if( newRestartPeriod != -1 && mPeriodToCollect < newRestartPeriod ) {
         loadRestartFile();
     }
-    
-    // clean up GCAMFusion related memory
-    for( auto filterStep : collectStateSteps ) {
-        delete filterStep;
-    }
 }
 
 /*!
  * \brief Copy the "base" state back into each corresponding Value object before
- *        we move on from this model period and release the state memory.
+ *        we move on from this model period.
+ * \details The state memory is kept to be reused by the next call to collectState
+ *          however the static references into it are cleared so that Values will
+ *          no longer attempt to access it.
  */
 void ManageStateVariables::resetState() {
+    assert( mIsCollected );
     if( Configuration::getInstance()->shouldWriteFile( "restart", false, false ) ) {
         saveRestartFile();
     }
@@ -252,6 +356,15 @@ void ManageStateVariables::resetState() {
 #endif
         currValue->mValue = currValue->sBaseCentralValue[ currValue->mCentralValueIndex ];
     }
+    mIsCollected = false;
+    
+#if !GCAM_PARALLEL_ENABLED
+    Value::sCentralValue = 0;
+#else
+    Value::sCentralValue.clear();
+    ++Value::sStateGeneration;
+#endif
+    Value::sBaseCentralValue = 0;
 }
 
 /*!
@@ -260,23 +373,73 @@ void ManageStateVariables::resetState() {
  *          calculation which will make changes in the "scratch" space.  Note when
  *          GCAM_PARALLEL_ENABLED the appropriate "scratch" space to reset is identified
  *          as the one assigned to the calling thread via the thread local Value::sCentralValue.
+ *          Only the blocks of the "scratch" space which have been flagged as changed
+ *          by Value since it was last restored are copied.  A partial derivative
+ *          typically only changes the state of the few activities which depend on
+ *          that market's price so this is much less than the entire state.  The
+ *          number of bytes copied are added to the STATE_BYTES_COPIED counter.
  */
 void ManageStateVariables::copyState() {
 #if !GCAM_PARALLEL_ENABLED
-    memcpy( mStateData[1], mStateData[0], (sizeof( double)) * mNumCollected );
+    double* scratchState = mStateData[1];
 #else
-    memcpy( Value::sCentralValue.local(), mStateData[0], (sizeof( double)) * mNumCollected );
+    double* scratchState = Value::getThreadState();
 #endif
+    unsigned char* dirtyFlags = reinterpret_cast<unsigned char*>( scratchState + Value::sDirtyFlagsOffset );
+    const size_t numBlocks = getNumDirtyBlocks( mNumCollected );
+    size_t numCopied = 0;
+    size_t block = 0;
+    while( block < numBlocks ) {
+        // Quickly skip over runs of unchanged blocks a word at a time.
+        unsigned long long flagWord;
+        if( block % sizeof( flagWord ) == 0 && block + sizeof( flagWord ) <= numBlocks ) {
+            memcpy( &flagWord, dirtyFlags + block, sizeof( flagWord ) );
+            if( flagWord == 0 ) {
+                block += sizeof( flagWord );
+                continue;
+            }
+        }
+        if( !dirtyFlags[ block ] ) {
+            ++block;
+            continue;
+        }
+        
+        // Copy consecutive changed blocks together.
+        size_t endBlock = block + 1;
+        while( endBlock < numBlocks && dirtyFlags[ endBlock ] ) {
+            ++endBlock;
+        }
+        const size_t startInd = block << Value::DIRTY_BLOCK_SHIFT;
+        const size_t endInd = std::min( endBlock << Value::DIRTY_BLOCK_SHIFT, mNumCollected );
+        memcpy( scratchState + startInd, mStateData[0] + startInd, (sizeof( double )) * ( endInd - startInd ) );
+        memset( dirtyFlags + block, 0, endBlock - block );
+        numCopied += endInd - startInd;
+        block = endBlock;
+    }
+    
+    TimerRegistry& timerRegistry = TimerRegistry::getInstance();
+    timerRegistry.getCounter( TimerRegistry::STATE_BYTES_COPIED ).add( (sizeof( double )) * numCopied );
+    timerRegistry.getCounter( TimerRegistry::STATE_BYTES_TOTAL ).add( (sizeof( double )) * mNumCollected );
 }
 
 /*!
  * \brief Set up the Value classes static references into mStateData to appropriately
  *        point to the "base" state if aIsPartialDeriv is false or a "scratch"
  *        space if aIsPartialDeriv is true.
+ * \details The "base" state may have changed since the "scratch" spaces were
+ *          last used so when starting partial derivatives every block of each
+ *          "scratch" space is flagged as changed to ensure it is fully restored
+ *          by the first call to copyState.
  * \param aIsPartialDeriv The flag indicating if we are about to calculate a partial
  *                        derivative or not as set from the solution algorithm.
  */
 void ManageStateVariables::setPartialDeriv( const bool aIsPartialDeriv ) {
+    if( aIsPartialDeriv && mStateCapacity > 0 ) {
+        const size_t numBlocks = getNumDirtyBlocks( mNumCollected );
+        for( size_t stateInd = 1; stateInd < NUM_STATES; ++stateInd ) {
+            memset( mStateData[ stateInd ] + Value::sDirtyFlagsOffset, 1, numBlocks );
+        }
+    }
 #if !GCAM_PARALLEL_ENABLED
     Value::sCentralValue = mStateData[ aIsPartialDeriv ? 1 : 0 ];
 #else
@@ -289,6 +452,68 @@ void ManageStateVariables::setPartialDeriv( const bool aIsPartialDeriv ) {
         // slot to each worker thread.
         Value::sCentralValue = Value::CentralValueType( AssignThreadStateFun( mStateData, NUM_STATES ) );
     }
+    // Any copies of the previous slots held by threads are now out of date.
+    ++Value::sStateGeneration;
+#endif
+}
+
+#if GCAM_PARALLEL_ENABLED
+/*!
+ * \brief Get the state slot the calling thread is currently using.
+ * \return The state slot of the calling thread.
+ */
+double* ManageStateVariables::getThreadState() {
+    return Value::getThreadState();
+}
+
+/*!
+ * \brief Set the state slot the calling thread should use.
+ * \details This allows several threads to work together on a single partial
+ *          derivative by all using the "scratch" state of the thread which
+ *          started it.  The previous slot must be restored once done.
+ * \param aState The state slot to use.
+ * \return The state slot the thread was previously using.
+ */
+double* ManageStateVariables::setThreadState( double* aState ) {
+    double* prevState = Value::getThreadState();
+    Value::sCentralValue.local() = aState;
+    Value::sThreadState = aState;
+    return prevState;
+}
+#endif
+
+/*!
+ * \brief Get the number of blocks of state which may be flagged as changed.
+ * \param aNumValues The number of state values.
+ * \return The number of blocks needed to cover aNumValues.
+ */
+size_t ManageStateVariables::getNumDirtyBlocks( const size_t aNumValues ) {
+    return ( aNumValues + ( static_cast<size_t>( 1 ) << Value::DIRTY_BLOCK_SHIFT ) - 1 ) >> Value::DIRTY_BLOCK_SHIFT;
+}
+
+/*!
+ * \brief Limit the number of threads the thread pool of subsequently created
+ *        instances will use.
+ * \details This is used when multiple scenarios are run at the same time so that
+ *          each one is given a share of the available cores rather than all of
+ *          them competing for every core.
+ * \param aMaxConcurrency The maximum number of threads or a value less than one
+ *                        to use the TBB default.
+ */
+void ManageStateVariables::setMaxConcurrency( const int aMaxConcurrency ) {
+    sMaxConcurrency = aMaxConcurrency;
+}
+
+/*!
+ * \brief Get the maximum number of threads the thread pool will use.
+ * \return The number of threads as set by setMaxConcurrency or the TBB default
+ *         if it was not set.  Always one when GCAM_PARALLEL_ENABLED is off.
+ */
+int ManageStateVariables::getMaxConcurrency() {
+#if GCAM_PARALLEL_ENABLED
+    return sMaxConcurrency > 0 ? sMaxConcurrency : tbb::task_scheduler_init::default_num_threads();
+#else
+    return 1;
 #endif
 }
 
@@ -411,49 +636,39 @@ void ManageStateVariables::DoCollect::processData( DataType& aData ) {
 #endif
 }
 
+/*!
+ * \brief Record the given STATE data in the registry along with the Technology
+ *        and Market it is currently contained in.
+ * \param aType The kind of STATE data.
+ * \param aData A pointer to the data.
+ */
+void ManageStateVariables::DoCollect::addEntry( const StateRegistryEntry::StateType aType, void* aData ) {
+    StateRegistryEntry entry;
+    entry.mType = aType;
+    entry.mData = aData;
+    entry.mTechnology = mCurrTechnology;
+    entry.mMarket = mCurrMarket;
+    mParentClass->mStateRegistry.push_back( entry );
+}
+
 template<>
 void ManageStateVariables::DoCollect::processData<Value>( Value& aData ) {
-    // Any SINGLE value that is tagged is considered active so long as it is not
-    // contained in a retired technology for instance.
-    if( !mIgnoreCurrValue ) {
-        mParentClass->mStateValues.push_front( &aData );
-        ++mParentClass->mNumCollected;
-    }
+    addEntry( StateRegistryEntry::eValue, &aData );
 }
 
 template<>
 void ManageStateVariables::DoCollect::processData<objects::PeriodVector<Value> >( objects::PeriodVector<Value>& aData ) {
-    // When an ARRAY of values are tagged only the Value in [ mPeriodToCollect] is
-    // considered active.
-    if( !mIgnoreCurrValue ) {
-        mParentClass->mStateValues.push_front( &aData[ mParentClass->mPeriodToCollect ] );
-        ++mParentClass->mNumCollected;
-    }
+    addEntry( StateRegistryEntry::ePeriodVector, &aData );
 }
 
 template<>
 void ManageStateVariables::DoCollect::processData<objects::TechVintageVector<Value> >( objects::TechVintageVector<Value>& aData ) {
-    // When an ARRAY of values are tagged only the Value in [ mPeriodToCollect] is
-    // considered active.
-    
-    // Note, mIgnoreCurrValue should take care of out of bounds here
-    if( !mIgnoreCurrValue ) {
-        mParentClass->mStateValues.push_front( &aData[ mParentClass->mPeriodToCollect ] );
-        ++mParentClass->mNumCollected;
-    }
+    addEntry( StateRegistryEntry::eTechVintageVector, &aData );
 }
 
 template<>
 void ManageStateVariables::DoCollect::processData<objects::YearVector<Value> >( objects::YearVector<Value>& aData ) {
-    // When a year vector is tagged we only need to worry about values in the current
-    // timestep (already calculated the years ahead of time in the interest of speed
-    // to be from [mCCStartYear, mYearToCollect])
-    if( !mIgnoreCurrValue ) {
-        for( int year = std::max( mParentClass->mCCStartYear, aData.getStartYear() ); year <= mParentClass->mYearToCollect; ++year ) {
-            mParentClass->mStateValues.push_front( &aData[ year ] );
-            ++mParentClass->mNumCollected;
-        }
-    }
+    addEntry( StateRegistryEntry::eYearVector, &aData );
 }
 
 template<typename DataType>
@@ -469,30 +684,24 @@ void ManageStateVariables::DoCollect::popFilterStep( const DataType& aData ) {
 
 template<>
 void ManageStateVariables::DoCollect::pushFilterStep<ITechnology*>( ITechnology* const& aData ) {
-    // Ignore any data set within a Technology that is not operating in the current
-    // model period.
-    if( !aData->isOperating( mParentClass->mPeriodToCollect ) ) {
-        mIgnoreCurrValue = true;
-    }
+    // Keep track of the Technology so that collectState can check if it is operating.
+    mCurrTechnology = aData;
 }
 
 template<>
 void ManageStateVariables::DoCollect::popFilterStep<ITechnology*>( ITechnology* const& aData ) {
-    // Moving out of the current Technology so reset the ignore flag.
-    mIgnoreCurrValue = false;
+    // Moving out of the current Technology.
+    mCurrTechnology = 0;
 }
 
 template<>
 void ManageStateVariables::DoCollect::pushFilterStep<Market*>( Market* const& aData ) {
-    // Ignore any data set within a Market which is not for the current model year.
-    if( aData->getYear() != mParentClass->mYearToCollect ) {
-        mIgnoreCurrValue = true;
-    }
+    // Keep track of the Market so that collectState can check its year.
+    mCurrMarket = aData;
 }
 
 template<>
 void ManageStateVariables::DoCollect::popFilterStep<Market*>( Market* const& aData ) {
-    // Moving out of the current Market so reset the ignore flag.
-    mIgnoreCurrValue = false;
+    // Moving out of the current Market.
+    mCurrMarket = 0;
 }
-
@@ -193,7 +193,7 @@ void SupplyDemandCurveSaver::calcFeedbacksAfterPeriod( Scenario* aScenario,
         return;
     }
 
-    string fileName = conf->getFile( confVarName, "supplyDemandCurves.csv");
+    string fileName = util::tagOutputFileName( conf->getFile( confVarName, "supplyDemandCurves.csv") );
 
     AutoOutputFile outFile(fileName, mOpenMode );
 
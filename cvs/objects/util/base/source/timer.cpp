@@ -114,7 +114,29 @@ void Timer::print( std::ostream& aOut, const string& aLabel ) const {
 }
 
 //! Constructor
-TimerRegistry::TimerRegistry():mPredefinedTimers( END )
+Counter::Counter():mTotal( 0 )
+{
+}
+
+/*!
+ * \brief Add to the running total.
+ * \param aAmount The amount to add.
+ */
+void Counter::add( const unsigned long long aAmount ) {
+    mTotal += aAmount;
+}
+
+/*!
+ * \brief Get the running total of all amounts added.
+ * \return The total.
+ */
+unsigned long long Counter::getTotal() const {
+    return mTotal;
+}
+
+//! Constructor
+TimerRegistry::TimerRegistry():mPredefinedTimers( END ),
+mPredefinedCounters( END_COUNTERS )
 {
 }
 
@@ -143,6 +165,20 @@ Timer& TimerRegistry::getTimer( const PredefinedTimers aTimerName ) {
     return mPredefinedTimers[ aTimerName ];
 }
 
+/*!
+ * \brief Get the underlying counter for the given identifier.
+ * \param aCounterName The identifier to use to lookup the counter.
+ * \return The appropriate Counter to use.
+ */
+Counter& TimerRegistry::getCounter( const PredefinedCounters aCounterName ) {
+    /*!
+     * \pre aCounterName is a valid PredefinedCounters.
+     */
+    assert( aCounterName < END_COUNTERS );
+    
+    return mPredefinedCounters[ aCounterName ];
+}
+
 /*!
  * \brief Get the underlying timer for the given identifier.
  * \details This version looks up the timer by name and is more convenient to use
@@ -208,4 +244,13 @@ void TimerRegistry::printAllTimers( ostream& aOut ) const {
     for( map<string, Timer>::const_iterator it = mNamedTimers.begin(); it != mNamedTimers.end(); ++it ) {
         (*it).second.print( aOut, (*it).first );
     }
+    
+    // Report how much state had to be restored before each partial derivative
+    // compared to restoring all of it.
+    const unsigned long long numJacobians = mPredefinedCounters[ JACOBIAN_COUNT ].getTotal();
+    if( numJacobians > 0 ) {
+        aOut << "State bytes copied per Jacobian: "
+             << mPredefinedCounters[ STATE_BYTES_COPIED ].getTotal() / numJacobians << " of "
+             << mPredefinedCounters[ STATE_BYTES_TOTAL ].getTotal() / numJacobians << endl;
+    }
 }
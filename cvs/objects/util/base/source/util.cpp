@@ -44,14 +44,31 @@
 #include "util/base/include/model_time.h"
 #include "util/base/include/configuration.h"
 #include "util/logger/include/ilogger.h"
+#include "util/logger/include/logger_factory.h"
 
 #include <string>
 #include <ctime>
+#include <map>
+
+#if !defined(_WIN32) && !GCAM_PARALLEL_ENABLED
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 using namespace std;
 
 extern Scenario* scenario;
 
+namespace {
+    //! Get the storage for the output file tag of this process.
+    string& getOutputFileTagRef() {
+        static string sOutputFileTag;
+        return sOutputFileTag;
+    }
+}
+
 namespace objects {
     /*!
      * \brief Linearly interpolate or extrapolate a Y value for a given X value,
@@ -102,6 +119,57 @@ namespace objects {
         return modifiedFileName;
     }
 
+    /*!
+     * \brief Get the tag which output files written by this process should
+     *        include in their names.
+     * \details The tag is empty unless this process is one of several running
+     *          model jobs at the same time, see runInChildProcesses.
+     * \return The output file tag of this process.
+     */
+    const string& getOutputFileTag() {
+        return getOutputFileTagRef();
+    }
+
+    /*!
+     * \brief Set the tag which output files written by this process should
+     *        include in their names.
+     * \param aTag The new output file tag.
+     */
+    void setOutputFileTag( const string& aTag ) {
+        getOutputFileTagRef() = aTag;
+    }
+
+    /*!
+     * \brief Insert a tag into a file name.
+     * \details The tag is inserted before the extension of the file, that is the
+     *          last '.' which is not part of a directory name.  Should there be
+     *          no extension the tag is appended to the end.
+     * \param aFileName The file name, which may include a path.
+     * \param aTag The tag to insert.
+     * \return The file name including the tag.
+     */
+    string addFileNameTag( const string& aFileName, const string& aTag ) {
+        const size_t dirPos = aFileName.find_last_of( "/\\" );
+        const size_t dotPos = aFileName.find_last_of( '.' );
+        string modifiedFileName( aFileName );
+        if( dotPos == string::npos || ( dirPos != string::npos && dotPos < dirPos ) ) {
+            modifiedFileName.append( aTag );
+        }
+        else {
+            modifiedFileName.insert( dotPos, aTag );
+        }
+        return modifiedFileName;
+    }
+
+    /*!
+     * \brief Get the name an output file should be written to by this process.
+     * \param aFileName The usual name of the output file.
+     * \return The file name including the output file tag of this process.
+     */
+    string tagOutputFileName( const string& aFileName ) {
+        return addFileNameTag( aFileName, getOutputFileTag() );
+    }
+
     
     /*! \brief A function to replace spaces with underscores.
     * \details Returns a string equivalent to the string passed into the
@@ -343,5 +411,101 @@ int getConfigRunPeriod( const string aKey ) {
 }
 
 
+#if !defined(_WIN32) && !GCAM_PARALLEL_ENABLED
+/*!
+ * \brief Run a number of independent jobs, each in a child process forked from
+ *        this one.
+ * \details Jobs are started in index order with at most aMaxConcurrent children
+ *          running at any time.  Each child calls aRunJob with its index and
+ *          reports the result through its exit code.  If waiting for the
+ *          children fails for any reason other than an interrupted call no more
+ *          jobs are started and all jobs which have not reported are treated as
+ *          failed.
+ *
+ *          Each child adds "_<job index>" to the output file tag of this
+ *          process and reopens the logs under file names which include it so
+ *          that concurrent jobs do not write to the same files.  Children leave
+ *          with _exit once their logs are closed so that buffers and exit
+ *          handlers inherited from this process are not run a second time.
+ * \note This is only available in serial builds, the TBB worker threads of a
+ *       parallel build do not survive a fork.
+ * \param aNumJobs The number of jobs to run.
+ * \param aMaxConcurrent The maximum number of jobs to run at once.
+ * \param aRunJob The function to run in the child process for a job index.
+ * \param aJobName The function giving the name of a job index for log messages.
+ * \return Whether each job ran and succeeded, by index.
+ */
+vector<bool> runInChildProcesses( const size_t aNumJobs, const int aMaxConcurrent,
+                                  const function<bool( const size_t )>& aRunJob,
+                                  const function<string( const size_t )>& aJobName )
+{
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+
+    // Any output buffered in this process would otherwise be written again by
+    // each child.
+    cout.flush();
+    cerr.flush();
+
+    map<pid_t, size_t> runningJobs;
+    vector<bool> didSucceed( aNumJobs, false );
+    bool canWait = true;
+    for( size_t jobIndex = 0; canWait && jobIndex <= aNumJobs; ++jobIndex ){
+        // Wait for a running job to finish if there are no free slots or if all
+        // jobs have been started and we are waiting for the rest.
+        while( canWait && !runningJobs.empty() &&
+               ( runningJobs.size() >= static_cast<size_t>( aMaxConcurrent ) || jobIndex == aNumJobs ) )
+        {
+            int status;
+            const pid_t finishedPid = waitpid( -1, &status, 0 );
+            if( finishedPid == -1 ){
+                if( errno != EINTR ){
+                    mainLog.setLevel( ILogger::ERROR );
+                    mainLog << "Could not wait for child processes: " << strerror( errno ) << endl;
+                    canWait = false;
+                }
+                continue;
+            }
+            map<pid_t, size_t>::iterator finished = runningJobs.find( finishedPid );
+            if( finished == runningJobs.end() ){
+                // Not one of the jobs started here.
+                continue;
+            }
+            didSucceed[ finished->second ] = WIFEXITED( status ) && WEXITSTATUS( status ) == 0;
+            mainLog.setLevel( ILogger::NOTICE );
+            mainLog << "Finished running " << aJobName( finished->second ) << "." << endl;
+            runningJobs.erase( finished );
+        }
+        if( !canWait || jobIndex == aNumJobs ){
+            break;
+        }
+
+        const pid_t childPid = fork();
+        if( childPid == 0 ){
+            // In the child process, switch to output files of its own, run the
+            // job and report the result through the exit code.
+            const string childTag = "_" + toString( jobIndex );
+            setOutputFileTag( getOutputFileTag() + childTag );
+            LoggerFactory::reopenLogs( childTag );
+            const bool success = aRunJob( jobIndex );
+            LoggerFactory::closeLogs();
+            cout.flush();
+            cerr.flush();
+            _exit( success ? 0 : 1 );
+        }
+        else if( childPid < 0 ){
+            mainLog.setLevel( ILogger::ERROR );
+            mainLog << "Could not start a process for " << aJobName( jobIndex ) << "." << endl;
+        }
+        else {
+            mainLog.setLevel( ILogger::NOTICE );
+            mainLog << "Started " << aJobName( jobIndex ) << " writing output files tagged "
+                    << getOutputFileTag() << "_" << jobIndex << "." << endl;
+            runningJobs[ childPid ] = jobIndex;
+        }
+    }
+    return didSucceed;
+}
+#endif
+
 }
 
@@ -48,12 +48,13 @@
 */
 
 #include <iosfwd>
-#include <sstream>
+#include <string>
 #include <xercesc/dom/DOMNode.hpp>
 #include "util/logger/include/ilogger.h"
 
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/spin_mutex.h>
+#include <tbb/enumerable_thread_specific.h>
 #endif
 
 // Forward definition of the Logger class.
@@ -65,7 +66,10 @@ class Tabs;
 * \brief This is an overridden streambuffer class used by the Logger class.
 * 
 * This is a very simple class which contains a pointer to its parent Logger.
-* When the streambuf receives a character it passes it to its parent stream for processing.
+* When the streambuf receives a character, or a block of characters, it passes
+* it to its parent stream for processing.  The streambuf itself does not keep
+* a put area since the stream may be shared by several threads, instead the
+* parent buffers each line per thread.
 *
 * \author Josh Lurz
 * \warning Overriding the iostream class is somewhat difficult so this class may be somewhat esoteric.
@@ -78,6 +82,7 @@ class PassToParentStreamBuf: std::streambuf {
 public:
     PassToParentStreamBuf();
     int overflow( int ch );
+    std::streamsize xsputn( const char* aChars, std::streamsize aCount );
     int underflow( int ch );
     void setParent( Logger* parentIn );
     void toDebugXML( std::ostream& out ) const;
@@ -112,7 +117,10 @@ public:
     virtual ~Logger(); //!< Virtual destructor.
     virtual void open( const char[] = 0 ) = 0; //!< Pure virtual function called to begin logging.
     int receiveCharFromUnderStream( int ch ); //!< Pure virtual function called to complete the log and clean up.
+    void receiveCharsFromUnderStream( const char* aChars, std::streamsize aCount );
     virtual void close() = 0;
+    //! Pure virtual function called to continue logging to a different file.
+    virtual void reopen( const std::string& aFileName ) = 0;
     ILogger::WarningLevel setLevel( const ILogger::WarningLevel newLevel );
     bool wouldPrint(ILogger::WarningLevel aLevel) const;
     void toDebugXML( std::ostream& out, Tabs* tabs ) const;
@@ -148,15 +156,23 @@ protected:
     static void parseHeader( std::string& aHeader );
     static const std::string& convertLevelToString( ILogger::WarningLevel aLevel );
 private:
-	 //! Buffer which contains characters waiting to be printed.
-    std::stringstream mBuf;
 #if GCAM_PARALLEL_ENABLED
-    tbb::spin_mutex mMutex;  //<! mutex protecting mBuf
+	 //! Buffer by thread which contains characters of the current line waiting
+	 //! to be printed.  The memory is kept from line to line.
+    tbb::enumerable_thread_specific<std::string> mLineBuf;
+
+    tbb::spin_mutex mMutex;  //<! mutex protecting writing a complete line
+#else
+	 //! Buffer which contains characters of the current line waiting to be printed.
+	 //! The memory is kept from line to line.
+    std::string mLineBuf;
 #endif
 
 	 //! Underlying ofstream
     PassToParentStreamBuf mUnderStream;
 
+    std::string& getLineBuffer();
+    void completeLine( std::string& aLine );
     void XMLParse( const xercesc::DOMNode* node );
     static const std::string getTimeString();
     static const std::string getDateString();
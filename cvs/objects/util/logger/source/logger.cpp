@@ -45,6 +45,7 @@
 #include <iostream>
 #include <sstream>
 #include <cassert>
+#include <cstring>
 #include <ctime>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
@@ -63,9 +64,20 @@ mParent( 0 ){
 int PassToParentStreamBuf::overflow( int aChar ){
 	/*! \pre Make sure the parent is not null. */
 	assert( mParent );
+	if( traits_type::eq_int_type( aChar, traits_type::eof() ) ){
+		return traits_type::not_eof( aChar );
+	}
 	return mParent->receiveCharFromUnderStream( aChar );
 }
 
+//! Overriding xsputn function which passes a block of characters to its parent at once.
+streamsize PassToParentStreamBuf::xsputn( const char* aChars, streamsize aCount ){
+	/*! \pre Make sure the parent is not null. */
+	assert( mParent );
+	mParent->receiveCharsFromUnderStream( aChars, aCount );
+	return aCount;
+}
+
 //! Overriding underflow function which should not be reached because this is a write-only stream.
 int PassToParentStreamBuf::underflow( int aChar ){
 	/*! \pre This function should never be called. */
@@ -115,33 +127,72 @@ bool Logger::wouldPrint(ILogger::WarningLevel aLevel) const
     return aLevel >= mMinLogWarningLevel || aLevel >= mMinToScreenWarningLevel;
 }
 
-//! Receive a single character from the underlying stream and buffer it, printing the buffer it is a newline.
-int Logger::receiveCharFromUnderStream( int ch ) {
-    // Only receive the character or print to the screen if it needed.
-    if( mCurrentWarningLevel >= mMinLogWarningLevel || mCurrentWarningLevel >= mMinToScreenWarningLevel ){
-        // only really need to lock the mutex if we're going to do something.
+//! Get the line buffer for the calling thread.
+string& Logger::getLineBuffer() {
+#if GCAM_PARALLEL_ENABLED
+    return mLineBuf.local();
+#else
+    return mLineBuf;
+#endif
+}
+
+/*! \brief Log and print a complete line then clear it keeping its memory.
+ *  \param aLine The line buffer of the calling thread without the newline.
+ */
+void Logger::completeLine( string& aLine ) {
+    {
+        // The lock is only needed to write the complete line.
 #if GCAM_PARALLEL_ENABLED
         tbb::spin_mutex::scoped_lock lck( mMutex );
 #endif
+        logCompleteMessage( aLine );
+        printToScreenIfConfigured( aLine );
+    }
+    aLine.clear();
+}
+
+//! Receive a single character from the underlying stream and buffer it, printing the buffer it is a newline.
+int Logger::receiveCharFromUnderStream( int ch ) {
+    // Only receive the character or print to the screen if it needed.
+    if( wouldPrint( mCurrentWarningLevel ) ){
+        string& line = getLineBuffer();
         if( ch == '\n' ){
-            string tempString( mBuf.str() );
-            logCompleteMessage( tempString );
-            printToScreenIfConfigured( tempString );
-
-            // reset the stringstream buffer
-            mBuf.clear();       // Clear error flags, if any.
-            mBuf.str(std::string()); // clear out the data in the buffer.
-       }
+            completeLine( line );
+        }
         else {
             // The functions that perform the output will add the
             // newline, so we only want to insert non-newline
             // characters.
-            mBuf << ( char )ch;
+            line.push_back( static_cast<char>( ch ) );
         }
     }
     return ch;
 }
 
+/*! \brief Receive a block of characters from the underlying stream and buffer
+ *         them, printing the buffer at each newline.
+ *  \param aChars The characters to receive.
+ *  \param aCount The number of characters in aChars.
+ */
+void Logger::receiveCharsFromUnderStream( const char* aChars, streamsize aCount ) {
+    // Only receive the characters or print to the screen if it needed.
+    if( !wouldPrint( mCurrentWarningLevel ) ){
+        return;
+    }
+    string& line = getLineBuffer();
+    const char* end = aChars + aCount;
+    while( aChars != end ){
+        const char* newline = static_cast<const char*>( memchr( aChars, '\n', end - aChars ) );
+        if( !newline ){
+            line.append( aChars, end );
+            break;
+        }
+        line.append( aChars, newline );
+        completeLine( line );
+        aChars = newline + 1;
+    }
+}
+
 //! Print the message to the screen if the Logger is configured to.
 void Logger::printToScreenIfConfigured( const string& aMessage ){
 	// Decide whether to print the message
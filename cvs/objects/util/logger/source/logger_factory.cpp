@@ -47,6 +47,7 @@
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 #include "util/base/include/xml_helper.h"
+#include "util/base/include/util.h"
 #include "util/logger/include/logger_factory.h"
 #include "util/logger/include/logger.h"
 #include "util/logger/include/ilogger.h"
@@ -110,7 +111,7 @@ Logger& LoggerFactory::getLogger( const string& aLoggerName ) {
 	}
 	else {
 		cout << "Creating an uninitialized logger " << aLoggerName << endl;
-		Logger* newLogger = new PlainTextLogger( aLoggerName );
+		Logger* newLogger = new PlainTextLogger( util::tagOutputFileName( aLoggerName ) );
 		newLogger->open();
         mLoggers[ aLoggerName ] = newLogger;
 		return *mLoggers[ aLoggerName ];
@@ -119,12 +120,36 @@ Logger& LoggerFactory::getLogger( const string& aLoggerName ) {
 
 //! Cleans up the logger.
 void LoggerFactory::cleanUp() {
+	closeLogs();
 	for( map<string,Logger*>::iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); logIter++ ){
-		logIter->second->close();
 		delete logIter->second;
 	}
 }
 
+/*!
+ * \brief Continue all loggers in files whose names include the given tag.
+ * \details This is used by a process forked to run a model job alongside
+ *          others so that it does not write to the log files of its parent.
+ * \param aFileTag The tag to insert into the log file names.
+ */
+void LoggerFactory::reopenLogs( const string& aFileTag ) {
+	for( map<string,Logger*>::const_iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); ++logIter ){
+		logIter->second->reopen( util::addFileNameTag( logIter->second->mFileName, aFileTag ) );
+	}
+}
+
+/*!
+ * \brief Finish all logs without deleting the loggers.
+ * \details A process which ends without running the static destructors must
+ *          call this so that its logs are complete.  No more messages should be
+ *          logged afterwards.
+ */
+void LoggerFactory::closeLogs() {
+	for( map<string,Logger*>::iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); logIter++ ){
+		logIter->second->close();
+	}
+}
+
 /*! \brief Writes out the LoggerFactory to an XML file. 
 *
 * \param aOut Output stream to write to.
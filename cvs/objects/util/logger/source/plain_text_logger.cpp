@@ -73,6 +73,18 @@ void PlainTextLogger::close(){
     mLogFile.close();
 }
 
+/*!
+ * \brief Tells the logger to continue logging to a different file.
+ * \details The current file is closed as it is and the header is printed to
+ *          the new file.
+ * \param aFileName The name of the file to log to.
+ */
+void PlainTextLogger::reopen( const string& aFileName ){
+    mLogFile.close();
+    mFileName = aFileName;
+    open();
+}
+
 //! Logs a single message.
 void PlainTextLogger::logCompleteMessage( const string& aMessage ){
     // Decide whether to print the message
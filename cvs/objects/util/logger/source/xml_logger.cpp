@@ -78,6 +78,19 @@ void XMLLogger::close(){
 	mLogFile.close();
 }
 
+/*!
+ * \brief Tells the logger to continue logging to a different file.
+ * \details The current file is closed without the closing tag since the
+ *          logger may not be the only one writing to it, and the opening tag is
+ *          printed to the new file.
+ * \param aFileName The name of the file to log to.
+ */
+void XMLLogger::reopen( const string& aFileName ){
+	mLogFile.close();
+	mFileName = aFileName;
+	open();
+}
+
 //! Logs a single message.
 void XMLLogger::logCompleteMessage( const string& aMessage ){
 	// Decide whether to print the message